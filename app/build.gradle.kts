@@ -48,6 +48,11 @@ android {
     buildFeatures {
         viewBinding = true
     }
+
+    // 模型权重不压缩存放，native 直接引用 APK 的映射页，不再解压拷贝到堆上
+    androidResources {
+        noCompress += "bin"
+    }
     
     externalNativeBuild {
         cmake {
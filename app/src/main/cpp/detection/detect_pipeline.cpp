@@ -0,0 +1,181 @@
+#include "detect_pipeline.h"
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "DetectPipeline"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+static void on_resolution_changed(void*, const ResolutionDecision& d) {
+    LOGD("input size %d -> %d, frame latency %.1f ms", d.from, d.to, d.latency_ms);
+}
+
+DetectPipeline::DetectPipeline(Yolov8Pool& pool, int caller, PipelineCallback callback, void* userdata)
+    : pool(pool), caller(caller), callback(callback), userdata(userdata),
+      prepared_ready(0), next_id(0), running(false), preprocess_thread(0), inference_thread(0) {
+    resolution.set_listener(on_resolution_changed, 0);
+}
+
+DetectPipeline::~DetectPipeline() {
+    stop();
+}
+
+int DetectPipeline::start() {
+    if (running) return 0;
+    running = true;
+    preprocess_thread = new ncnn::Thread(preprocess_main, this);
+    inference_thread = new ncnn::Thread(inference_main, this);
+    return 0;
+}
+
+void DetectPipeline::stop() {
+    if (!running) return;
+    running = false;
+    notify();
+    // 预处理线程可能正阻塞在 acquire 中等实例（如后台任务占满了池）
+    pool.notify_waiters();
+
+    preprocess_thread->join();
+    inference_thread->join();
+    delete preprocess_thread;
+    delete inference_thread;
+    preprocess_thread = 0;
+    inference_thread = 0;
+
+    // 预处理好但未推理的一帧直接丢弃
+    if (prepared_ready.load()) {
+        pool.release(prepared.detector, caller);
+        prepared.detector = 0;
+        prepared_ready = 0;
+    }
+}
+
+void DetectPipeline::notify() {
+    mutex.lock();
+    cond.broadcast();
+    mutex.unlock();
+}
+
+void DetectPipeline::set_latency_budget(float budget_ms) {
+    resolution.set_budget(budget_ms);
+}
+
+long long DetectPipeline::submit(const Yuv420Planes& yuv, const PipelineParams& params) {
+    if (yuv.width <= 0 || yuv.height <= 0 || (yuv.width & 1) || (yuv.height & 1)) return -1;
+
+    // 拷贝后调用方即可关闭相机图像，不必等待推理
+    Frame& frame = frames.write_slot();
+    frame.nv21.resize((size_t)yuv.width * yuv.height * 3 / 2);
+    yuv420_to_nv21(yuv, &frame.nv21[0]);
+    frame.width = yuv.width;
+    frame.height = yuv.height;
+    frame.params = params;
+    const long long id = ++next_id;
+    frame.id = id;
+    frame.submit_ms = resolution.now();
+
+    frames.publish();
+    notify();
+    return id;
+}
+
+void* DetectPipeline::preprocess_main(void* args) {
+    ((DetectPipeline*)args)->preprocess_loop();
+    return 0;
+}
+
+void* DetectPipeline::inference_main(void* args) {
+    ((DetectPipeline*)args)->inference_loop();
+    return 0;
+}
+
+void DetectPipeline::preprocess_loop() {
+    for (;;) {
+        // 上一帧的预处理结果还没被取走时不开始新帧，期间到达的相机帧在缓冲中只留最新一份
+        mutex.lock();
+        while (running && (!frames.has_fresh() || prepared_ready.load())) cond.wait(mutex);
+        mutex.unlock();
+        if (!running) break;
+
+        Frame* frame = frames.read();
+        if (!frame) continue;
+
+        Yolov8* detector = pool.acquire(caller, &running);
+        if (!detector) continue;
+        // 流水线自己的线程，按调用方的策略持久绑定
+        detector->bind_thread();
+        // 模型只能按 640 推理时降档没有效果，关闭调节
+        resolution.set_enabled(detector->variable_input_size());
+
+        Yuv420Planes yuv;
+        yuv.y = &frame->nv21[0];
+        yuv.v = yuv.y + (size_t)frame->width * frame->height;
+        yuv.u = yuv.v + 1;
+        yuv.width = frame->width;
+        yuv.height = frame->height;
+        yuv.y_row_stride = frame->width;
+        yuv.uv_row_stride = frame->width;
+        yuv.uv_pixel_stride = 2;
+
+        const PipelineParams& params = frame->params;
+        const bool transposed = rotate_type_transposed(params.rotate_type);
+        const int frame_w = transposed ? frame->height : frame->width;
+        const int frame_h = transposed ? frame->width : frame->height;
+        Object::Rect roi = params.roi;
+        int roi_size = params.roi_size;
+        const bool full_frame = roi.width <= 0.f || roi.height <= 0.f;
+        if (full_frame) {
+            roi.x = 0.f;
+            roi.y = 0.f;
+            roi.width = frame_w;
+            roi.height = frame_h;
+            roi_size = resolution.input_size();
+        }
+
+        if (detector->prepare_yuv420(yuv, params.rotate_type, roi, roi_size) != 0) {
+            LOGE("prepare frame %lld failed", frame->id);
+            pool.release(detector, caller);
+            continue;
+        }
+
+        prepared.detector = detector;
+        prepared.id = frame->id;
+        prepared.frame_w = frame_w;
+        prepared.frame_h = frame_h;
+        prepared.submit_ms = frame->submit_ms;
+        prepared.full_frame = full_frame;
+        prepared.params = params;
+        prepared_ready = 1;
+        notify();
+    }
+}
+
+void DetectPipeline::inference_loop() {
+    Prepared current;
+    for (;;) {
+        mutex.lock();
+        while (running && !prepared_ready.load()) cond.wait(mutex);
+        mutex.unlock();
+        if (!running) break;
+
+        // 取走后立即让预处理线程开始下一帧，与本帧推理重叠
+        std::swap(current, prepared);
+        prepared_ready = 0;
+        notify();
+
+        const PipelineParams& params = current.params;
+        current.detector->bind_thread();
+        int ret = current.detector->detect_prepared(objects, params.prob_threshold, params.class_ids,
+                                                    params.max_candidates, params.max_detections, params.nms);
+        pool.release(current.detector, caller);
+        current.detector = 0;
+
+        if (ret != 0) {
+            LOGE("detect frame %lld failed", current.id);
+            continue;
+        }
+        callback(userdata, current.id, objects, current.frame_w, current.frame_h);
+        // 端到端耗时含排队与回调，即用户看到结果的延迟
+        if (current.full_frame) resolution.frame_end(current.submit_ms);
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef DETECT_PIPELINE_H
+#define DETECT_PIPELINE_H
+
+#include <atomic>
+#include <vector>
+#include <ncnn/platform.h>
+
+#include "object.h"
+#include "nms.h"
+#include "yuv_convert.h"
+#include "yolov8_pool.h"
+#include "resolution_controller.h"
+
+// 随帧提交的检测参数
+struct PipelineParams {
+    int rotate_type;       // yuv420_rotate_type 给出的方向
+    Object::Rect roi;      // 旋转后画面中的区域，宽或高 <= 0 时整帧推理
+    int roi_size;
+    float prob_threshold;
+    std::vector<int> class_ids;
+    int max_candidates;
+    int max_detections;
+    NmsParams nms;
+
+    PipelineParams() : rotate_type(1), roi_size(0), prob_threshold(0.25f),
+                       max_candidates(Yolov8::default_max_candidates), max_detections(Yolov8::default_max_detections) {
+        roi.x = roi.y = roi.width = roi.height = 0.f;
+    }
+};
+
+// 结果回调，在推理线程上调用；frame_w / frame_h 为旋转后的画面尺寸
+typedef void (*PipelineCallback)(void* userdata, long long frame_id, const std::vector<Object>& objects,
+                                 int frame_w, int frame_h);
+
+// 单生产者单消费者的三缓冲：生产者总有空位可写，消费者只取最新一份，未取走的旧值被覆盖
+template<class T>
+class LatestFrameBuffer {
+public:
+    LatestFrameBuffer() : middle(1), back(0), front(2) {}
+
+    // 生产者独占的写入位
+    T& write_slot() { return slots[back]; }
+    // 发布写入位，返回被覆盖的未读旧值，没有时返回 0
+    T* publish() {
+        const int old = middle.exchange(back | fresh_bit);
+        back = old & index_mask;
+        return (old & fresh_bit) ? &slots[back] : 0;
+    }
+    bool has_fresh() const { return (middle.load() & fresh_bit) != 0; }
+    // 取最新值，没有新值时返回 0；返回的槽位在下一次 read 前归消费者独占
+    T* read() {
+        if (!has_fresh()) return 0;
+        front = middle.exchange(front) & index_mask;
+        return &slots[front];
+    }
+
+private:
+    static const int fresh_bit = 4;
+    static const int index_mask = 3;
+
+    T slots[3];
+    std::atomic<int> middle;
+    int back;
+    int front;
+};
+
+// 相机帧异步检测流水线：submit 拷贝帧后立即返回，预处理与推理在两个专用线程上运行，
+// 第 n 帧推理时第 n + 1 帧已在另一实例上预处理；两级之间都只保留最新一帧，积压的旧帧直接丢弃
+// 每帧在预处理时从池中取一个实例，推理完成后归还，结果经回调送出
+class DetectPipeline {
+public:
+    DetectPipeline(Yolov8Pool& pool, int caller, PipelineCallback callback, void* userdata);
+    ~DetectPipeline();
+
+    int start();
+    // 等待两个线程退出，未处理的帧被丢弃
+    void stop();
+
+    // 把 yuv 整理为紧凑 NV21 存入帧缓冲，返回帧序号；只能在单个线程上调用
+    long long submit(const Yuv420Planes& yuv, const PipelineParams& params);
+
+    // 整帧推理（未给 roi）的输入边长按提交到回调的耗时自动调整，budget_ms <= 0 时固定 640
+    void set_latency_budget(float budget_ms);
+    int input_size() const { return resolution.input_size(); }
+
+private:
+    struct Frame {
+        std::vector<unsigned char> nv21;
+        int width;
+        int height;
+        long long id;
+        double submit_ms;  // resolution 时钟
+        PipelineParams params;
+
+        Frame() : width(0), height(0), id(0), submit_ms(0.0) {}
+    };
+
+    // 已预处理、等待推理的一帧
+    struct Prepared {
+        Yolov8* detector;
+        long long id;
+        int frame_w;
+        int frame_h;
+        double submit_ms;
+        bool full_frame;  // 只有整帧推理的耗时参与输入边长调节
+        PipelineParams params;
+
+        Prepared() : detector(0), id(0), frame_w(0), frame_h(0), submit_ms(0.0), full_frame(false) {}
+    };
+
+    static void* preprocess_main(void* args);
+    static void* inference_main(void* args);
+    void preprocess_loop();
+    void inference_loop();
+    // 唤醒等待中的线程
+    void notify();
+
+    Yolov8Pool& pool;
+    int caller;
+    PipelineCallback callback;
+    void* userdata;
+
+    LatestFrameBuffer<Frame> frames;
+    Prepared prepared;
+    std::atomic<int> prepared_ready;  // 1 表示 prepared 已填好，由推理线程取走后置 0
+    long long next_id;
+    ResolutionController resolution;
+
+    std::atomic<bool> running;
+    ncnn::Mutex mutex;
+    ncnn::ConditionVariable cond;
+    ncnn::Thread* preprocess_thread;
+    ncnn::Thread* inference_thread;
+
+    std::vector<Object> objects;  // 推理线程复用
+};
+
+#endif // DETECT_PIPELINE_H
@@ -0,0 +1,123 @@
+#include "letterbox.h"
+#include <math.h>
+
+#include "parallel_for.h"
+
+// 与 ncnn resize_bilinear 相同的半像素对齐，越界时贴边
+static void source_coord(int d, float scale, int src_size, int* s0, int* s1, float* a) {
+    float f = (d + 0.5f) * scale - 0.5f;
+    int s = (int)floorf(f);
+    f -= s;
+    if (s < 0) {
+        s = 0;
+        f = 0.f;
+    }
+    if (s >= src_size - 1) {
+        s = src_size - 1;
+        f = 0.f;
+    }
+    *s0 = s;
+    *s1 = s + 1 < src_size ? s + 1 : s;
+    *a = f;
+}
+
+static void prepare_columns(int src_w, int w, int channels, LetterboxScratch& scratch) {
+    if (scratch.src_w == src_w && scratch.dst_w == w && scratch.channels == channels) return;
+
+    scratch.xofs.resize(w * 2);
+    scratch.alpha.resize(w);
+    const float scale = (float)src_w / w;
+    for (int dx = 0; dx < w; dx++) {
+        int sx0, sx1;
+        source_coord(dx, scale, src_w, &sx0, &sx1, &scratch.alpha[dx]);
+        scratch.xofs[dx * 2] = sx0 * channels;
+        scratch.xofs[dx * 2 + 1] = sx1 * channels;
+    }
+    scratch.src_w = src_w;
+    scratch.dst_w = w;
+    scratch.channels = channels;
+}
+
+static inline void fill(float* p, int n, float v) {
+    for (int i = 0; i < n; i++) p[i] = v;
+}
+
+void letterbox_normalize(const unsigned char* src, int src_w, int src_h, int stride, int channels,
+                         int w, int h, int target_w, int target_h, float pad_value, float norm,
+                         ncnn::Mat& out, int* pad_left, int* pad_top,
+                         LetterboxScratch& scratch, int num_threads) {
+    out.create(target_w, target_h, 3);
+
+    const int left = (target_w - w) / 2;
+    const int top = (target_h - h) / 2;
+    *pad_left = left;
+    *pad_top = top;
+
+    // 尺寸一致时逐像素换算，否则查表双线性插值
+    const bool same_size = src_w == w && src_h == h;
+    if (!same_size) prepare_columns(src_w, w, channels, scratch);
+    const int* xofs = scratch.xofs.data();
+    const float* alpha = scratch.alpha.data();
+
+    const float pad = pad_value * norm;
+    const float scale_y = (float)src_h / h;
+
+    parallel_for(target_h, num_threads, [&](int dy) {
+        float* r = out.channel(0).row(dy);
+        float* g = out.channel(1).row(dy);
+        float* b = out.channel(2).row(dy);
+
+        const int iy = dy - top;
+        if (iy < 0 || iy >= h) {
+            fill(r, target_w, pad);
+            fill(g, target_w, pad);
+            fill(b, target_w, pad);
+            return;
+        }
+
+        fill(r, left, pad);
+        fill(g, left, pad);
+        fill(b, left, pad);
+        const int right = target_w - left - w;
+        fill(r + left + w, right, pad);
+        fill(g + left + w, right, pad);
+        fill(b + left + w, right, pad);
+
+        r += left;
+        g += left;
+        b += left;
+
+        if (same_size) {
+            const unsigned char* s = src + (size_t)iy * stride;
+            for (int dx = 0; dx < w; dx++) {
+                r[dx] = s[0] * norm;
+                g[dx] = s[1] * norm;
+                b[dx] = s[2] * norm;
+                s += channels;
+            }
+            return;
+        }
+
+        int sy0, sy1;
+        float beta;
+        source_coord(iy, scale_y, src_h, &sy0, &sy1, &beta);
+        const unsigned char* s0 = src + (size_t)sy0 * stride;
+        const unsigned char* s1 = src + (size_t)sy1 * stride;
+        // 归一化系数并入纵向权重
+        const float b0 = (1.f - beta) * norm;
+        const float b1 = beta * norm;
+
+        for (int dx = 0; dx < w; dx++) {
+            const unsigned char* p00 = s0 + xofs[dx * 2];
+            const unsigned char* p01 = s0 + xofs[dx * 2 + 1];
+            const unsigned char* p10 = s1 + xofs[dx * 2];
+            const unsigned char* p11 = s1 + xofs[dx * 2 + 1];
+            const float a1 = alpha[dx];
+            const float a0 = 1.f - a1;
+
+            r[dx] = (p00[0] * a0 + p01[0] * a1) * b0 + (p10[0] * a0 + p11[0] * a1) * b1;
+            g[dx] = (p00[1] * a0 + p01[1] * a1) * b0 + (p10[1] * a0 + p11[1] * a1) * b1;
+            b[dx] = (p00[2] * a0 + p01[2] * a1) * b0 + (p10[2] * a0 + p11[2] * a1) * b1;
+        }
+    });
+}
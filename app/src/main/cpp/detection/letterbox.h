@@ -0,0 +1,27 @@
+#ifndef LETTERBOX_H
+#define LETTERBOX_H
+
+#include <vector>
+#include <ncnn/mat.h>
+
+// 双线性采样表，按目标宽度缓存，跨帧复用
+struct LetterboxScratch {
+    std::vector<int> xofs;     // 每个输出列的左右两个源像素字节偏移
+    std::vector<float> alpha;  // 右侧源像素权重
+    int src_w;
+    int dst_w;
+    int channels;
+
+    LetterboxScratch() : src_w(0), dst_w(0), channels(0) {}
+};
+
+// 缩放 + 丢弃 alpha + 居中填充 + 归一化一次扫描完成
+// src 为 RGB / RGBA 交错像素（channels 为 3 或 4，行距 stride 字节），双线性缩放到 w x h，
+// 写入 out (target_w x target_h x 3 planar) 中央，边框填 pad_value，所有值乘 norm
+// out 尺寸不变时复用已有内存；pad_left / pad_top 返回左上填充量
+void letterbox_normalize(const unsigned char* src, int src_w, int src_h, int stride, int channels,
+                         int w, int h, int target_w, int target_h, float pad_value, float norm,
+                         ncnn::Mat& out, int* pad_left, int* pad_top,
+                         LetterboxScratch& scratch, int num_threads = 1);
+
+#endif // LETTERBOX_H
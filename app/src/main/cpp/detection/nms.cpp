@@ -0,0 +1,356 @@
+#include "nms.h"
+#include <math.h>
+#include <algorithm>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+// 每个类别桶划分为 kGridSize x kGridSize 个格子
+static const int kGridSize = 8;
+
+static inline float intersection_area(const Object& a, const Object& b) {
+    float inter_left = std::max(a.rect.x, b.rect.x);
+    float inter_top = std::max(a.rect.y, b.rect.y);
+    float inter_right = std::min(a.rect.x + a.rect.width, b.rect.x + b.rect.width);
+    float inter_bottom = std::min(a.rect.y + a.rect.height, b.rect.y + b.rect.height);
+    if (inter_right < inter_left || inter_bottom < inter_top) return 0.0f;
+    return (inter_right - inter_left) * (inter_bottom - inter_top);
+}
+
+static inline int grid_cell(float v, float origin, float inv_cell) {
+    int c = (int)((v - origin) * inv_cell);
+    return std::min(std::max(c, 0), kGridSize - 1);
+}
+
+void iou_one_to_many(float ax0, float ay0, float ax1, float ay1, float aarea,
+                     const float* x0, const float* y0, const float* x1, const float* y1, const float* area,
+                     int n, float* ious) {
+    int j = 0;
+#if __ARM_NEON
+    float32x4_t _ax0 = vdupq_n_f32(ax0);
+    float32x4_t _ay0 = vdupq_n_f32(ay0);
+    float32x4_t _ax1 = vdupq_n_f32(ax1);
+    float32x4_t _ay1 = vdupq_n_f32(ay1);
+    float32x4_t _aarea = vdupq_n_f32(aarea);
+    float32x4_t _zero = vdupq_n_f32(0.f);
+    for (; j + 3 < n; j += 4) {
+        float32x4_t _w = vsubq_f32(vminq_f32(_ax1, vld1q_f32(x1 + j)), vmaxq_f32(_ax0, vld1q_f32(x0 + j)));
+        float32x4_t _h = vsubq_f32(vminq_f32(_ay1, vld1q_f32(y1 + j)), vmaxq_f32(_ay0, vld1q_f32(y0 + j)));
+        float32x4_t _inter = vmulq_f32(vmaxq_f32(_w, _zero), vmaxq_f32(_h, _zero));
+        float32x4_t _union = vsubq_f32(vaddq_f32(_aarea, vld1q_f32(area + j)), _inter);
+        uint32x4_t _valid = vcgtq_f32(_union, _zero);
+#if __aarch64__
+        float32x4_t _iou = vdivq_f32(_inter, _union);
+#else
+        float32x4_t _r = vrecpeq_f32(_union);
+        _r = vmulq_f32(vrecpsq_f32(_union, _r), _r);
+        _r = vmulq_f32(vrecpsq_f32(_union, _r), _r);
+        float32x4_t _iou = vmulq_f32(_inter, _r);
+#endif
+        vst1q_f32(ious + j, vbslq_f32(_valid, _iou, _zero));
+    }
+#elif __SSE2__
+    __m128 _ax0 = _mm_set1_ps(ax0);
+    __m128 _ay0 = _mm_set1_ps(ay0);
+    __m128 _ax1 = _mm_set1_ps(ax1);
+    __m128 _ay1 = _mm_set1_ps(ay1);
+    __m128 _aarea = _mm_set1_ps(aarea);
+    __m128 _zero = _mm_setzero_ps();
+    for (; j + 3 < n; j += 4) {
+        __m128 _w = _mm_sub_ps(_mm_min_ps(_ax1, _mm_loadu_ps(x1 + j)), _mm_max_ps(_ax0, _mm_loadu_ps(x0 + j)));
+        __m128 _h = _mm_sub_ps(_mm_min_ps(_ay1, _mm_loadu_ps(y1 + j)), _mm_max_ps(_ay0, _mm_loadu_ps(y0 + j)));
+        __m128 _inter = _mm_mul_ps(_mm_max_ps(_w, _zero), _mm_max_ps(_h, _zero));
+        __m128 _union = _mm_sub_ps(_mm_add_ps(_aarea, _mm_loadu_ps(area + j)), _inter);
+        __m128 _valid = _mm_cmpgt_ps(_union, _zero);
+        _mm_storeu_ps(ious + j, _mm_and_ps(_valid, _mm_div_ps(_inter, _union)));
+    }
+#endif
+    for (; j < n; j++) {
+        float w = std::min(ax1, x1[j]) - std::max(ax0, x0[j]);
+        float h = std::min(ay1, y1[j]) - std::max(ay0, y0[j]);
+        float inter = std::max(w, 0.f) * std::max(h, 0.f);
+        float uni = aarea + area[j] - inter;
+        ious[j] = uni > 0.f ? inter / uni : 0.f;
+    }
+}
+
+// 按 (类别升序, 分数降序, 下标升序) 排序 ws.order
+static void sort_by_class_score(const std::vector<Object>& objects, NmsWorkspace& ws) {
+    const int n = objects.size();
+    ws.order.resize(n);
+    for (int i = 0; i < n; i++) ws.order[i] = i;
+    std::sort(ws.order.begin(), ws.order.end(), [&objects](int a, int b) {
+        const Object& oa = objects[a];
+        const Object& ob = objects[b];
+        if (oa.label != ob.label) return oa.label < ob.label;
+        if (oa.prob != ob.prob) return oa.prob > ob.prob;
+        return a < b;
+    });
+}
+
+void nms_bboxes(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold, NmsWorkspace& ws) {
+    picked.clear();
+    const int n = objects.size();
+    if (n == 0) return;
+
+    ws.areas.resize(n);
+    ws.visit.assign(n, -1);
+    for (int i = 0; i < n; i++) {
+        ws.areas[i] = objects[i].rect.width * objects[i].rect.height;
+    }
+
+    // 类别升序、分数降序，同分按原下标，保证结果确定
+    sort_by_class_score(objects, ws);
+
+    ws.cell_head.resize(kGridSize * kGridSize);
+    ws.node_next.clear();
+    ws.node_box.clear();
+
+    for (int s = 0; s < n;) {
+        const int label = objects[ws.order[s]].label;
+        int e = s;
+        float min_x = objects[ws.order[s]].rect.x;
+        float min_y = objects[ws.order[s]].rect.y;
+        float max_x = min_x;
+        float max_y = min_y;
+        for (; e < n && objects[ws.order[e]].label == label; e++) {
+            const Object::Rect& r = objects[ws.order[e]].rect;
+            min_x = std::min(min_x, r.x);
+            min_y = std::min(min_y, r.y);
+            max_x = std::max(max_x, r.x + r.width);
+            max_y = std::max(max_y, r.y + r.height);
+        }
+
+        const float inv_cell_w = max_x > min_x ? kGridSize / (max_x - min_x) : 0.f;
+        const float inv_cell_h = max_y > min_y ? kGridSize / (max_y - min_y) : 0.f;
+        std::fill(ws.cell_head.begin(), ws.cell_head.end(), -1);
+        ws.node_next.clear();
+        ws.node_box.clear();
+
+        for (int k = s; k < e; k++) {
+            const int i = ws.order[k];
+            const Object& a = objects[i];
+            const int cx0 = grid_cell(a.rect.x, min_x, inv_cell_w);
+            const int cx1 = grid_cell(a.rect.x + a.rect.width, min_x, inv_cell_w);
+            const int cy0 = grid_cell(a.rect.y, min_y, inv_cell_h);
+            const int cy1 = grid_cell(a.rect.y + a.rect.height, min_y, inv_cell_h);
+
+            bool keep = true;
+            for (int cy = cy0; cy <= cy1 && keep; cy++) {
+                for (int cx = cx0; cx <= cx1 && keep; cx++) {
+                    for (int node = ws.cell_head[cy * kGridSize + cx]; node != -1; node = ws.node_next[node]) {
+                        const int j = ws.node_box[node];
+                        if (ws.visit[j] == i) continue;
+                        ws.visit[j] = i;
+
+                        float inter_area = intersection_area(a, objects[j]);
+                        float union_area = ws.areas[i] + ws.areas[j] - inter_area;
+                        if (union_area <= 0) continue;
+                        if (inter_area / union_area > nms_threshold) {
+                            keep = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (!keep) continue;
+
+            picked.push_back(i);
+            for (int cy = cy0; cy <= cy1; cy++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    const int cell = cy * kGridSize + cx;
+                    ws.node_box.push_back(i);
+                    ws.node_next.push_back(ws.cell_head[cell]);
+                    ws.cell_head[cell] = ws.node_box.size() - 1;
+                }
+            }
+        }
+        s = e;
+    }
+
+    // 各类别结果合并为整体分数降序
+    std::sort(picked.begin(), picked.end(), [&objects](int a, int b) {
+        if (objects[a].prob != objects[b].prob) return objects[a].prob > objects[b].prob;
+        return a < b;
+    });
+}
+
+// 把 order[s, e) 的框装入 SoA 数组
+static void load_bucket(const std::vector<Object>& objects, int s, int e, NmsWorkspace& ws) {
+    const int m = e - s;
+    ws.x0.resize(m);
+    ws.y0.resize(m);
+    ws.x1.resize(m);
+    ws.y1.resize(m);
+    ws.area.resize(m);
+    ws.score.resize(m);
+    ws.index.resize(m);
+    ws.ious.resize(m);
+    for (int k = 0; k < m; k++) {
+        const Object& o = objects[ws.order[s + k]];
+        ws.x0[k] = o.rect.x;
+        ws.y0[k] = o.rect.y;
+        ws.x1[k] = o.rect.x + o.rect.width;
+        ws.y1[k] = o.rect.y + o.rect.height;
+        ws.area[k] = o.rect.width * o.rect.height;
+        ws.score[k] = o.prob;
+        ws.index[k] = ws.order[s + k];
+    }
+}
+
+// 把第 from 个 SoA 框移动到 to
+static inline void move_box(NmsWorkspace& ws, int from, int to) {
+    ws.x0[to] = ws.x0[from];
+    ws.y0[to] = ws.y0[from];
+    ws.x1[to] = ws.x1[from];
+    ws.y1[to] = ws.y1[from];
+    ws.area[to] = ws.area[from];
+    ws.score[to] = ws.score[from];
+    ws.index[to] = ws.index[from];
+}
+
+static void soft_nms_bucket(const std::vector<Object>& objects, int s, int e, const NmsParams& params,
+                            NmsWorkspace& ws, std::vector<Object>& results) {
+    load_bucket(objects, s, e, ws);
+    int m = e - s;
+    while (m > 0) {
+        // 取剩余框中分数最高者，末尾框填补其位置
+        int best = 0;
+        for (int k = 1; k < m; k++) {
+            if (ws.score[k] > ws.score[best]) best = k;
+        }
+        Object obj = objects[ws.index[best]];
+        obj.prob = ws.score[best];
+        results.push_back(obj);
+
+        const float bx0 = ws.x0[best], by0 = ws.y0[best], bx1 = ws.x1[best], by1 = ws.y1[best], barea = ws.area[best];
+        m--;
+        move_box(ws, m, best);
+
+        iou_one_to_many(bx0, by0, bx1, by1, barea, ws.x0.data(), ws.y0.data(), ws.x1.data(), ws.y1.data(), ws.area.data(), m, ws.ious.data());
+
+        int kept = 0;
+        for (int k = 0; k < m; k++) {
+            const float iou = ws.ious[k];
+            float sc = ws.score[k];
+            if (params.mode == NMS_SOFT_LINEAR) {
+                if (iou > params.iou_threshold) sc *= 1.f - iou;
+            } else {
+                sc *= expf(-iou * iou / params.sigma);
+            }
+            if (sc < params.score_threshold) continue;
+            ws.score[k] = sc;
+            move_box(ws, k, kept);
+            kept++;
+        }
+        m = kept;
+    }
+}
+
+static void wbf_bucket(const std::vector<Object>& objects, int s, int e, const NmsParams& params,
+                       NmsWorkspace& ws, std::vector<Object>& results) {
+    const int m = e - s;
+    ws.x0.resize(m);
+    ws.y0.resize(m);
+    ws.x1.resize(m);
+    ws.y1.resize(m);
+    ws.area.resize(m);
+    ws.ious.resize(m);
+    ws.wx0.resize(m);
+    ws.wy0.resize(m);
+    ws.wx1.resize(m);
+    ws.wy1.resize(m);
+    ws.wsum.resize(m);
+    ws.index.resize(m);
+
+    // 按分数降序依次并入 IoU 最大且超过阈值的簇，否则新建簇
+    int nc = 0;
+    for (int k = s; k < e; k++) {
+        const Object& o = objects[ws.order[k]];
+        const float ox0 = o.rect.x, oy0 = o.rect.y, ox1 = o.rect.x + o.rect.width, oy1 = o.rect.y + o.rect.height;
+        iou_one_to_many(ox0, oy0, ox1, oy1, o.rect.width * o.rect.height,
+                        ws.x0.data(), ws.y0.data(), ws.x1.data(), ws.y1.data(), ws.area.data(), nc, ws.ious.data());
+
+        int best = -1;
+        float best_iou = params.iou_threshold;
+        for (int c = 0; c < nc; c++) {
+            if (ws.ious[c] > best_iou) {
+                best_iou = ws.ious[c];
+                best = c;
+            }
+        }
+
+        int c = best;
+        if (c < 0) {
+            c = nc++;
+            ws.wx0[c] = ws.wy0[c] = ws.wx1[c] = ws.wy1[c] = ws.wsum[c] = 0.f;
+            ws.index[c] = 0;
+        }
+        ws.wx0[c] += o.prob * ox0;
+        ws.wy0[c] += o.prob * oy0;
+        ws.wx1[c] += o.prob * ox1;
+        ws.wy1[c] += o.prob * oy1;
+        ws.wsum[c] += o.prob;
+        ws.index[c] += 1;
+        ws.x0[c] = ws.wx0[c] / ws.wsum[c];
+        ws.y0[c] = ws.wy0[c] / ws.wsum[c];
+        ws.x1[c] = ws.wx1[c] / ws.wsum[c];
+        ws.y1[c] = ws.wy1[c] / ws.wsum[c];
+        ws.area[c] = (ws.x1[c] - ws.x0[c]) * (ws.y1[c] - ws.y0[c]);
+    }
+
+    const int label = objects[ws.order[s]].label;
+    for (int c = 0; c < nc; c++) {
+        Object obj;
+        obj.rect.x = ws.x0[c];
+        obj.rect.y = ws.y0[c];
+        obj.rect.width = ws.x1[c] - ws.x0[c];
+        obj.rect.height = ws.y1[c] - ws.y0[c];
+        obj.label = label;
+        obj.prob = ws.wsum[c] / ws.index[c];
+        results.push_back(obj);
+    }
+}
+
+void suppress_bboxes(const std::vector<Object>& objects, std::vector<Object>& results, const NmsParams& params, NmsWorkspace& ws) {
+    results.clear();
+    if (params.mode == NMS_HARD) {
+        nms_bboxes(objects, ws.picked, params.iou_threshold, ws);
+        results.resize(ws.picked.size());
+        for (size_t i = 0; i < ws.picked.size(); i++) results[i] = objects[ws.picked[i]];
+        return;
+    }
+
+    const int n = objects.size();
+    if (n == 0) return;
+    sort_by_class_score(objects, ws);
+
+    for (int s = 0; s < n;) {
+        const int label = objects[ws.order[s]].label;
+        int e = s + 1;
+        while (e < n && objects[ws.order[e]].label == label) e++;
+
+        if (params.mode == NMS_WBF) {
+            wbf_bucket(objects, s, e, params, ws, results);
+        } else {
+            soft_nms_bucket(objects, s, e, params, ws, results);
+        }
+        s = e;
+    }
+
+    // 按分数降序、同分按输出先后排列下标再回填，与 stable_sort 次序一致；stable_sort 每次调用都申请临时缓冲
+    const int m = results.size();
+    ws.staged.assign(results.begin(), results.end());
+    ws.order.resize(m);
+    for (int i = 0; i < m; i++) ws.order[i] = i;
+    const std::vector<Object>& staged = ws.staged;
+    std::sort(ws.order.begin(), ws.order.end(), [&staged](int a, int b) {
+        if (staged[a].prob != staged[b].prob) return staged[a].prob > staged[b].prob;
+        return a < b;
+    });
+    for (int i = 0; i < m; i++) results[i] = staged[ws.order[i]];
+}
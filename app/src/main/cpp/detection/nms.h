@@ -0,0 +1,56 @@
+#ifndef NMS_H
+#define NMS_H
+
+#include <vector>
+
+#include "object.h"
+
+// 抑制方式
+enum NmsMode {
+    NMS_HARD = 0,           // 贪心硬阈值
+    NMS_SOFT_LINEAR = 1,    // Soft-NMS，IoU 超过阈值时分数乘 (1 - IoU)
+    NMS_SOFT_GAUSSIAN = 2,  // Soft-NMS，分数乘 exp(-IoU^2 / sigma)
+    NMS_WBF = 3             // 加权框融合，IoU 超过阈值的框按分数加权平均坐标
+};
+
+struct NmsParams {
+    int mode;
+    float iou_threshold;
+    float sigma;            // 仅 NMS_SOFT_GAUSSIAN
+    float score_threshold;  // Soft-NMS 衰减后低于此分数的框被丢弃
+
+    NmsParams() : mode(NMS_HARD), iou_threshold(0.45f), sigma(0.5f), score_threshold(0.f) {}
+};
+
+// NMS 工作区，由调用方持有并跨帧复用，稳定后不再分配内存
+struct NmsWorkspace {
+    std::vector<int> order;      // 按 (类别, 分数降序) 排列的下标
+    std::vector<float> areas;
+    std::vector<int> cell_head;  // 空间网格：每格已保留框的链表头
+    std::vector<int> node_next;
+    std::vector<int> node_box;
+    std::vector<int> visit;      // 避免同一对框在多个格子里重复比较
+    std::vector<int> picked;
+
+    // Soft-NMS / WBF 的 SoA 框数组；WBF 中存放融合框，w* 为按分数加权的坐标累加
+    std::vector<float> x0, y0, x1, y1, area, score, ious;
+    std::vector<float> wx0, wy0, wx1, wy1, wsum;
+    std::vector<int> index;
+    std::vector<Object> staged;  // 输出按分数重排前的副本
+};
+
+// 一个框 (ax0, ay0, ax1, ay1) 与 n 个 SoA 框逐一计算 IoU，并集为 0 时记 0
+void iou_one_to_many(float ax0, float ay0, float ax1, float ay1, float aarea,
+                     const float* x0, const float* y0, const float* x1, const float* y1, const float* area,
+                     int n, float* ious);
+
+// 类别内贪心 NMS，输入无需有序：先按类别分桶、桶内按分数降序，
+// 已保留的框登记到粗粒度网格，候选框只与所覆盖格子里的框计算 IoU
+// picked 输出保留框在 objects 中的下标，按分数降序
+void nms_bboxes(const std::vector<Object>& objects, std::vector<int>& picked, float nms_threshold, NmsWorkspace& ws);
+
+// 按 params.mode 在类别内做抑制或融合，results 按分数降序输出
+// Soft-NMS 输出衰减后的分数，WBF 输出融合框与簇内平均分数
+void suppress_bboxes(const std::vector<Object>& objects, std::vector<Object>& results, const NmsParams& params, NmsWorkspace& ws);
+
+#endif // NMS_H
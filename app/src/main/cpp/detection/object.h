@@ -0,0 +1,16 @@
+#ifndef OBJECT_H
+#define OBJECT_H
+
+// 检测结果，坐标为原图像素坐标
+struct Object {
+    struct Rect {
+        float x;
+        float y;
+        float width;
+        float height;
+    } rect;
+    int label;
+    float prob;
+};
+
+#endif // OBJECT_H
@@ -0,0 +1,16 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+// 对 [0, n) 逐个调用 body(i)，num_threads > 1 时按 OpenMP 静态调度并行
+// 单线程时不进入并行区：libgomp 每进入一次单线程的并行区都会重新分配线程组，破坏稳态无分配
+template <typename Body>
+static inline void parallel_for(int n, int num_threads, const Body& body) {
+    if (num_threads > 1) {
+        #pragma omp parallel for num_threads(num_threads)
+        for (int i = 0; i < n; i++) body(i);
+    } else {
+        for (int i = 0; i < n; i++) body(i);
+    }
+}
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,87 @@
+#include "resolution_controller.h"
+#include <time.h>
+
+const int ResolutionController::sizes[ResolutionController::num_levels] = {320, 416, 512, 640};
+
+static double monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+ResolutionController::ResolutionController(float budget, Clock clock)
+    : down_frames(3), up_frames(15), up_ratio(0.8f), cooldown_ms(1000.0), smoothing(0.3f),
+      clock(clock ? clock : monotonic_ms), budget_ms(budget), enabled(true), level(num_levels - 1),
+      applied_budget(budget), smoothed(0.f), over_count(0), under_count(0), last_switch_ms(-1e9),
+      listener(0), listener_data(0) {
+    decision.time_ms = 0.0;
+    decision.from = decision.to = sizes[num_levels - 1];
+    decision.latency_ms = 0.f;
+}
+
+void ResolutionController::set_budget(float budget) {
+    budget_ms = budget;
+}
+
+void ResolutionController::set_enabled(bool e) {
+    enabled = e;
+}
+
+void ResolutionController::set_listener(ResolutionListener l, void* userdata) {
+    listener = l;
+    listener_data = userdata;
+}
+
+int ResolutionController::frame_end(double begin_ms) {
+    return update((float)(clock() - begin_ms));
+}
+
+int ResolutionController::update(float latency_ms) {
+    const float budget = active_budget();
+    if (budget != applied_budget) {
+        applied_budget = budget;
+        over_count = 0;
+        under_count = 0;
+        // 关闭调节后从最大边长重新开始
+        if (budget <= 0.f && level.load() != num_levels - 1) switch_to(num_levels - 1, smoothed);
+    }
+    if (budget <= 0.f) return input_size();
+
+    smoothed = smoothed > 0.f ? smoothed + smoothing * (latency_ms - smoothed) : latency_ms;
+    const int cur = level.load();
+
+    if (smoothed > budget) {
+        over_count++;
+        under_count = 0;
+    } else {
+        over_count = 0;
+        // 耗时近似与像素数成正比
+        const float ratio = cur + 1 < num_levels ? (float)sizes[cur + 1] / sizes[cur] : 0.f;
+        if (ratio > 0.f && smoothed * ratio * ratio < budget * up_ratio) under_count++;
+        else under_count = 0;
+    }
+
+    if (clock() - last_switch_ms < cooldown_ms) return input_size();
+    if (over_count >= down_frames && cur > 0) switch_to(cur - 1, smoothed);
+    else if (under_count >= up_frames && cur + 1 < num_levels) switch_to(cur + 1, smoothed);
+    return input_size();
+}
+
+void ResolutionController::switch_to(int to, float latency_ms) {
+    const int from = level.load();
+    level = to;
+    // 平滑值按像素比例换算到新边长，不必等旧耗时衰减完才做下一次判断
+    if (smoothed > 0.f) {
+        const float ratio = (float)sizes[to] / sizes[from];
+        smoothed *= ratio * ratio;
+    }
+    over_count = 0;
+    under_count = 0;
+    last_switch_ms = clock();
+
+    decision.time_ms = last_switch_ms;
+    decision.from = sizes[from];
+    decision.to = sizes[to];
+    decision.latency_ms = latency_ms;
+    if (listener) listener(listener_data, decision);
+}
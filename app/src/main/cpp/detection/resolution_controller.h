@@ -0,0 +1,74 @@
+#ifndef RESOLUTION_CONTROLLER_H
+#define RESOLUTION_CONTROLLER_H
+
+#include <atomic>
+
+// 一次输入边长切换，供日志与界面显示
+struct ResolutionDecision {
+    double time_ms;     // 切换时刻（控制器时钟）
+    int from;
+    int to;
+    float latency_ms;   // 触发切换时的平滑帧耗时
+};
+
+typedef void (*ResolutionListener)(void* userdata, const ResolutionDecision& decision);
+
+// 按实测端到端帧耗时在 320 / 416 / 512 / 640 之间调整整帧推理的输入边长，使耗时保持在预算内
+// 平滑耗时连续超出预算 down_frames 帧时降一档；按像素数估算的上一档耗时连续低于预算的 up_ratio 倍
+// up_frames 帧时升一档；两次切换至少间隔 cooldown_ms，避免在相邻两档间来回跳
+// 时钟可注入，逻辑不依赖 ncnn 与 Android，可在 Linux 上单独验证
+class ResolutionController {
+public:
+    typedef double (*Clock)();  // 单调递增的毫秒时间
+
+    explicit ResolutionController(float budget_ms = 0.f, Clock clock = 0);
+
+    // budget_ms <= 0 时关闭调节，固定为最大边长；可在其他线程调用，下一帧起生效
+    void set_budget(float budget_ms);
+    float budget() const { return budget_ms.load(); }
+    // 模型不支持可变输入边长时关闭调节：input_size 立即回到最大边长，下一次 update 清空状态，重新开启后从最大边长开始
+    // 与预算独立，可在其他线程调用
+    void set_enabled(bool enabled);
+    void set_listener(ResolutionListener listener, void* userdata);
+
+    // 当前应使用的输入边长，可在其他线程读取
+    int input_size() const { return active_budget() > 0.f ? sizes[level.load()] : sizes[num_levels - 1]; }
+    double now() const { return clock(); }
+
+    // 以下在同一线程上调用
+    // 帧完成时调用，begin_ms 为该帧开始时的 now()；返回之后的输入边长
+    int frame_end(double begin_ms);
+    // 直接喂入一帧耗时，frame_end 即以测得的耗时调用它
+    int update(float latency_ms);
+
+    const ResolutionDecision& last_decision() const { return decision; }
+
+    static const int num_levels = 4;
+    static const int sizes[num_levels];
+
+    int down_frames;
+    int up_frames;
+    float up_ratio;
+    double cooldown_ms;
+    float smoothing;  // 耗时的指数平滑系数
+
+private:
+    void switch_to(int to, float latency_ms);
+    // 关闭调节时为 0
+    float active_budget() const { return enabled.load() ? budget_ms.load() : 0.f; }
+
+    Clock clock;
+    std::atomic<float> budget_ms;
+    std::atomic<bool> enabled;
+    std::atomic<int> level;
+    float applied_budget;  // update 上次见到的预算，变化时清空计数
+    float smoothed;
+    int over_count;
+    int under_count;
+    double last_switch_ms;
+    ResolutionDecision decision;
+    ResolutionListener listener;
+    void* listener_data;
+};
+
+#endif // RESOLUTION_CONTROLLER_H
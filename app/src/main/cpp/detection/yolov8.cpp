@@ -1,11 +1,19 @@
 #include "yolov8.h"
+#include "yolov8_layer.h"
+#include "yolov8n_param_id.h"
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
+#include <ncnn/layer_type.h>
+#include <ncnn/benchmark.h>
 #include <algorithm>
 #include <math.h>
-
-static float intersection_area(const Object& a, const Object& b);
-static void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold);
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define TAG "Yolov8"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
@@ -25,107 +33,727 @@ const char* Yolov8::class_names[] = {
     "时钟", "花瓶", "剪刀", "泰迪熊", "吹风机", "牙刷"
 };
 
-Yolov8::Yolov8() {}
-Yolov8::~Yolov8() {}
+Yolov8::Yolov8() : net(&yolov8), weights_asset(0), weights_map(0), weights_map_size(0),
+                   loaded_param_binary(false), weights_mem(0), loaded_fused(false), network_released(false),
+                   fused_postprocess(false), rect_inference(false), inference_threads(1),
+                   in_blob(-1), out_blob(-1), det_param_blob(-1), detections_blob(-1), prepared_empty(false) {}
+Yolov8::~Yolov8() {
+    for (size_t i = 0; i < tile_ctx.size(); i++) delete tile_ctx[i];
+    // 网络引用着映射的权重，先清空再解除映射
+    yolov8.clear();
+    unmap_weights();
+}
+
+// 读取 asset 的全部内容
+static int read_asset(AAssetManager* mgr, const char* path, std::string& text) {
+    AAsset* asset = AAssetManager_open(mgr, path, AASSET_MODE_BUFFER);
+    if (!asset) return -1;
+    off_t len = AAsset_getLength(asset);
+    text.resize(len);
+    int n = len > 0 ? AAsset_read(asset, &text[0], len) : 0;
+    AAsset_close(asset);
+    return n == len ? 0 : -1;
+}
+
+static int read_file(const char* path, std::string& text) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    text.resize(len > 0 ? len : 0);
+    size_t n = len > 0 ? fread(&text[0], 1, len, fp) : 0;
+    fclose(fp);
+    return len >= 0 && n == (size_t)len ? 0 : -1;
+}
+
+// param_to_bin.py 在 .bin 末尾写入的标记，其后为源 .param 的散列
+static const unsigned int param_hash_tag = 0x48534850;  // "PHSH"
+
+// FNV-1a 32 位，跳过 \r，与 param_to_bin.py 一致
+static unsigned int param_hash(const std::string& text) {
+    unsigned int h = 0x811c9dc5u;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\r') continue;
+        h = (h ^ (unsigned char)text[i]) * 0x01000193u;
+    }
+    return h;
+}
+
+// 优先读取 param_to_bin.py 生成的 <param_path>.bin，省去文本解析；
+// 其层数 / blob 数与末尾的源 param 散列须与编译进来的 yolov8n_param_id.h 一致，
+// 随包的文本 param 存在时其散列也须一致，否则视为过期，退回文本 param
+static int read_param(AAssetManager* mgr, const char* param_path, std::string& data, bool& binary) {
+    const std::string bin_path = std::string(param_path) + ".bin";
+    if ((mgr ? read_asset(mgr, bin_path.c_str(), data) : read_file(bin_path.c_str(), data)) == 0) {
+        int header[3] = {0, 0, 0};
+        unsigned int footer[2] = {0, 0};
+        if (data.size() >= sizeof(header) + sizeof(footer)) {
+            memcpy(header, data.data(), sizeof(header));
+            memcpy(footer, data.data() + data.size() - sizeof(footer), sizeof(footer));
+        }
+        std::string text;
+        const bool has_text = (mgr ? read_asset(mgr, param_path, text) : read_file(param_path, text)) == 0;
+        if (header[0] == 7767517 && header[1] == yolov8n_param_id::layer_count && header[2] == yolov8n_param_id::blob_count
+            && footer[0] == param_hash_tag && footer[1] == yolov8n_param_id::param_hash
+            && (!has_text || param_hash(text) == yolov8n_param_id::param_hash)) {
+            binary = true;
+            return 0;
+        }
+        LOGE("%s does not match %s or yolov8n_param_id.h, fallback to text param", bin_path.c_str(), param_path);
+        if (has_text) {
+            data.swap(text);
+            binary = false;
+            return 0;
+        }
+    }
+    binary = false;
+    return mgr ? read_asset(mgr, param_path, data) : read_file(param_path, data);
+}
+
+// 文本 param 加载后按名字查一次 blob 下标，推理时不再逐帧查找字符串
+static int find_blob(const ncnn::Net& net, const char* name) {
+    const std::vector<ncnn::Blob>& blobs = net.blobs();
+    for (size_t i = 0; i < blobs.size(); i++) {
+        if (blobs[i].name == name) return i;
+    }
+    return -1;
+}
+
+void Yolov8::unmap_weights() {
+    if (weights_asset) AAsset_close(weights_asset);
+    if (weights_map) munmap(weights_map, weights_map_size);
+    weights_asset = 0;
+    weights_map = 0;
+    weights_map_size = 0;
+}
+
+int Yolov8::load(AAssetManager* mgr, const char* param_path, const char* bin_path, bool fused) {
+    const double start = ncnn::get_current_time();
+    std::string param_text;
+    bool param_binary;
+    if (read_param(mgr, param_path, param_text, param_binary) != 0) {
+        LOGE("read %s failed", param_path);
+        return -1;
+    }
+
+    // 权重在 build.gradle 中设为 noCompress，AAsset_getBuffer 直接返回 APK 的只读映射，页面干净可被系统回收
+    weights_asset = AAssetManager_open(mgr, bin_path, AASSET_MODE_BUFFER);
+    if (!weights_asset) {
+        LOGE("open %s failed", bin_path);
+        return -1;
+    }
+    const unsigned char* mem = (const unsigned char*)AAsset_getBuffer(weights_asset);
+    int ret;
+    loaded_param = param_text;
+    loaded_param_binary = param_binary;
+    loaded_fused = fused;
+    if (mem && ((size_t)mem & 3) == 0) {
+        if (AAsset_isAllocated(weights_asset)) LOGE("%s is compressed, weights are decompressed to heap", bin_path);
+        weights_mem = mem;
+        ncnn::DataReaderFromMemory dr(mem);
+        ret = load_network(param_text, param_binary, dr, fused);
+    } else {
+        // 未按 4 字节对齐时只能逐层拷贝
+        LOGE("%s is not 4-byte aligned in apk, fallback to copy", bin_path);
+        AAsset_close(weights_asset);
+        weights_asset = AAssetManager_open(mgr, bin_path, AASSET_MODE_STREAMING);
+        if (!weights_asset) return -1;
+        ncnn::DataReaderFromAndroidAsset dr(weights_asset);
+        ret = load_network(param_text, param_binary, dr, fused);
+        AAsset_close(weights_asset);
+        weights_asset = 0;
+    }
+    return finish_load(ret, start);
+}
+
+int Yolov8::load(const char* param_path, const char* bin_path, bool fused) {
+    const double start = ncnn::get_current_time();
+    std::string param_text;
+    bool param_binary;
+    if (read_param(0, param_path, param_text, param_binary) != 0) {
+        LOGE("read %s failed", param_path);
+        return -1;
+    }
+
+    int fd = open(bin_path, O_RDONLY);
+    if (fd < 0) {
+        LOGE("open %s failed", bin_path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            weights_map = map;
+            weights_map_size = st.st_size;
+        }
+    }
+    close(fd);
+    if (!weights_map) {
+        LOGE("mmap %s failed", bin_path);
+        return -1;
+    }
+
+    const unsigned char* mem = (const unsigned char*)weights_map;
+    loaded_param = param_text;
+    loaded_param_binary = param_binary;
+    loaded_fused = fused;
+    weights_mem = mem;
+    ncnn::DataReaderFromMemory dr(mem);
+    return finish_load(load_network(param_text, param_binary, dr, fused), start);
+}
+
+int Yolov8::finish_load(int ret, double start_ms) {
+    if (ret != 0) return ret;
+    stats = LoadStats();
+    stats.load_ms = ncnn::get_current_time() - start_ms;
+    LOGD("load %.1f ms", stats.load_ms);
+    return warmup_params.runs > 0 ? warmup(warmup_params) : 0;
+}
 
-int Yolov8::load(AAssetManager* mgr, const char* param_path, const char* bin_path) {
+int Yolov8::load_network(std::string& param_text, bool param_binary, const ncnn::DataReader& weights, bool fused) {
     // 强制关闭 Vulkan 测试，解决华为设备驱动兼容性导致的识别异常
     yolov8.opt.use_vulkan_compute = false; 
-    yolov8.opt.use_fp16_packed = true;
-    yolov8.opt.use_fp16_storage = true;
-    yolov8.opt.use_fp16_arithmetic = true;
-    yolov8.opt.use_packing_layout = true;
+    // 线程数、fp16、packing、卷积算法与 blocktime 取自本机调优的档案，未调优时为默认配置
+    profile.apply(yolov8.opt);
+    // quantize_int8.py 生成的 int8 模型中量化卷积走 int8 路径，未量化的层仍按上面的 fp16 选项；fp 模型不受影响
+    yolov8.opt.use_int8_inference = true;
+    // 每层算完即释放不再用到的输入 blob，峰值只有相邻几层的特征图，而不是整张图的中间结果
+    yolov8.opt.lightmode = true;
+    // 池化分配器跨帧复用中间 blob 与 workspace，避免 30 fps 下的 malloc 抖动与碎片
+    yolov8.opt.blob_allocator = &ctx.blob_allocator;
+    yolov8.opt.workspace_allocator = &workspace_allocator;
 
-    if (yolov8.load_param(mgr, param_path) != 0 || yolov8.load_model(mgr, bin_path) != 0) {
+    fused_postprocess = false;
+    if (param_binary) {
+        // 二进制 param 已含融合层，自定义层按生成时的编号注册，blob 下标取自生成的头文件
+        yolov8.register_custom_layer(yolov8n_param_id::CUSTOM_LAYER_Yolov8DetectionOutput, Yolov8DetectionOutput_layer_creator);
+        const unsigned char* mem = (const unsigned char*)param_text.data();
+        ncnn::DataReaderFromMemory dr(mem);
+        if (yolov8.load_param_bin(dr) != 0) {
+            LOGE("load_param_bin failed");
+            return -1;
+        }
+        fused_postprocess = fused;
+        in_blob = yolov8n_param_id::BLOB_in0;
+        out_blob = yolov8n_param_id::BLOB_out0;
+        det_param_blob = yolov8n_param_id::BLOB_det_param;
+        detections_blob = yolov8n_param_id::BLOB_detections;
+    } else {
+        // 融合后处理：在 out0 后追加 Yolov8DetectionOutput，失败时退回逐帧解码
+        std::string plain_text;
+        if (fused) {
+            plain_text = param_text;
+            if (append_yolov8_detection_output(param_text, "out0", 0.25f, 0.45f, default_max_candidates, default_max_detections) == 0) {
+                yolov8.register_custom_layer(YOLOV8_DETECTION_OUTPUT_TYPE, Yolov8DetectionOutput_layer_creator);
+                if (yolov8.load_param_mem(param_text.c_str()) == 0) {
+                    fused_postprocess = true;
+                } else {
+                    LOGE("load fused param failed, fallback to plain param");
+                    yolov8.clear();
+                }
+            }
+            if (!fused_postprocess) param_text.swap(plain_text);
+        }
+        if (!fused_postprocess && yolov8.load_param_mem(param_text.c_str()) != 0) {
+            LOGE("load_param failed");
+            return -1;
+        }
+        in_blob = find_blob(yolov8, "in0");
+        out_blob = find_blob(yolov8, "out0");
+        det_param_blob = find_blob(yolov8, YOLOV8_DET_PARAM_BLOB);
+        detections_blob = find_blob(yolov8, YOLOV8_DETECTIONS_BLOB);
+    }
+
+    if (in_blob < 0 || out_blob < 0 || yolov8.load_model(weights) != 0) {
         LOGE("load_model failed");
         return -1;
     }
-    LOGD("model loaded successfully");
+    find_head_blobs();
+    set_thread_policy(thread_policy);
+    LOGD("model loaded successfully, fused postprocess %d, head blobs %d", fused_postprocess, (int)head_blobs.size());
     return 0;
 }
 
-int Yolov8::detect(const ncnn::Mat& rgb, std::vector<Object>& objects, float prob_threshold) {
-    objects.clear();
-    int img_w = rgb.w;
-    int img_h = rgb.h;
+int Yolov8::attach(const Yolov8& model) {
+    if (model.net->layers().empty()) return -1;
+    net = model.net;
+    fused_postprocess = model.fused_postprocess;
+    rect_inference = model.rect_inference;
+    head_blobs = model.head_blobs;
+    in_blob = model.in_blob;
+    out_blob = model.out_blob;
+    det_param_blob = model.det_param_blob;
+    detections_blob = model.detections_blob;
+    set_thread_policy(thread_policy);
+    stats = LoadStats();
+    return 0;
+}
+
+// 导出的图在检测头之后用 8400 个 anchor 的常量做 reshape 与解码，只接受 640x640 输入；
+// 检测头各尺度 cat(box, cls) 的输出紧接 Reshape，是卷积结果，可接受任意尺寸
+// 按 typeindex 匹配，二进制 param 加载的层不带类型名
+void Yolov8::find_head_blobs() {
+    head_blobs.clear();
+    const std::vector<ncnn::Blob>& blobs = yolov8.blobs();
+    const std::vector<ncnn::Layer*>& layers = yolov8.layers();
+    for (size_t i = 0; i < layers.size(); i++) {
+        const ncnn::Layer* layer = layers[i];
+        if (layer->typeindex != ncnn::LayerType::Reshape || layer->bottoms.size() != 1) continue;
+        const int producer = blobs[layer->bottoms[0]].producer;
+        if (producer >= 0 && layers[producer]->typeindex == ncnn::LayerType::Concat) head_blobs.push_back(layer->bottoms[0]);
+    }
+    // 按层顺序依次为 stride 8 / 16 / 32
+    if (head_blobs.size() != 3) {
+        LOGE("detect head not found, rect inference disabled");
+        head_blobs.clear();
+    }
+}
+
+void Yolov8::set_profile(const InferenceProfile& p) {
+    profile = p;
+}
+
+void Yolov8::set_warmup(const WarmupParams& params) {
+    warmup_params = params;
+}
+
+void Yolov8::InferenceContext::release() {
+    // extractor 持有上一帧各 blob 的引用，先于 blob 池清空
+    delete ex;
+    ex = 0;
+    in_pad.release();
+    det_param.release();
+    std::vector<ncnn::Mat>().swap(heads);
+    head_out.release();
+    letterbox_scratch = LetterboxScratch();
+    decode_scratch = DecodeScratch();
+    std::vector<Object>().swap(proposals);
+    blob_allocator.clear();
+}
+
+void Yolov8::trim(int level) {
+    ctx.release();
+    for (size_t i = 0; i < tile_ctx.size(); i++) delete tile_ctx[i];
+    std::vector<InferenceContext*>().swap(tile_ctx);
+    nms_ws = NmsWorkspace();
+    std::vector<Object>().swap(tile_proposals);
+    std::vector<unsigned char>().swap(yuv_scratch);
+    std::vector<unsigned char>().swap(rgb_scratch);
+    workspace_allocator.clear();
+    // 融合层的缓冲由共享网络的各实例共用，随持有网络的实例释放；detections 只由注册的自定义层产生
+    if (net == &yolov8 && !network_released && detections_blob >= 0) {
+        const int producer = yolov8.blobs()[detections_blob].producer;
+        ncnn::Layer* layer = producer >= 0 ? yolov8.layers()[producer] : 0;
+        if (layer && (layer->typeindex & ncnn::LayerType::CustomBit))
+            static_cast<Yolov8DetectionOutput*>(layer)->release_scratch();
+    }
+
+    if (level < TRIM_WEIGHTS || net != &yolov8 || network_released || !weights_mem) return;
+    // 重排后的权重在堆上，随网络释放；原始权重是 APK 或模型文件的只读映射，干净页由系统按需回收
+    yolov8.clear();
+    if (weights_map) madvise(weights_map, weights_map_size, MADV_DONTNEED);
+    network_released = true;
+    LOGD("network released");
+}
+
+int Yolov8::reload() {
+    if (!network_released) return 0;
+    const double start = ncnn::get_current_time();
+    std::string param_text = loaded_param;
+    ncnn::DataReaderFromMemory dr(weights_mem);
+    if (load_network(param_text, loaded_param_binary, dr, loaded_fused) != 0) {
+        yolov8.clear();
+        return -1;
+    }
+    network_released = false;
+    LOGD("network reloaded in %.1f ms", ncnn::get_current_time() - start);
+    return 0;
+}
+
+int Yolov8::autotune(AAssetManager* mgr, const char* param_path, const char* bin_path, const TuneParams& params,
+                     InferenceProfile& best) {
+    // 只测骨干网络的耗时与精度，融合层与选项无关；每个组合都重新加载，权重引用 asset 缓冲避免反复拷贝
+    std::string param_text;
+    if (read_asset(mgr, param_path, param_text) != 0) {
+        LOGE("read %s failed", param_path);
+        return -1;
+    }
+    AAsset* asset = AAssetManager_open(mgr, bin_path, AASSET_MODE_BUFFER);
+    if (!asset) {
+        LOGE("open %s failed", bin_path);
+        return -1;
+    }
+    const unsigned char* mem = (const unsigned char*)AAsset_getBuffer(asset);
+    std::vector<unsigned char> copy;
+    if (mem && ((size_t)mem & 3) != 0) {
+        copy.assign(mem, mem + AAsset_getLength(asset));
+        mem = &copy[0];
+    }
+    int ret = mem ? autotune_profile(param_text.c_str(), mem, params, best) : -1;
+    AAsset_close(asset);
+    return ret;
+}
+
+void Yolov8::set_rect_inference(bool enabled) {
+    rect_inference = enabled;
+}
+
+ncnn::CpuSet ThreadPolicy::cpu_set() const {
+    ncnn::CpuSet set;
+    if (mode == THREAD_CUSTOM) {
+        for (int i = 0; i < 64 && i < ncnn::get_cpu_count(); i++) {
+            if (mask & (1ull << i)) set.enable(i);
+        }
+    } else if (mode == THREAD_LITTLE || mode == THREAD_BIG) {
+        set = ncnn::get_cpu_thread_affinity_mask(mode);
+    }
+    if (set.num_enabled() == 0) set = ncnn::get_cpu_thread_affinity_mask(0);
+    return set;
+}
+
+void Yolov8::set_thread_policy(const ThreadPolicy& policy) {
+    thread_policy = policy;
+    thread_mask = policy.cpu_set();
+    inference_threads = std::max(1, std::min(net->opt.num_threads, thread_mask.num_enabled()));
+}
 
-    const int target_size = 640;
+// 每个线程记录当前绑定的策略，OpenMP 线程组随调用线程复用，同策略的嵌套或后续检测不重复绑定
+// set_cpu_powersave 改的是进程全局设置，不同调用方要落在不同核心上，只能逐线程绑定
+static thread_local bool thread_bound = false;
+static thread_local ThreadPolicy bound_policy;
+
+void Yolov8::bind_thread() {
+    if (thread_bound && bound_policy == thread_policy) return;
+    if (ncnn::set_cpu_thread_affinity(thread_mask) != 0) LOGE("bind thread to policy %d failed", thread_policy.mode);
+    thread_bound = true;
+    bound_policy = thread_policy;
+}
+
+// 检测入口在作用域内按策略绑定当前线程：已按同一策略绑定（bind_thread 或外层入口）时不做任何事，
+// 否则保存调用线程原有的亲和性，退出时连同 OpenMP 线程组一起恢复，借来的线程不被留在限定的核心上
+class ScopedThreadBinding {
+public:
+    ScopedThreadBinding(const ThreadPolicy& policy, const ncnn::CpuSet& mask)
+        : restore(false), prev_bound(thread_bound), prev_policy(bound_policy) {
+        if (thread_bound && bound_policy == policy) return;
+        if (sched_getaffinity(0, sizeof(saved.cpu_set), &saved.cpu_set) != 0) return;
+        if (ncnn::set_cpu_thread_affinity(mask) != 0) LOGE("bind thread to policy %d failed", policy.mode);
+        restore = true;
+        thread_bound = true;
+        bound_policy = policy;
+    }
+    ~ScopedThreadBinding() {
+        if (!restore) return;
+        ncnn::set_cpu_thread_affinity(saved);
+        thread_bound = prev_bound;
+        bound_policy = prev_policy;
+    }
+
+private:
+    ScopedThreadBinding(const ScopedThreadBinding&);
+    ScopedThreadBinding& operator=(const ScopedThreadBinding&);
+
+    bool restore;
+    bool prev_bound;
+    ThreadPolicy prev_policy;
+    ncnn::CpuSet saved;
+};
+
+int Yolov8::detect(const unsigned char* rgba, int width, int height, int stride, std::vector<Object>& objects,
+                   float prob_threshold, int max_candidates, int max_detections) {
+    return detect(rgba, width, height, stride, objects, prob_threshold, std::vector<int>(), max_candidates, max_detections);
+}
+
+static const int target_size = 640;
+
+static const int head_stride = 32;
+
+// 长边缩放到 size，返回缩放比例；rect 为 false 时填充到 size 正方形，
+// 否则每边只填充到 head_stride 的整数倍
+static float letterbox_size(int img_w, int img_h, int size, bool rect, int& w, int& h, int& target_w, int& target_h) {
     float scale = 1.f;
-    int w = img_w;
-    int h = img_h;
+    w = img_w;
+    h = img_h;
     if (w > h) {
-        scale = (float)target_size / w;
-        w = target_size;
+        scale = (float)size / w;
+        w = size;
         h = h * scale;
     } else {
-        scale = (float)target_size / h;
-        h = target_size;
+        scale = (float)size / h;
+        h = size;
         w = w * scale;
     }
+    target_w = rect ? (w + head_stride - 1) / head_stride * head_stride : size;
+    target_h = rect ? (h + head_stride - 1) / head_stride * head_stride : size;
+    return scale;
+}
 
-    ncnn::Mat in = ncnn::Mat::from_pixels_resize((const unsigned char*)rgb.data, ncnn::Mat::PIXEL_RGBA2RGB, img_w, img_h, img_w * 4, w, h);
+int Yolov8::inference_size(int size) const {
+    if (head_blobs.empty() || size <= 0) return target_size;
+    return (size + head_stride - 1) / head_stride * head_stride;
+}
 
-    // Letterbox 居中填充
-    int wpad = (target_size - w) / 2;
-    int hpad = (target_size - h) / 2;
-    ncnn::Mat in_pad;
-    ncnn::copy_make_border(in, in_pad, hpad, target_size - h - hpad, wpad, target_size - w - wpad, ncnn::BORDER_CONSTANT, 114.f);
+// roi 向外取整并截断到 [0, width) x [0, height)，为空时返回 -1
+static int clip_roi(const Object::Rect& roi, int width, int height, int& x0, int& y0, int& x1, int& y1) {
+    x0 = std::max(0, (int)floorf(roi.x));
+    y0 = std::max(0, (int)floorf(roi.y));
+    x1 = std::min(width, (int)ceilf(roi.x + roi.width));
+    y1 = std::min(height, (int)ceilf(roi.y + roi.height));
+    return x1 > x0 && y1 > y0 ? 0 : -1;
+}
 
-    const float norm_vals[3] = {1 / 255.f, 1 / 255.f, 1 / 255.f};
-    in_pad.substract_mean_normalize(0, norm_vals);
+int Yolov8::detect(const unsigned char* rgba, int width, int height, int stride, std::vector<Object>& objects,
+                   float prob_threshold, const std::vector<int>& class_ids,
+                   int max_candidates, int max_detections, const NmsParams& nms) {
+    Object::Rect roi = {0.f, 0.f, (float)width, (float)height};
+    return detect_roi(rgba, width, height, stride, roi, target_size, objects, prob_threshold, class_ids,
+                      max_candidates, max_detections, nms);
+}
 
-    ncnn::Extractor ex = yolov8.create_extractor();
-    ex.input("in0", in_pad);
-    ncnn::Mat out;
-    ex.extract("out0", out);
+int Yolov8::detect_roi(const unsigned char* rgba, int width, int height, int stride, const Object::Rect& roi, int roi_size,
+                       std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                       int max_candidates, int max_detections, const NmsParams& nms) {
+    objects.clear();
+    ScopedThreadBinding binding(thread_policy, thread_mask);
 
-    if (out.empty()) return -1;
+    int x0, y0, x1, y1;
+    if (clip_roi(roi, width, height, x0, y0, x1, y1) != 0) return -1;
+
+    LetterboxTransform tf = letterbox_roi(rgba, stride, 4, x0, y0, x1, y1, inference_size(roi_size), ctx, inference_threads);
+    return detect_letterboxed(tf, objects, prob_threshold, class_ids, max_candidates, max_detections, nms);
+}
 
-    std::vector<Object> proposals;
-    const int num_grid = out.w; // 8400
-    const int num_class = out.h - 4; // 80
-
-    for (int i = 0; i < num_grid; i++) {
-        float x_center = out.row(0)[i];
-        float y_center = out.row(1)[i];
-        float box_w = out.row(2)[i];
-        float box_h = out.row(3)[i];
-
-        int label = -1;
-        float score = -1.f;
-        for (int j = 0; j < num_class; j++) {
-            float class_score = out.row(4 + j)[i];
-            if (class_score > score) {
-                label = j;
-                score = class_score;
+int Yolov8::warmup(const WarmupParams& params) {
+    if (net->layers().empty()) return -1;
+    if (params.runs <= 0) return 0;
+    std::vector<int> sizes = params.sizes;
+    if (sizes.empty()) sizes.push_back(target_size);
+
+    // 走与实际检测相同的路径；灰图取相机帧的 4:3，开启最小填充时得到与实际相同的矩形输入
+    std::vector<unsigned char> image;
+    std::vector<Object> objects;
+    std::vector<double> steady;
+    const double start = ncnn::get_current_time();
+    for (size_t i = 0; i < sizes.size(); i++) {
+        const int w = std::max(sizes[i], head_stride);
+        const int h = w * 3 / 4;
+        image.assign((size_t)w * h * 4, 114);
+        Object::Rect roi = {0.f, 0.f, (float)w, (float)h};
+        for (int r = 0; r < params.runs; r++) {
+            const double t0 = ncnn::get_current_time();
+            if (detect_roi(&image[0], w, h, w * 4, roi, sizes[i], objects, 0.25f, std::vector<int>()) != 0) {
+                LOGE("warm-up at %d failed", sizes[i]);
+                return -1;
             }
+            const double ms = ncnn::get_current_time() - t0;
+            if (i == 0 && r == 0) stats.first_ms = ms;
+            else if (i == 0) steady.push_back(ms);
         }
+    }
+    stats.warmup_ms = ncnn::get_current_time() - start;
+    stats.warmup_runs = params.runs * (int)sizes.size();
+    stats.steady_ms = stats.first_ms;
+    if (!steady.empty()) {
+        std::nth_element(steady.begin(), steady.begin() + steady.size() / 2, steady.end());
+        stats.steady_ms = steady[steady.size() / 2];
+    }
+    LOGD("warm-up %d runs %.1f ms, first %.1f ms, steady %.1f ms", stats.warmup_runs, stats.warmup_ms,
+         stats.first_ms, stats.steady_ms);
+    return 0;
+}
+
+LetterboxTransform Yolov8::letterbox_roi(const unsigned char* src, int stride, int channels, int x0, int y0, int x1, int y1,
+                                         int size, InferenceContext& c, int num_threads) {
+    int w, h, target_w, target_h;
+    float scale = letterbox_size(x1 - x0, y1 - y0, size, rect_inference && !head_blobs.empty(), w, h, target_w, target_h);
+
+    // 缩放、丢弃 alpha、填充与归一化一次扫描写入 in_pad，裁剪只是偏移起点
+    int wpad, hpad;
+    letterbox_normalize(src + (size_t)y0 * stride + x0 * channels, x1 - x0, y1 - y0, stride, channels, w, h,
+                        target_w, target_h, 114.f, 1 / 255.f, c.in_pad, &wpad, &hpad, c.letterbox_scratch, num_threads);
+
+    // roi 原点并入填充量，还原后即为整幅图坐标
+    LetterboxTransform tf = {scale, wpad - x0 * scale, hpad - y0 * scale};
+    return tf;
+}
+
+// 起点 0，步长 tile * (1 - overlap)，最后一块贴齐末端
+static void tile_origins(int size, int tile, float overlap, std::vector<int>& origins) {
+    origins.clear();
+    if (size <= tile) {
+        origins.push_back(0);
+        return;
+    }
+    const int step = std::max(1, (int)(tile * (1.f - overlap)));
+    for (int p = 0; p + tile < size; p += step) origins.push_back(p);
+    origins.push_back(size - tile);
+}
+
+int Yolov8::detect_tiled(const unsigned char* rgba, int width, int height, int stride, const TileParams& tiles,
+                         std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                         int max_candidates, int max_detections, const NmsParams& nms) {
+    objects.clear();
+    if (width <= 0 || height <= 0 || tiles.tile_size <= 0) return -1;
+    ScopedThreadBinding binding(thread_policy, thread_mask);
 
-        if (score >= prob_threshold) {
-            // 将 640x640 空间内的坐标还原到原图
-            float x0 = (x_center - box_w * 0.5f - wpad) / scale;
-            float y0 = (y_center - box_h * 0.5f - hpad) / scale;
-            float x1 = (x_center + box_w * 0.5f - wpad) / scale;
-            float y1 = (y_center + box_h * 0.5f - hpad) / scale;
-
-            Object obj;
-            obj.rect.x = std::max(0.f, x0);
-            obj.rect.y = std::max(0.f, y0);
-            obj.rect.width = std::max(0.f, x1 - x0);
-            obj.rect.height = std::max(0.f, y1 - y0);
-            obj.label = label;
-            obj.prob = score;
-            proposals.push_back(obj);
+    std::vector<int>& xs = tile_xs;
+    std::vector<int>& ys = tile_ys;
+    tile_origins(width, tiles.tile_size, tiles.overlap, xs);
+    tile_origins(height, tiles.tile_size, tiles.overlap, ys);
+    const int num_tiles = xs.size() * ys.size();
+    const int size = inference_size(tiles.input_size);
+
+    // 多块并行推理；嵌套的 OpenMP 区域默认不再展开，各 extractor 内部实际为单线程
+    const int nw = std::max(1, std::min(num_tiles, inference_threads));
+    while ((int)tile_ctx.size() < nw) tile_ctx.push_back(new InferenceContext);
+    int failed = 0;
+
+    #pragma omp parallel for num_threads(nw) reduction(+:failed)
+    for (int t = 0; t < nw; t++) {
+        InferenceContext& c = *tile_ctx[t];
+        c.proposals.clear();
+        for (int i = t; i < num_tiles; i += nw) {
+            const int x0 = xs[i % xs.size()];
+            const int y0 = ys[i / xs.size()];
+            const int x1 = std::min(width, x0 + tiles.tile_size);
+            const int y1 = std::min(height, y0 + tiles.tile_size);
+            LetterboxTransform tf = letterbox_roi(rgba, stride, 4, x0, y0, x1, y1, size, c, 1);
+            if (extract_proposals(c, tf, prob_threshold, class_ids, max_candidates, 1) != 0) failed++;
         }
     }
+    if (failed > 0) return -1;
 
-    std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, 0.45f);
+    tile_proposals.clear();
+    if (tiles.full_frame && num_tiles > 1) {
+        LetterboxTransform tf = letterbox_roi(rgba, stride, 4, 0, 0, width, height, target_size, ctx, inference_threads);
+        ctx.proposals.clear();
+        if (extract_proposals(ctx, tf, prob_threshold, class_ids, max_candidates, inference_threads) != 0) return -1;
+        tile_proposals.insert(tile_proposals.end(), ctx.proposals.begin(), ctx.proposals.end());
+    }
+    for (int t = 0; t < nw; t++) {
+        tile_proposals.insert(tile_proposals.end(), tile_ctx[t]->proposals.begin(), tile_ctx[t]->proposals.end());
+    }
 
-    int count = picked.size();
-    objects.resize(count);
-    for (int i = 0; i < count; i++) {
-        objects[i] = proposals[picked[i]];
+    // 重叠区与整图推理的重复框在此按类别统一抑制
+    suppress(tile_proposals, objects, prob_threshold, max_detections, nms);
+    LOGD("tiled detect: %d tiles, %d proposals, %d objects", num_tiles, (int)tile_proposals.size(), (int)objects.size());
+    return 0;
+}
+
+int Yolov8::detect_yuv420(const Yuv420Planes& yuv, int rotate_type, std::vector<Object>& objects, float prob_threshold,
+                          const std::vector<int>& class_ids, int max_candidates, int max_detections, const NmsParams& nms) {
+    const bool transposed = rotate_type_transposed(rotate_type);
+    Object::Rect roi = {0.f, 0.f, (float)(transposed ? yuv.height : yuv.width), (float)(transposed ? yuv.width : yuv.height)};
+    return detect_yuv420_roi(yuv, rotate_type, roi, target_size, objects, prob_threshold, class_ids,
+                             max_candidates, max_detections, nms);
+}
+
+int Yolov8::detect_yuv420_roi(const Yuv420Planes& yuv, int rotate_type, const Object::Rect& roi, int roi_size,
+                              std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                              int max_candidates, int max_detections, const NmsParams& nms) {
+    objects.clear();
+    // 预处理与推理共用一次绑定
+    ScopedThreadBinding binding(thread_policy, thread_mask);
+    if (prepare_yuv420(yuv, rotate_type, roi, roi_size) != 0) return -1;
+    return detect_prepared(objects, prob_threshold, class_ids, max_candidates, max_detections, nms);
+}
+
+int Yolov8::prepare_yuv420(const Yuv420Planes& yuv, int rotate_type, const Object::Rect& roi, int roi_size) {
+    ScopedThreadBinding binding(thread_policy, thread_mask);
+    // roi 在旋转后的画面中给出，先映射回传感器方向按偶数像素裁剪，再映射回来得到实际区域
+    const bool transposed = rotate_type_transposed(rotate_type);
+    const int upright_w = transposed ? yuv.height : yuv.width;
+    const int upright_h = transposed ? yuv.width : yuv.height;
+    int x0, y0, x1, y1;
+    if (clip_roi(roi, upright_w, upright_h, x0, y0, x1, y1) != 0) return -1;
+    rotate_rect(inverse_rotate_type(rotate_type), upright_w, upright_h, x0, y0, x1, y1);
+    x0 &= ~1;
+    y0 &= ~1;
+    x1 = std::min(yuv.width, (x1 + 1) & ~1);
+    y1 = std::min(yuv.height, (y1 + 1) & ~1);
+    const Yuv420Planes crop = yuv420_crop(yuv, x0, y0, x1 - x0, y1 - y0);
+    rotate_rect(rotate_type, yuv.width, yuv.height, x0, y0, x1, y1);
+
+    // 按旋转后的画面计算 letterbox，检测框因此直接落在正向画面坐标系
+    const int size = inference_size(roi_size);
+    int w, h, target_w, target_h;
+    float scale = letterbox_size(x1 - x0, y1 - y0, size, rect_inference && !head_blobs.empty(), w, h, target_w, target_h);
+
+    // YUV420 缩放要求偶数宽高，短边向下取偶，比例误差不足一个像素
+    w &= ~1;
+    h &= ~1;
+    // 极细长的区域短边缩放后不足 2 像素，无从检测，按无结果处理
+    prepared_empty = w < 2 || h < 2;
+    if (prepared_empty) return 0;
+
+    rgb_scratch.resize((size_t)w * h * 3);
+    if (yuv420_to_rgb_resize(crop, w, h, rotate_type, &rgb_scratch[0], yuv_scratch) != 0) {
+        LOGE("unsupported yuv420 frame %d x %d", crop.width, crop.height);
+        return -1;
+    }
+
+    // 已是目标尺寸，只做填充与归一化
+    int wpad, hpad;
+    letterbox_normalize(&rgb_scratch[0], w, h, w * 3, 3, w, h, target_w, target_h, 114.f, 1 / 255.f,
+                        ctx.in_pad, &wpad, &hpad, ctx.letterbox_scratch, inference_threads);
+
+    LetterboxTransform tf = {scale, wpad - x0 * scale, hpad - y0 * scale};
+    prepared_tf = tf;
+    return 0;
+}
+
+int Yolov8::detect_prepared(std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                            int max_candidates, int max_detections, const NmsParams& nms) {
+    objects.clear();
+    if (prepared_empty) return 0;
+    if (ctx.in_pad.empty()) return -1;
+    // 流水线的线程已由 bind_thread 持久绑定，此处不再切换
+    ScopedThreadBinding binding(thread_policy, thread_mask);
+    return detect_letterboxed(prepared_tf, objects, prob_threshold, class_ids, max_candidates, max_detections, nms);
+}
+
+int Yolov8::detect_letterboxed(const LetterboxTransform& tf, std::vector<Object>& objects, float prob_threshold,
+                               const std::vector<int>& class_ids, int max_candidates, int max_detections, const NmsParams& nms) {
+    const bool square = ctx.in_pad.w == target_size && ctx.in_pad.h == target_size;
+
+    int count = 0;
+    if (fused_postprocess && square) {
+        ncnn::Extractor& ex = extractor(ctx);
+        ex.input(in_blob, ctx.in_pad);
+
+        // 阈值、类别与数量上限随 det_param 逐帧传入融合层
+        ncnn::Mat& det_param = ctx.det_param;
+        det_param.create(YOLOV8_DET_PARAM_HEADER + (int)class_ids.size());
+        float* p = det_param;
+        p[0] = prob_threshold;
+        p[1] = nms.iou_threshold;
+        p[2] = max_candidates;
+        p[3] = max_detections;
+        p[4] = nms.mode;
+        p[5] = nms.sigma;
+        for (size_t i = 0; i < class_ids.size(); i++) p[YOLOV8_DET_PARAM_HEADER + i] = class_ids[i];
+        ex.input(det_param_blob, det_param);
+
+        ncnn::Mat dets;
+        if (ex.extract(detections_blob, dets) != 0) return -1;
+
+        count = dets.h;
+        objects.resize(count);
+        for (int i = 0; i < count; i++) {
+            const float* row = dets.row(i);
+            letterbox_to_image(row[2], row[3], row[4], row[5], tf, objects[i]);
+            clip_to_image(objects[i]);
+            objects[i].label = (int)row[0];
+            objects[i].prob = row[1];
+        }
+    } else {
+        // 解码按 ncnn 线程数并行，与推理共用同一组 OpenMP 线程
+        ctx.proposals.clear();
+        if (extract_proposals(ctx, tf, prob_threshold, class_ids, max_candidates, inference_threads) != 0) return -1;
+        suppress(ctx.proposals, objects, prob_threshold, max_detections, nms);
+        count = objects.size();
     }
 
     if (count > 0) {
@@ -137,37 +765,57 @@ int Yolov8::detect(const ncnn::Mat& rgb, std::vector<Object>& objects, float pro
     return 0;
 }
 
-std::string Yolov8::get_class_name(int class_id) {
-    if (class_id >= 0 && class_id < num_classes) return std::string(class_names[class_id]);
-    return "unknown";
+ncnn::Extractor& Yolov8::extractor(InferenceContext& c) {
+    if (!c.ex) {
+        c.ex = new ncnn::Extractor(net->create_extractor());
+        c.ex->set_blob_allocator(&c.blob_allocator);
+        c.ex->set_workspace_allocator(&workspace_allocator);
+    }
+    c.ex->clear();
+    return *c.ex;
 }
 
-static inline float intersection_area(const Object& a, const Object& b) {
-    float inter_left = std::max(a.rect.x, b.rect.x);
-    float inter_top = std::max(a.rect.y, b.rect.y);
-    float inter_right = std::min(a.rect.x + a.rect.width, b.rect.x + b.rect.width);
-    float inter_bottom = std::min(a.rect.y + a.rect.height, b.rect.y + b.rect.height);
-    if (inter_right < inter_left || inter_bottom < inter_top) return 0.0f;
-    return (inter_right - inter_left) * (inter_bottom - inter_top);
-}
-
-static void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold) {
-    picked.clear();
-    const int n = faceobjects.size();
-    if (n == 0) return;
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++) areas[i] = faceobjects[i].rect.width * faceobjects[i].rect.height;
-    for (int i = 0; i < n; i++) {
-        const Object& a = faceobjects[i];
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++) {
-            const Object& b = faceobjects[picked[j]];
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            if (union_area <= 0) continue;
-            if (inter_area / union_area > nms_threshold && a.label == b.label) keep = 0;
+int Yolov8::extract_proposals(InferenceContext& c, const LetterboxTransform& tf, float prob_threshold,
+                              const std::vector<int>& class_ids, int max_candidates, int num_threads) {
+    ncnn::Extractor& ex = extractor(c);
+    ex.input(in_blob, c.in_pad);
+
+    // 非 640x640 输入只能走检测头输出，由 native 完成 DFL 与 anchor 解码
+    ncnn::Mat out;
+    if (c.in_pad.w == target_size && c.in_pad.h == target_size) {
+        ex.extract(out_blob, out);
+    } else {
+        if (head_blobs.empty()) return -1;
+        c.heads.resize(head_blobs.size());
+        int strides[3];
+        for (size_t l = 0; l < head_blobs.size(); l++) {
+            if (ex.extract(head_blobs[l], c.heads[l]) != 0) return -1;
+            strides[l] = c.in_pad.h / c.heads[l].h;
         }
-        if (keep) picked.push_back(i);
+        assemble_head_output(c.heads, strides, class_ids, c.head_out, c.decode_scratch, num_threads);
+        out = c.head_out;
     }
+
+    if (out.empty()) return -1;
+
+    decode_yolov8_output(out, prob_threshold, class_ids, max_candidates, tf, c.proposals, c.decode_scratch, num_threads);
+    return 0;
+}
+
+void Yolov8::suppress(std::vector<Object>& proposals, std::vector<Object>& objects, float prob_threshold,
+                      int max_detections, const NmsParams& nms) {
+    NmsParams params = nms;
+    params.score_threshold = prob_threshold;
+    suppress_bboxes(proposals, objects, params, nms_ws);
+
+    // 结果按分数降序，截断即保留得分最高的框
+    int count = objects.size();
+    if (max_detections > 0 && count > max_detections) count = max_detections;
+    objects.resize(count);
+    for (int i = 0; i < count; i++) clip_to_image(objects[i]);
 }
 
+std::string Yolov8::get_class_name(int class_id) {
+    if (class_id >= 0 && class_id < num_classes) return std::string(class_names[class_id]);
+    return "unknown";
+}
@@ -4,17 +4,70 @@
 #include <string>
 #include <vector>
 #include <ncnn/net.h>
+#include <ncnn/cpu.h>
+#include <ncnn/datareader.h>
 #include <android/asset_manager.h>
 
-struct Object {
-    struct Rect {
-        float x;
-        float y;
-        float width;
-        float height;
-    } rect;
-    int label;
-    float prob;
+#include "object.h"
+#include "yolov8_decode.h"
+#include "nms.h"
+#include "yuv_convert.h"
+#include "letterbox.h"
+#include "yolov8_tune.h"
+
+// 分块推理参数：tile_size 为原图上的块边长（像素），相邻块按 overlap 比例重叠
+// 各块缩放到 input_size 推理；full_frame 为 true 时额外做一次整图推理以保留大目标
+struct TileParams {
+    int tile_size;
+    float overlap;
+    int input_size;
+    bool full_frame;
+
+    TileParams() : tile_size(640), overlap(0.2f), input_size(640), full_frame(true) {}
+};
+
+// 推理线程绑定的核心：取值与 ncnn set_cpu_powersave 一致，另加自定义掩码
+enum ThreadPolicyMode {
+    THREAD_ALL = 0,
+    THREAD_LITTLE = 1,
+    THREAD_BIG = 2,
+    THREAD_CUSTOM = 3
+};
+
+struct ThreadPolicy {
+    int mode;
+    unsigned long long mask;  // THREAD_CUSTOM 时按位给出 CPU 编号
+
+    ThreadPolicy(int mode = THREAD_ALL, unsigned long long mask = 0) : mode(mode), mask(mask) {}
+    bool operator==(const ThreadPolicy& other) const { return mode == other.mode && mask == other.mask; }
+    // 对应的核心集合；设备没有该类核心或掩码为空时退回全部核心
+    ncnn::CpuSet cpu_set() const;
+};
+
+// 内存紧张时的释放级别
+enum TrimLevel {
+    TRIM_BUFFERS = 0,  // 推理缓冲与分配器中缓存的块
+    TRIM_WEIGHTS = 1   // 另外卸载网络，保留 param 与权重映射，reload 时从映射重建
+};
+
+// 加载后的预热：在 sizes 的各输入边长上各推理 runs 次，首帧的分配器扩容、权重重排与缺页在此付清
+// sizes 为空时按 640；runs <= 0 时不预热
+struct WarmupParams {
+    int runs;
+    std::vector<int> sizes;
+
+    WarmupParams() : runs(0) {}
+};
+
+// 加载与预热的耗时（毫秒）
+struct LoadStats {
+    double load_ms;    // 读取 param、权重并建图
+    double warmup_ms;  // 全部预热推理
+    double first_ms;   // 第一次推理
+    double steady_ms;  // 第一个尺寸上其余各次的中位数，即稳态单帧耗时
+    int warmup_runs;
+
+    LoadStats() : load_ms(0.0), warmup_ms(0.0), first_ms(0.0), steady_ms(0.0), warmup_runs(0) {}
 };
 
 class Yolov8 {
@@ -22,12 +75,179 @@ public:
     Yolov8();
     ~Yolov8();
 
-    int load(AAssetManager* mgr, const char* param_path, const char* bin_path);
-    int detect(const ncnn::Mat& rgb, std::vector<Object>& objects, float prob_threshold = 0.25f);
-    std::string get_class_name(int class_id);
+    // fused 为 true 时在 out0 后追加 Yolov8DetectionOutput 融合层，阈值 / argmax / NMS 在图内完成
+    // 权重 asset 未压缩存放时直接引用 APK 的映射页，不拷贝到堆上；被压缩时退回拷贝加载
+    int load(AAssetManager* mgr, const char* param_path, const char* bin_path, bool fused = true);
+    // 从文件路径加载（如下载到应用目录的模型），权重 mmap 后直接引用
+    int load(const char* param_path, const char* bin_path, bool fused = true);
+    // 与已加载的 model 共享网络权重，只另建自己的 extractor 与推理缓冲，两者可在不同线程并发推理
+    // 只能在新建的实例上调用，model 须比本实例后析构
+    int attach(const Yolov8& model);
+    // 推理选项，须在 load 前设置；attach 的实例沿用 model 的选项
+    void set_profile(const InferenceProfile& profile);
+    // 加载成功后按 params 预热，须在 load 前设置；默认不预热
+    void set_warmup(const WarmupParams& params);
+    // 立即按 params 预热，耗时记入 load_stats；未加载时返回 -1
+    int warmup(const WarmupParams& params);
+    // 最近一次 load / attach 及其后预热的耗时
+    const LoadStats& load_stats() const { return stats; }
+    // 按 level（TrimLevel）释放内存，只能在实例空闲时调用；下一次检测重新分配缓冲
+    // 持有网络的实例另释放融合层中空闲的后处理缓冲，共享实例正在使用的不受影响
+    // TRIM_WEIGHTS 只作用于持有网络的实例，且须在共享它的实例都已裁剪、空闲时调用；
+    // 权重逐层拷贝加载（asset 未对齐）时无映射可重建，只释放缓冲
+    void trim(int level);
+    // trim 卸载网络后从保留的 param 与权重映射重建，不重新预热；未卸载时直接返回 0
+    int reload();
+    bool weights_released() const { return network_released; }
+    // 用 asset 中的文本 param 与权重在本机调优，见 autotune_profile
+    static int autotune(AAssetManager* mgr, const char* param_path, const char* bin_path, const TuneParams& params,
+                        InferenceProfile& best);
+    // rgba 为 width x height 的 RGBA 像素，行距 stride 字节（如 Bitmap 锁定后的像素），只读不拷贝
+    // max_candidates: 进入 NMS 的候选框上限；max_detections: 输出框上限；<= 0 表示不限
+    int detect(const unsigned char* rgba, int width, int height, int stride, std::vector<Object>& objects,
+               float prob_threshold = 0.25f,
+               int max_candidates = default_max_candidates, int max_detections = default_max_detections);
+    // 只检测 class_ids 中的类别，其余类别的分数行不参与解码、NMS 与结果回传
+    // nms 选择硬 NMS / Soft-NMS / 加权框融合，Soft-NMS 以 prob_threshold 作为衰减后的保留阈值
+    int detect(const unsigned char* rgba, int width, int height, int stride, std::vector<Object>& objects,
+               float prob_threshold, const std::vector<int>& class_ids,
+               int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+               const NmsParams& nms = NmsParams());
+    // 只对 roi 区域推理：裁剪后长边缩放到 roi_size（32 的整数倍），坐标还原到整幅图
+    // 追踪已找到的目标时用较小的 roi_size 即可，小目标也得到更高的有效分辨率；
+    // roi_size 不为 640 时需要模型检测头，找不到检测头时按 640 推理
+    int detect_roi(const unsigned char* rgba, int width, int height, int stride, const Object::Rect& roi, int roi_size,
+                   std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                   int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+                   const NmsParams& nms = NmsParams());
+    // 直接接收相机 YUV_420_888 三平面，省去 YUV -> JPEG -> Bitmap 的往返
+    // rotate_type 为 yuv420_rotate_type 给出的方向，在缩小后的 YUV 上旋转 / 镜像；坐标对应旋转后的画面
+    int detect_yuv420(const Yuv420Planes& yuv, int rotate_type, std::vector<Object>& objects, float prob_threshold,
+                      const std::vector<int>& class_ids,
+                      int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+                      const NmsParams& nms = NmsParams());
+    // detect_yuv420 的 roi 版本，roi 为旋转后画面中的区域，裁剪时按偶数像素对齐
+    int detect_yuv420_roi(const Yuv420Planes& yuv, int rotate_type, const Object::Rect& roi, int roi_size,
+                          std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                          int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+                          const NmsParams& nms = NmsParams());
+    // detect_yuv420_roi 拆成预处理与推理两步，供流水线在不同线程上重叠相邻两帧；
+    // prepare_yuv420 把转换、缩放与归一化后的输入留在本实例，随后的 detect_prepared 对其推理
+    int prepare_yuv420(const Yuv420Planes& yuv, int rotate_type, const Object::Rect& roi, int roi_size);
+    int detect_prepared(std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                        int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+                        const NmsParams& nms = NmsParams());
+    // 分块推理：大图切成重叠的块，各块在并行的 extractor 上推理，框还原到整图后统一做按类别的抑制
+    // 用于在高分辨率照片中找钥匙、遥控器等小目标；nms 与 max_candidates（每块）/ max_detections 含义同 detect
+    int detect_tiled(const unsigned char* rgba, int width, int height, int stride, const TileParams& tiles,
+                     std::vector<Object>& objects, float prob_threshold, const std::vector<int>& class_ids,
+                     int max_candidates = default_max_candidates, int max_detections = default_max_detections,
+                     const NmsParams& nms = NmsParams());
+    // 开启后按最小填充推理：长边缩放到 640，短边只填充到 32 的整数倍（如 4:3 画面为 640x480）
+    // 非正方形输入不经过融合层，由检测头输出在 native 解码；模型找不到检测头时忽略
+    void set_rect_inference(bool enabled);
+    // 能否按 640 以外的输入边长推理：模型中找到检测头时为 true，否则 roi_size 等一律按 640
+    bool variable_input_size() const { return !head_blobs.empty(); }
+    // 之后各次检测期间把调用线程及其 OpenMP 线程组绑定到 policy 的核心上，返回前恢复调用线程原有的亲和性，
+    // 预处理与解码的线程数不超过核心数；ncnn 层内的线程数仍取加载时的选项
+    // 可在两次检测之间随时切换
+    void set_thread_policy(const ThreadPolicy& policy);
+    // 把当前线程及其 OpenMP 线程组持久绑定到 thread_policy 的核心，之后该线程上的检测不再切换、恢复亲和性
+    // 只应由专用于检测的线程调用（如相机流水线自己的线程），不能用在 Kotlin 的 IO 线程等借来的线程上
+    void bind_thread();
+    static std::string get_class_name(int class_id);
+
+    static const int default_max_candidates = 1000;
+    static const int default_max_detections = 300;
 
 private:
+    // 单个 extractor 的输入与解码缓冲，跨帧复用；预热后稳态推理不再向堆申请内存
+    struct InferenceContext {
+        // 中间 blob 与输出只在本 extractor 内流转，用无锁池；须先于下面的 Mat 构造、后于其析构
+        ncnn::UnlockedPoolAllocator blob_allocator;
+        ncnn::Extractor* ex;  // 首次推理时创建，之后每帧 clear 复用
+        ncnn::Mat in_pad;  // 归一化输入（640x640x3，或最小填充尺寸），由 letterbox_normalize 整帧覆写
+        ncnn::Mat det_param;  // 融合层逐帧参数
+        LetterboxScratch letterbox_scratch;
+        DecodeScratch decode_scratch;
+        std::vector<ncnn::Mat> heads;
+        ncnn::Mat head_out;  // 检测头拼接成的 out0 布局
+        std::vector<Object> proposals;
+
+        InferenceContext() : ex(0) {}
+        ~InferenceContext() { delete ex; }
+        // 释放 extractor 缓存的 blob 与各缓冲，最后清空 blob 池中已归还的块
+        void release();
+    };
+
+    // 取 c 的 extractor：清空上一帧的 blob 后绑定 c 的 blob 池与共享的 workspace 池
+    ncnn::Extractor& extractor(InferenceContext& c);
+
+    // 以 ctx.in_pad 为输入推理，按 tf 把结果还原到原图坐标后截断
+    int detect_letterboxed(const LetterboxTransform& tf, std::vector<Object>& objects, float prob_threshold,
+                           const std::vector<int>& class_ids, int max_candidates, int max_detections, const NmsParams& nms);
+    // 不经过融合层推理 c.in_pad 并解码，NMS 前的候选框按 tf 还原后追加到 c.proposals
+    int extract_proposals(InferenceContext& c, const LetterboxTransform& tf, float prob_threshold,
+                          const std::vector<int>& class_ids, int max_candidates, int num_threads);
+    // 把 src 中 roi 区域 letterbox 到 c.in_pad，返回还原到 src 坐标的变换
+    LetterboxTransform letterbox_roi(const unsigned char* src, int stride, int channels, int x0, int y0, int x1, int y1,
+                                     int size, InferenceContext& c, int num_threads);
+    // 对 proposals 做抑制并按 max_detections 截断到 objects，保留的框左上角截断到原图内
+    void suppress(std::vector<Object>& proposals, std::vector<Object>& objects, float prob_threshold,
+                  int max_detections, const NmsParams& nms);
+
+    // 设置推理选项，加载 param 与权重；weights 为内存时权重只引用不拷贝
+    // param_binary 为 true 时 param_text 是 param_to_bin.py 生成的二进制 param（已含融合层），否则为文本，按需追加融合层
+    int load_network(std::string& param_text, bool param_binary, const ncnn::DataReader& weights, bool fused);
+    // load 的收尾：记录耗时，加载成功时按 warmup_params 预热
+    int finish_load(int ret, double start_ms);
+    // 释放权重映射，须在网络清空之后
+    void unmap_weights();
+
+    void find_head_blobs();
+    // 检测头不可用时只能按 640 推理
+    int inference_size(int size) const;
+
     ncnn::Net yolov8;
+    ncnn::Net* net;  // 推理所用的网络，指向 yolov8 或 attach 的共享实例
+    // yolov8 的权重引用以下内存：未压缩 asset 的缓冲，或模型文件的 mmap
+    AAsset* weights_asset;
+    void* weights_map;
+    size_t weights_map_size;
+    // reload 所需：加载时的 param、权重起点（逐层拷贝加载时为 0）与 fused 参数
+    std::string loaded_param;
+    bool loaded_param_binary;
+    const unsigned char* weights_mem;
+    bool loaded_fused;
+    bool network_released;
+    InferenceProfile profile;
+    WarmupParams warmup_params;
+    LoadStats stats;
+    bool fused_postprocess;
+    bool rect_inference;
+    ThreadPolicy thread_policy;
+    ncnn::CpuSet thread_mask;
+    int inference_threads;  // 预处理与解码的线程数，受 thread_mask 的核心数限制
+    std::vector<int> head_blobs;  // 检测头 stride 8 / 16 / 32 的输出 blob 下标
+    // 输入输出 blob 下标，加载时确定，推理按下标 input / extract
+    int in_blob;
+    int out_blob;
+    int det_param_blob;
+    int detections_blob;
+
+    // 缓冲跨帧复用；detect 不可重入，调用方需保证串行
+    ncnn::PoolAllocator workspace_allocator;  // 各 extractor 共享，带锁
+    InferenceContext ctx;
+    std::vector<InferenceContext*> tile_ctx;  // 分块推理每个并行 extractor 一份
+    NmsWorkspace nms_ws;
+    std::vector<Object> tile_proposals;
+    std::vector<int> tile_xs;
+    std::vector<int> tile_ys;
+    std::vector<unsigned char> yuv_scratch;
+    std::vector<unsigned char> rgb_scratch;
+    LetterboxTransform prepared_tf;  // prepare_yuv420 得到的还原变换
+    bool prepared_empty;             // 区域缩放后不足 2 像素，detect_prepared 直接返回空结果
+
     static const char* class_names[];
     static const int num_classes = 80;
 };
@@ -0,0 +1,280 @@
+#include "yolov8_decode.h"
+#include "parallel_for.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+// 每次处理的 anchor 数，使 max/label 两个数组常驻 L1，类别行按段顺序读取
+static const int kAnchorBlock = 512;
+
+// 用第 label 行分数 row 更新 [0, n) 的 max/label，严格大于才替换
+static void argmax_update(const float* row, int label, int n, float* max_scores, int* max_labels) {
+    int i = 0;
+#if __ARM_NEON
+    int32x4_t _label = vdupq_n_s32(label);
+    for (; i + 3 < n; i += 4) {
+        float32x4_t _s = vld1q_f32(row + i);
+        float32x4_t _m = vld1q_f32(max_scores + i);
+        uint32x4_t _gt = vcgtq_f32(_s, _m);
+        vst1q_f32(max_scores + i, vbslq_f32(_gt, _s, _m));
+        vst1q_s32(max_labels + i, vbslq_s32(_gt, _label, vld1q_s32(max_labels + i)));
+    }
+#elif __AVX__
+    __m256 _label = _mm256_castsi256_ps(_mm256_set1_epi32(label));
+    for (; i + 7 < n; i += 8) {
+        __m256 _s = _mm256_loadu_ps(row + i);
+        __m256 _m = _mm256_loadu_ps(max_scores + i);
+        __m256 _gt = _mm256_cmp_ps(_s, _m, _CMP_GT_OQ);
+        _mm256_storeu_ps(max_scores + i, _mm256_blendv_ps(_m, _s, _gt));
+        __m256 _l = _mm256_loadu_ps((const float*)(max_labels + i));
+        _mm256_storeu_ps((float*)(max_labels + i), _mm256_blendv_ps(_l, _label, _gt));
+    }
+#elif __SSE2__
+    __m128i _label = _mm_set1_epi32(label);
+    for (; i + 3 < n; i += 4) {
+        __m128 _s = _mm_loadu_ps(row + i);
+        __m128 _m = _mm_loadu_ps(max_scores + i);
+        __m128 _gt = _mm_cmpgt_ps(_s, _m);
+        __m128i _gti = _mm_castps_si128(_gt);
+        _mm_storeu_ps(max_scores + i, _mm_or_ps(_mm_and_ps(_gt, _s), _mm_andnot_ps(_gt, _m)));
+        __m128i _l = _mm_loadu_si128((const __m128i*)(max_labels + i));
+        _mm_storeu_si128((__m128i*)(max_labels + i), _mm_or_si128(_mm_and_si128(_gti, _label), _mm_andnot_si128(_gti, _l)));
+    }
+#endif
+    for (; i < n; i++) {
+        if (row[i] > max_scores[i]) {
+            max_scores[i] = row[i];
+            max_labels[i] = label;
+        }
+    }
+}
+
+void argmax_class_rows(const float* scores, int stride, const int* class_ids, int num_ids, int num_anchor,
+                       float* max_scores, int* max_labels) {
+    for (int b = 0; b < num_anchor; b += kAnchorBlock) {
+        const int n = std::min(kAnchorBlock, num_anchor - b);
+        float* ms = max_scores + b;
+        int* ml = max_labels + b;
+
+        // 第一个类别直接作为初值
+        const float* row0 = scores + (size_t)class_ids[0] * stride + b;
+        for (int i = 0; i < n; i++) {
+            ms[i] = row0[i];
+            ml[i] = class_ids[0];
+        }
+        for (int k = 1; k < num_ids; k++) {
+            argmax_update(scores + (size_t)class_ids[k] * stride + b, class_ids[k], n, ms, ml);
+        }
+    }
+}
+
+// 堆比较：a 比 b 更优时返回 true，堆顶即为当前保留的最差候选
+static inline bool candidate_better(const Candidate& a, const Candidate& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.index < b.index;
+}
+
+static inline bool candidate_index_less(const Candidate& a, const Candidate& b) {
+    return a.index < b.index;
+}
+
+// 在 candidates 上维护容量为 max_candidates 的最小堆
+static inline void push_candidate(std::vector<Candidate>& candidates, const Candidate& c, int max_candidates) {
+    if ((int)candidates.size() < max_candidates) {
+        candidates.push_back(c);
+        std::push_heap(candidates.begin(), candidates.end(), candidate_better);
+    } else if (candidate_better(c, candidates.front())) {
+        std::pop_heap(candidates.begin(), candidates.end(), candidate_better);
+        candidates.back() = c;
+        std::push_heap(candidates.begin(), candidates.end(), candidate_better);
+    }
+}
+
+void select_candidates(const float* max_scores, int begin, int end, float prob_threshold, int max_candidates,
+                       std::vector<Candidate>& candidates) {
+    candidates.clear();
+    if (max_candidates <= 0) {
+        for (int i = begin; i < end; i++) {
+            if (max_scores[i] < prob_threshold) continue;
+            Candidate c = {max_scores[i], i};
+            candidates.push_back(c);
+        }
+        return;
+    }
+
+    candidates.reserve(max_candidates);
+    for (int i = begin; i < end; i++) {
+        if (max_scores[i] < prob_threshold) continue;
+        Candidate c = {max_scores[i], i};
+        push_candidate(candidates, c, max_candidates);
+    }
+    std::sort(candidates.begin(), candidates.end(), candidate_index_less);
+}
+
+void merge_candidates(const std::vector<std::vector<Candidate> >& parts, int num_parts, int max_candidates,
+                      std::vector<Candidate>& candidates) {
+    candidates.clear();
+    for (int t = 0; t < num_parts; t++) {
+        candidates.insert(candidates.end(), parts[t].begin(), parts[t].end());
+    }
+    if (max_candidates <= 0 || (int)candidates.size() <= max_candidates) return;
+
+    // (分数, 下标) 为全序，分段选择后再全局选择与整体一次选择结果相同
+    std::nth_element(candidates.begin(), candidates.begin() + max_candidates, candidates.end(), candidate_better);
+    candidates.resize(max_candidates);
+    std::sort(candidates.begin(), candidates.end(), candidate_index_less);
+}
+
+int prepare_class_ids(const std::vector<int>& class_ids, int num_class, std::vector<int>& ids) {
+    ids.clear();
+    if (class_ids.empty()) {
+        for (int j = 0; j < num_class; j++) ids.push_back(j);
+    } else {
+        for (size_t k = 0; k < class_ids.size(); k++) {
+            if (class_ids[k] >= 0 && class_ids[k] < num_class) ids.push_back(class_ids[k]);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+    return ids.size();
+}
+
+int decode_thread_count(int num_anchor, int num_threads) {
+    const int num_blocks = (num_anchor + kAnchorBlock - 1) / kAnchorBlock;
+    return std::max(1, std::min(num_threads, num_blocks));
+}
+
+void decode_thread_range(int num_anchor, int t, int nt, int* begin, int* end) {
+    const int num_blocks = (num_anchor + kAnchorBlock - 1) / kAnchorBlock;
+    *begin = num_blocks * t / nt * kAnchorBlock;
+    *end = std::min(num_anchor, num_blocks * (t + 1) / nt * kAnchorBlock);
+}
+
+void emit_proposals(const float* xs, const float* ys, const float* ws, const float* hs, int step,
+                    const DecodeScratch& scratch, const LetterboxTransform& tf, std::vector<Object>& proposals) {
+    for (size_t k = 0; k < scratch.candidates.size(); k++) {
+        const int i = scratch.candidates[k].index;
+        const size_t p = (size_t)i * step;
+
+        Object obj;
+        letterbox_to_image(xs[p] - ws[p] * 0.5f, ys[p] - hs[p] * 0.5f, xs[p] + ws[p] * 0.5f, ys[p] + hs[p] * 0.5f, tf, obj);
+        obj.label = scratch.max_labels[i];
+        obj.prob = scratch.max_scores[i];
+        proposals.push_back(obj);
+    }
+}
+
+void decode_yolov8_output(const ncnn::Mat& out, float prob_threshold, const std::vector<int>& class_ids,
+                          int max_candidates, const LetterboxTransform& tf, std::vector<Object>& proposals,
+                          DecodeScratch& scratch, int num_threads) {
+    const int num_anchor = out.w;
+    const int num_class = out.h - 4;
+    if (num_anchor <= 0 || num_class <= 0) return;
+
+    std::vector<int>& ids = scratch.class_ids;
+    if (prepare_class_ids(class_ids, num_class, ids) == 0) return;
+
+    scratch.max_scores.resize(num_anchor);
+    scratch.max_labels.resize(num_anchor);
+    float* max_scores = scratch.max_scores.data();
+    int* max_labels = scratch.max_labels.data();
+
+    // 按 kAnchorBlock 对齐切分 anchor，每个线程独立完成 argmax 与候选选择
+    const float* scores = out.row(4);
+    const int stride = out.w;
+    const int* ids_data = ids.data();
+    const int num_ids = ids.size();
+    const int nt = decode_thread_count(num_anchor, num_threads);
+    if ((int)scratch.thread_candidates.size() < nt) scratch.thread_candidates.resize(nt);
+
+    parallel_for(nt, nt, [&](int t) {
+        int begin, end;
+        decode_thread_range(num_anchor, t, nt, &begin, &end);
+        argmax_class_rows(scores + begin, stride, ids_data, num_ids, end - begin, max_scores + begin, max_labels + begin);
+        select_candidates(max_scores, begin, end, prob_threshold, max_candidates, scratch.thread_candidates[t]);
+    });
+
+    merge_candidates(scratch.thread_candidates, nt, max_candidates, scratch.candidates);
+
+    emit_proposals(out.row(0), out.row(1), out.row(2), out.row(3), 1, scratch, tf, proposals);
+}
+
+// DFL 期望：对相隔 cstep 的 kDflBins 个 logit 做 softmax 后按桶下标加权
+static inline float dfl_distance(const float* p, size_t cstep) {
+    float logits[kDflBins];
+    float max_logit = -FLT_MAX;
+    for (int j = 0; j < kDflBins; j++) {
+        logits[j] = p[j * cstep];
+        max_logit = std::max(max_logit, logits[j]);
+    }
+    float sum = 0.f;
+    float dist = 0.f;
+    for (int j = 0; j < kDflBins; j++) {
+        float e = expf(logits[j] - max_logit);
+        sum += e;
+        dist += e * j;
+    }
+    return dist / sum;
+}
+
+void assemble_head_output(const std::vector<ncnn::Mat>& heads, const int* strides, const std::vector<int>& class_ids,
+                          ncnn::Mat& out, DecodeScratch& scratch, int num_threads) {
+    int num_anchor = 0;
+    for (size_t l = 0; l < heads.size(); l++) num_anchor += heads[l].w * heads[l].h;
+    const int num_class = heads.empty() ? 0 : heads[0].c - 4 * kDflBins;
+    if (num_anchor <= 0 || num_class <= 0) {
+        out.release();
+        return;
+    }
+
+    out.create(num_anchor, 4 + num_class);
+    std::vector<int>& ids = scratch.class_ids;
+    const int num_ids = prepare_class_ids(class_ids, num_class, ids);
+
+    int offset = 0;
+    for (size_t l = 0; l < heads.size(); l++) {
+        const ncnn::Mat& feat = heads[l];
+        const int fw = feat.w;
+        const int n = feat.w * feat.h;
+        const float stride = strides[l];
+        float* cx = out.row(0) + offset;
+        float* cy = out.row(1) + offset;
+        float* bw = out.row(2) + offset;
+        float* bh = out.row(3) + offset;
+
+        const size_t cstep = feat.cstep;
+        const size_t side = cstep * kDflBins;
+
+        parallel_for(n, num_threads, [&](int i) {
+            const float* p = (const float*)feat.data + i;
+            const float ax = i % fw + 0.5f;
+            const float ay = i / fw + 0.5f;
+            const float x0 = ax - dfl_distance(p, cstep);
+            const float y0 = ay - dfl_distance(p + side, cstep);
+            const float x1 = ax + dfl_distance(p + side * 2, cstep);
+            const float y1 = ay + dfl_distance(p + side * 3, cstep);
+            cx[i] = (x0 + x1) * 0.5f * stride;
+            cy[i] = (y0 + y1) * 0.5f * stride;
+            bw[i] = (x1 - x0) * stride;
+            bh[i] = (y1 - y0) * stride;
+        });
+
+        parallel_for(num_ids, num_threads, [&](int k) {
+            const float* logit = feat.channel(4 * kDflBins + ids[k]);
+            float* score = out.row(4 + ids[k]) + offset;
+            for (int i = 0; i < n; i++) score[i] = 1.f / (1.f + expf(-logit[i]));
+        });
+
+        offset += n;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef YOLOV8_DECODE_H
+#define YOLOV8_DECODE_H
+
+#include <vector>
+#include <ncnn/mat.h>
+
+#include "object.h"
+
+// 网络输入坐标还原到原图：x_img = (x_net - pad_x) / scale
+struct LetterboxTransform {
+    float scale;
+    float pad_x;
+    float pad_y;
+};
+
+// 网络输入坐标系下的框 (x0, y0, x1, y1) 还原到原图，不做截断
+// 裁剪 roi 时 pad 为负，网络输入边缘不是原图边缘，截断只能在原图坐标下由 clip_to_image 做一次
+static inline void letterbox_to_image(float x0, float y0, float x1, float y1, const LetterboxTransform& tf, Object& obj) {
+    x0 = (x0 - tf.pad_x) / tf.scale;
+    y0 = (y0 - tf.pad_y) / tf.scale;
+    x1 = (x1 - tf.pad_x) / tf.scale;
+    y1 = (y1 - tf.pad_y) / tf.scale;
+    obj.rect.x = x0;
+    obj.rect.y = y0;
+    obj.rect.width = x1 - x0 > 0.f ? x1 - x0 : 0.f;
+    obj.rect.height = y1 - y0 > 0.f ? y1 - y0 : 0.f;
+}
+
+// 原图坐标下的框左上角截断到 0，右下角保持不变
+static inline void clip_to_image(Object& obj) {
+    if (obj.rect.x < 0.f) {
+        obj.rect.width = obj.rect.width + obj.rect.x > 0.f ? obj.rect.width + obj.rect.x : 0.f;
+        obj.rect.x = 0.f;
+    }
+    if (obj.rect.y < 0.f) {
+        obj.rect.height = obj.rect.height + obj.rect.y > 0.f ? obj.rect.height + obj.rect.y : 0.f;
+        obj.rect.y = 0.f;
+    }
+}
+
+// 通过阈值的 anchor，top-K 选择时按 (分数降序, 下标升序) 排序
+struct Candidate {
+    float score;
+    int index;
+};
+
+// 每个 anchor 的最大类别分数及类别下标，跨帧复用避免重复分配
+struct DecodeScratch {
+    std::vector<float> max_scores;
+    std::vector<int> max_labels;
+    std::vector<int> class_ids;
+    std::vector<Candidate> candidates;
+    std::vector<std::vector<Candidate> > thread_candidates;  // 并行解码时每个线程各自的候选缓冲
+};
+
+// 整理待扫描的类别到 ids：升序去重并丢弃越界 id，class_ids 为空表示全部类别
+// 返回有效类别数
+int prepare_class_ids(const std::vector<int>& class_ids, int num_class, std::vector<int>& ids);
+
+// 并行解码的线程数，以及第 t 个线程负责的 anchor 区间 [begin, end)（按块对齐）
+int decode_thread_count(int num_anchor, int num_threads);
+void decode_thread_range(int num_anchor, int t, int nt, int* begin, int* end);
+
+// 按类别行连续扫描 class_ids 指定的 num_ids 行分数（行距 stride 个 float），
+// 求 num_anchor 个 anchor 各自的最大分数及类别；class_ids 需升序，
+// 并列时取较小类别，与逐列比较结果一致
+void argmax_class_rows(const float* scores, int stride, const int* class_ids, int num_ids, int num_anchor,
+                       float* max_scores, int* max_labels);
+
+// 从 max_scores 的 [begin, end) 中选出分数不低于 prob_threshold 的 anchor，按下标升序写入 candidates
+// max_candidates > 0 时用容量固定的最小堆只保留分数最高的 max_candidates 个
+void select_candidates(const float* max_scores, int begin, int end, float prob_threshold, int max_candidates,
+                       std::vector<Candidate>& candidates);
+
+// 按线程顺序合并各段候选（各段下标递增且互不重叠），再做一次全局 top-K，
+// 结果与单线程 select_candidates 完全一致
+void merge_candidates(const std::vector<std::vector<Candidate> >& parts, int num_parts, int max_candidates,
+                      std::vector<Candidate>& candidates);
+
+// 按 candidates 还原框坐标并按顺序追加到 proposals；第 i 个 anchor 的坐标位于 xs/ys/ws/hs[i * step]
+void emit_proposals(const float* xs, const float* ys, const float* ws, const float* hs, int step,
+                    const DecodeScratch& scratch, const LetterboxTransform& tf, std::vector<Object>& proposals);
+
+// 解码 out0 ((4 + num_class) x num_anchor)，最大分数不低于 prob_threshold 的 anchor
+// 还原到原图坐标后按 anchor 顺序追加到 proposals，最多 max_candidates 个（<= 0 不限）
+// class_ids 非空时只扫描这些类别的分数行，其余类别视为不存在
+// anchor 按块切分给 num_threads 个 OpenMP 线程，输出与单线程逐位一致
+void decode_yolov8_output(const ncnn::Mat& out, float prob_threshold, const std::vector<int>& class_ids,
+                          int max_candidates, const LetterboxTransform& tf, std::vector<Object>& proposals,
+                          DecodeScratch& scratch, int num_threads = 1);
+
+// 检测头每条边的 DFL 分布桶数，单个尺度的原始输出为 4 * kDflBins 个距离 logit 后接 num_class 个分类 logit
+static const int kDflBins = 16;
+
+// 把检测头各尺度的原始输出 (4 * kDflBins + num_class) x h x w 拼成与 out0 相同的
+// (4 + num_class) x num_anchor 布局，anchor 按尺度、行、列顺序排列
+// 锚点取格子中心，DFL 期望得到 ltrb 距离后乘 strides[l] 还原到网络输入坐标，分类 logit 过 sigmoid
+// 只计算 class_ids 中类别的分数行（为空表示全部），其余行不写入
+void assemble_head_output(const std::vector<ncnn::Mat>& heads, const int* strides, const std::vector<int>& class_ids,
+                          ncnn::Mat& out, DecodeScratch& scratch, int num_threads = 1);
+
+#endif // YOLOV8_DECODE_H
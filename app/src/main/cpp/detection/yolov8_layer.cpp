@@ -0,0 +1,261 @@
+#include "yolov8_layer.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "yolov8_decode.h"
+#include "nms.h"
+#include "parallel_for.h"
+
+DEFINE_LAYER_CREATOR(Yolov8DetectionOutput)
+
+Yolov8DetectionOutput::Yolov8DetectionOutput() {
+    one_blob_only = false;
+    support_inplace = false;
+    // 直接读取打包 / 半精度的 out0，省去 ncnn 的解包与 fp32 转换
+    support_packing = true;
+    support_fp16_storage = true;
+
+    prob_threshold = 0.25f;
+    nms_threshold = 0.45f;
+    max_candidates = 1000;
+    max_detections = 300;
+    nms_mode = NMS_HARD;
+    sigma = 0.5f;
+}
+
+int Yolov8DetectionOutput::load_param(const ncnn::ParamDict& pd) {
+    prob_threshold = pd.get(0, 0.25f);
+    nms_threshold = pd.get(1, 0.45f);
+    max_candidates = pd.get(2, 1000);
+    max_detections = pd.get(3, 300);
+    nms_mode = pd.get(5, (int)NMS_HARD);
+    sigma = pd.get(6, 0.5f);
+
+    ncnn::Mat ids = pd.get(4, ncnn::Mat());
+    class_ids.clear();
+    const int* p = ids;
+    for (int i = 0; i < ids.w; i++) class_ids.push_back(p[i]);
+    return 0;
+}
+
+// 按元素位宽读取第 i 个元素，兼容 fp16 storage
+static inline float load_element(const void* data, int elembits, size_t i) {
+    if (elembits == 16) return ncnn::float16_to_float32(((const unsigned short*)data)[i]);
+    return ((const float*)data)[i];
+}
+
+// 在打包 / fp16 布局上求 [begin, end) 内每个 anchor 的 argmax
+// 第 r 通道位于第 r / elempack 组的 lane r % elempack；逐组顺序读取，组内按类别升序比较
+static void argmax_packed(const ncnn::Mat& out, const int* ids, int num_ids, int begin, int end,
+                          float* max_scores, int* max_labels) {
+    const int elempack = out.elempack;
+    const int elembits = out.elembits();
+    for (int i = begin; i < end; i++) {
+        max_scores[i] = -FLT_MAX;
+        max_labels[i] = ids[0];
+    }
+
+    int k = 0;
+    while (k < num_ids) {
+        const int g = (4 + ids[k]) / elempack;
+        int k_end = k + 1;
+        while (k_end < num_ids && (4 + ids[k_end]) / elempack == g) k_end++;
+
+        const void* row = (const unsigned char*)out.data + (size_t)out.w * out.elemsize * g;
+        for (int i = begin; i < end; i++) {
+            for (int kk = k; kk < k_end; kk++) {
+                const int lane = (4 + ids[kk]) % elempack;
+                float v = load_element(row, elembits, (size_t)i * elempack + lane);
+                if (v > max_scores[i]) {
+                    max_scores[i] = v;
+                    max_labels[i] = ids[kk];
+                }
+            }
+        }
+        k = k_end;
+    }
+}
+
+// 一次 forward 所需的全部缓冲，跨帧复用
+struct DetectionOutputScratch {
+    std::vector<int> wanted;
+    DecodeScratch decode;
+    DecodeScratch compact;
+    std::vector<float> coords;
+    std::vector<Object> proposals;
+    std::vector<Object> results;
+    NmsWorkspace nms_ws;
+};
+
+Yolov8DetectionOutput::~Yolov8DetectionOutput() {
+    for (size_t i = 0; i < free_scratch.size(); i++) delete free_scratch[i];
+}
+
+void Yolov8DetectionOutput::release_scratch() {
+    std::vector<DetectionOutputScratch*> released;
+    scratch_lock.lock();
+    released.swap(free_scratch);
+    scratch_lock.unlock();
+    for (size_t i = 0; i < released.size(); i++) delete released[i];
+}
+
+int Yolov8DetectionOutput::forward(const std::vector<ncnn::Mat>& bottom_blobs, std::vector<ncnn::Mat>& top_blobs, const ncnn::Option& opt) const {
+    DetectionOutputScratch* ws = 0;
+    scratch_lock.lock();
+    if (!free_scratch.empty()) {
+        ws = free_scratch.back();
+        free_scratch.pop_back();
+    }
+    scratch_lock.unlock();
+    if (!ws) ws = new DetectionOutputScratch;
+
+    int ret = forward_with(bottom_blobs, top_blobs, opt, *ws);
+
+    scratch_lock.lock();
+    free_scratch.push_back(ws);
+    scratch_lock.unlock();
+    return ret;
+}
+
+int Yolov8DetectionOutput::forward_with(const std::vector<ncnn::Mat>& bottom_blobs, std::vector<ncnn::Mat>& top_blobs, const ncnn::Option& opt,
+                                        DetectionOutputScratch& ws) const {
+    const ncnn::Mat& out = bottom_blobs[0];
+    const int num_anchor = out.w;
+    const int num_class = out.h * out.elempack - 4;
+    if (out.dims != 2 || num_anchor <= 0 || num_class <= 0) return -1;
+
+    float prob_thr = prob_threshold;
+    int max_cand = max_candidates;
+    int max_det = max_detections;
+    std::vector<int>& wanted = ws.wanted;
+    wanted.assign(class_ids.begin(), class_ids.end());
+    NmsParams nms;
+    nms.mode = nms_mode;
+    nms.iou_threshold = nms_threshold;
+    nms.sigma = sigma;
+    if (bottom_blobs.size() > 1 && !bottom_blobs[1].empty()) {
+        const ncnn::Mat& param = bottom_blobs[1];
+        const int n = param.w * param.elempack;
+        const int bits = param.elembits();
+        if (n >= YOLOV8_DET_PARAM_HEADER) {
+            prob_thr = load_element(param.data, bits, 0);
+            nms.iou_threshold = load_element(param.data, bits, 1);
+            max_cand = (int)load_element(param.data, bits, 2);
+            max_det = (int)load_element(param.data, bits, 3);
+            nms.mode = (int)load_element(param.data, bits, 4);
+            nms.sigma = load_element(param.data, bits, 5);
+            wanted.clear();
+            for (int i = YOLOV8_DET_PARAM_HEADER; i < n; i++) wanted.push_back((int)load_element(param.data, bits, i));
+        }
+    }
+    nms.score_threshold = prob_thr;
+
+    DecodeScratch& scratch = ws.decode;
+    if (prepare_class_ids(wanted, num_class, scratch.class_ids) == 0) return 0;
+    scratch.max_scores.resize(num_anchor);
+    scratch.max_labels.resize(num_anchor);
+
+    const bool plain = out.elempack == 1 && out.elembits() == 32;
+    const int* ids = scratch.class_ids.data();
+    const int num_ids = scratch.class_ids.size();
+    const int nt = decode_thread_count(num_anchor, opt.num_threads);
+    if ((int)scratch.thread_candidates.size() < nt) scratch.thread_candidates.resize(nt);
+
+    parallel_for(nt, nt, [&](int t) {
+        int begin, end;
+        decode_thread_range(num_anchor, t, nt, &begin, &end);
+        if (plain) {
+            argmax_class_rows(out.row(4) + begin, out.w, ids, num_ids, end - begin,
+                              &scratch.max_scores[begin], &scratch.max_labels[begin]);
+        } else {
+            argmax_packed(out, ids, num_ids, begin, end, scratch.max_scores.data(), scratch.max_labels.data());
+        }
+        select_candidates(scratch.max_scores.data(), begin, end, prob_thr, max_cand, scratch.thread_candidates[t]);
+    });
+    merge_candidates(scratch.thread_candidates, nt, max_cand, scratch.candidates);
+
+    // 坐标在第 0 组：fp32 直接按步长读取，fp16 只转换候选所需的 4 个通道
+    std::vector<Object>& proposals = ws.proposals;
+    proposals.clear();
+    const LetterboxTransform identity = {1.f, 0.f, 0.f};
+    if (out.elembits() == 32 && out.elempack == 1) {
+        emit_proposals(out.row(0), out.row(1), out.row(2), out.row(3), 1, scratch, identity, proposals);
+    } else if (out.elembits() == 32 && out.elempack == 4) {
+        const float* p = out.row(0);
+        emit_proposals(p, p + 1, p + 2, p + 3, 4, scratch, identity, proposals);
+    } else {
+        std::vector<float>& coords = ws.coords;
+        coords.resize(scratch.candidates.size() * 4);
+        DecodeScratch& compact = ws.compact;
+        compact.candidates.resize(scratch.candidates.size());
+        compact.max_scores.resize(scratch.candidates.size());
+        compact.max_labels.resize(scratch.candidates.size());
+        for (size_t k = 0; k < scratch.candidates.size(); k++) {
+            const int i = scratch.candidates[k].index;
+            for (int r = 0; r < 4; r++) {
+                const void* row = (const unsigned char*)out.data + (size_t)out.w * out.elemsize * (r / out.elempack);
+                coords[k * 4 + r] = load_element(row, out.elembits(), (size_t)i * out.elempack + r % out.elempack);
+            }
+            compact.candidates[k].index = k;
+            compact.max_scores[k] = scratch.max_scores[i];
+            compact.max_labels[k] = scratch.max_labels[i];
+        }
+        const float* p = coords.data();
+        emit_proposals(p, p + 1, p + 2, p + 3, 4, compact, identity, proposals);
+    }
+
+    std::vector<Object>& results = ws.results;
+    suppress_bboxes(proposals, results, nms, ws.nms_ws);
+
+    int count = results.size();
+    if (max_det > 0 && count > max_det) count = max_det;
+    if (count == 0) return 0;
+
+    ncnn::Mat& top_blob = top_blobs[0];
+    top_blob.create(6, count, 4u, opt.blob_allocator);
+    if (top_blob.empty()) return -100;
+
+    for (int i = 0; i < count; i++) {
+        const Object& obj = results[i];
+        float* row = top_blob.row(i);
+        row[0] = obj.label;
+        row[1] = obj.prob;
+        row[2] = obj.rect.x;
+        row[3] = obj.rect.y;
+        row[4] = obj.rect.x + obj.rect.width;
+        row[5] = obj.rect.y + obj.rect.height;
+    }
+    return 0;
+}
+
+int append_yolov8_detection_output(std::string& param_text, const char* out_blob,
+                                   float prob_threshold, float nms_threshold,
+                                   int max_candidates, int max_detections) {
+    // 第一行 magic，第二行 "layer_count blob_count"
+    size_t line1 = param_text.find('\n');
+    if (line1 == std::string::npos) return -1;
+    size_t line2 = param_text.find('\n', line1 + 1);
+    if (line2 == std::string::npos) return -1;
+
+    int layer_count = 0;
+    int blob_count = 0;
+    if (sscanf(param_text.c_str() + line1 + 1, "%d %d", &layer_count, &blob_count) != 2) return -1;
+
+    char header[64];
+    snprintf(header, sizeof(header), "%d %d", layer_count + 2, blob_count + 2);
+
+    char layers[512];
+    snprintf(layers, sizeof(layers),
+             "Input %s 0 1 %s\n"
+             "%s yolov8_detection_output 2 1 %s %s %s 0=%e 1=%e 2=%d 3=%d\n",
+             YOLOV8_DET_PARAM_BLOB, YOLOV8_DET_PARAM_BLOB,
+             YOLOV8_DETECTION_OUTPUT_TYPE, out_blob, YOLOV8_DET_PARAM_BLOB, YOLOV8_DETECTIONS_BLOB,
+             prob_threshold, nms_threshold, max_candidates, max_detections);
+
+    std::string body = param_text.substr(line2 + 1);
+    if (!body.empty() && body[body.size() - 1] != '\n') body += '\n';
+    param_text = param_text.substr(0, line1 + 1) + header + "\n" + body + layers;
+    return 0;
+}
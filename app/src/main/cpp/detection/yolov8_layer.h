@@ -0,0 +1,67 @@
+#ifndef YOLOV8_LAYER_H
+#define YOLOV8_LAYER_H
+
+#include <string>
+#include <vector>
+#include <ncnn/layer.h>
+#include <ncnn/platform.h>
+
+// YOLOv8 后处理融合层，接在 out0 之后，extract 直接得到 NMS 后的检测结果
+//
+// bottom 0: out0，(4 + num_class) x num_anchor，可为打包 / fp16 布局，原样读取不做转换
+// bottom 1: det_param（可选），逐帧覆盖 ParamDict 中的默认参数：
+//           [prob_threshold, nms_threshold, max_candidates, max_detections, nms_mode, sigma, class_id...]
+//           开启 fp16 storage 时 ncnn 会把它转成半精度，阈值误差在 1e-3 以内
+// top 0:    每行 [label, prob, x0, y0, x1, y1]，网络输入坐标且不截断，按分数降序；无结果时为空
+//
+// ParamDict：0=prob_threshold 1=nms_threshold 2=max_candidates 3=max_detections 4=class_ids（数组，空表示全部类别）
+//            5=nms_mode（NmsMode） 6=sigma（高斯 Soft-NMS）
+struct DetectionOutputScratch;
+
+class Yolov8DetectionOutput : public ncnn::Layer {
+public:
+    Yolov8DetectionOutput();
+    virtual ~Yolov8DetectionOutput();
+
+    virtual int load_param(const ncnn::ParamDict& pd);
+
+    virtual int forward(const std::vector<ncnn::Mat>& bottom_blobs, std::vector<ncnn::Mat>& top_blobs, const ncnn::Option& opt) const;
+
+    // 释放空闲列表中的缓冲，内存紧张时由 Yolov8::trim 调用；可与 forward 并发，正在使用的缓冲归还后留在列表中
+    void release_scratch();
+
+public:
+    float prob_threshold;
+    float nms_threshold;
+    int max_candidates;
+    int max_detections;
+    std::vector<int> class_ids;
+    int nms_mode;
+    float sigma;
+
+private:
+    int forward_with(const std::vector<ncnn::Mat>& bottom_blobs, std::vector<ncnn::Mat>& top_blobs, const ncnn::Option& opt,
+                     DetectionOutputScratch& ws) const;
+
+    // forward 为 const 且可能被多个 extractor 并发调用：每次调用从空闲列表取一份缓冲，返回前放回
+    // 缓冲份数等于最大并发数，不随调用线程变化而增长，稳态下不再分配
+    mutable ncnn::Mutex scratch_lock;
+    mutable std::vector<DetectionOutputScratch*> free_scratch;
+};
+
+ncnn::Layer* Yolov8DetectionOutput_layer_creator(void* userdata);
+
+// 融合层在图中的类型名与输入 / 输出 blob 名
+#define YOLOV8_DETECTION_OUTPUT_TYPE "Yolov8DetectionOutput"
+#define YOLOV8_DET_PARAM_BLOB "det_param"
+#define YOLOV8_DETECTIONS_BLOB "detections"
+// det_param 中类别列表之前的参数个数
+#define YOLOV8_DET_PARAM_HEADER 6
+
+// 在 param 文本末尾追加 det_param 输入与融合层，并修正头部的 layer / blob 计数
+// 成功返回 0，文本格式不符返回 -1
+int append_yolov8_detection_output(std::string& param_text, const char* out_blob,
+                                   float prob_threshold, float nms_threshold,
+                                   int max_candidates, int max_detections);
+
+#endif // YOLOV8_LAYER_H
@@ -0,0 +1,346 @@
+#include "yolov8_pool.h"
+#include <algorithm>
+#include <ncnn/platform.h>
+#include <sched.h>
+#include <android/log.h>
+
+#define TAG "Yolov8Pool"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+// 池中的实例记录自己所属的一代与槽位，release 据此归还
+struct Yolov8Pool::PooledYolov8 : public Yolov8 {
+    Generation* generation;
+    int slot;
+};
+
+// 一次加载得到的一组实例；以它为当前一代的每个调用方各持有一次引用，每个取出的实例各持有一次
+struct Yolov8Pool::Generation {
+    PooledYolov8* detectors[max_workers];  // detectors[0] 持有网络，其余 attach 到它
+    std::atomic<int> busy[max_workers];
+    int num_workers;
+    std::atomic<int> refs;
+    int owners;     // 以它为当前一代的调用方数，只在 load 中修改
+    bool retired;   // 已没有调用方以它为当前一代，由池的 wait_lock 保护
+    // trim 卸载网络后置位，取出实例的线程在 restore 中重建；lock 串行化 trim 与 restore
+    std::atomic<bool> released;
+    ncnn::Mutex lock;
+
+    std::string param_path;
+    std::string bin_path;
+    InferenceProfile profile;
+    LoadStats stats;
+
+    Generation() : num_workers(0), refs(1), owners(1), retired(false), released(false) {
+        for (int i = 0; i < max_workers; i++) {
+            detectors[i] = 0;
+            busy[i] = 0;
+        }
+    }
+    ~Generation() {
+        // 共享实例先于持有网络的 detectors[0] 析构
+        for (int i = max_workers - 1; i >= 0; i--) delete detectors[i];
+    }
+
+    // 网络已卸载时重建；失败时实例照常取出，检测返回 -1，下一次取出时重试
+    void restore() {
+        ncnn::MutexLockGuard guard(lock);
+        if (!released.load()) return;
+        if (detectors[0]->reload() != 0) {
+            LOGE("reload network failed");
+            return;
+        }
+        released = false;
+    }
+
+    bool same_model(const char* param, const char* bin, int n, const InferenceProfile& p) const {
+        return num_workers == n && param_path == param && bin_path == bin && profile.same_options(p);
+    }
+};
+
+// 未知调用方按实时相机计
+static int caller_index(int caller) {
+    return caller >= 0 && caller < CALLER_COUNT ? caller : CALLER_INTERACTIVE;
+}
+
+Yolov8Pool::Yolov8Pool() : readers(0), retiring(0), wake_seq(0), waiters(0), rect_inference(false) {
+    for (int i = 0; i < CALLER_COUNT; i++) {
+        current[i] = 0;
+        caller_limit[i] = 0;
+        caller_active[i] = 0;
+        policy_mode[i] = THREAD_ALL;
+        policy_mask[i] = 0;
+    }
+    // 后台任务默认最多占一个实例，不挤占相机流水线
+    caller_limit[CALLER_BACKGROUND] = 1;
+    // 实时相机跑在大核上压低延迟，后台任务留在小核，不与界面争抢
+    policy_mode[CALLER_INTERACTIVE] = THREAD_BIG;
+    policy_mode[CALLER_BACKGROUND] = THREAD_LITTLE;
+}
+
+Yolov8Pool::~Yolov8Pool() {
+    // 析构时调用方已不再推理，被替换的旧一代均已释放
+    for (int i = 0; i < CALLER_COUNT; i++) {
+        Generation* g = current[i].exchange(0);
+        if (g && --g->owners == 0) delete g;
+    }
+}
+
+Yolov8Pool::Generation* Yolov8Pool::enter(int caller) {
+    readers.fetch_add(1);
+    Generation* g = current[caller].load();
+    if (g) g->refs.fetch_add(1);
+    readers.fetch_sub(1);
+    return g;
+}
+
+void Yolov8Pool::unref(Generation* g) {
+    if (g->refs.fetch_sub(1) != 1) return;
+    {
+        // 已被替换的旧一代释放后，等待换代的 load 可以继续
+        ncnn::MutexLockGuard guard(wait_lock);
+        if (g->retired) {
+            retiring--;
+            wait_cond.broadcast();
+        }
+    }
+    delete g;
+}
+
+void Yolov8Pool::notify_waiters() {
+    if (waiters.load() == 0) return;
+    ncnn::MutexLockGuard guard(wait_lock);
+    wake_seq.fetch_add(1);
+    wait_cond.broadcast();
+}
+
+int Yolov8Pool::load(int caller, AAssetManager* mgr, const char* param, const char* bin, int n) {
+    caller = caller_index(caller);
+    if (n < 1) n = 1;
+    if (n > max_workers) n = max_workers;
+
+    // load 由调用方串行，各调用方的当前一代只会在这里被替换，可直接读取
+    Generation* old = current[caller].load();
+    if (old && old->same_model(param, bin, n, profile)) return 0;
+
+    // 另一调用方已加载相同的模型时共用它的实例，不另占内存
+    Generation* g = 0;
+    for (int i = 0; i < CALLER_COUNT && !g; i++) {
+        Generation* other = current[i].load();
+        if (i != caller && other && other->same_model(param, bin, n, profile)) g = other;
+    }
+    if (g) {
+        g->refs.fetch_add(1);
+        g->owners++;
+    } else {
+        g = build(mgr, param, bin, n);
+        if (!g) return -1;
+    }
+
+    if (old && old->owners == 1) {
+        // 最多保留一个被替换的旧一代：上一次替换下的实例还在推理时先等它们归还，单次推理以十毫秒计
+        ncnn::MutexLockGuard guard(wait_lock);
+        if (retiring > 0) {
+            waiters.fetch_add(1);
+            while (retiring > 0) wait_cond.wait(wait_lock);
+            waiters.fetch_sub(1);
+        }
+        old->retired = true;
+        retiring++;
+    }
+
+    current[caller].store(g);
+    // 等在已占满的旧一代上的 acquire 改从新一代取
+    notify_waiters();
+    if (old) {
+        old->owners--;
+        // 已读到旧指针的 enter 会在退出前加上引用，等它们结束后再放开调用方的引用
+        while (readers.load() != 0) sched_yield();
+        unref(old);
+    }
+    LOGD("caller %d: %d workers share %s, load %.1f ms, warm-up %.1f ms", caller, n, param, g->stats.load_ms,
+         g->stats.warmup_ms);
+    return 0;
+}
+
+Yolov8Pool::Generation* Yolov8Pool::build(AAssetManager* mgr, const char* param, const char* bin, int n) {
+    // 新一代在旁边建好，期间检测继续使用当前一代
+    Generation* g = new Generation;
+    g->param_path = param;
+    g->bin_path = bin;
+    g->profile = profile;
+    // 预热按实时相机的核心与填充方式进行，steady_ms 即相机帧的稳态耗时；取出时再按调用方设置
+    const ThreadPolicy interactive(policy_mode[CALLER_INTERACTIVE].load(), policy_mask[CALLER_INTERACTIVE].load());
+    // 共享实例的权重已在首个实例上重排，只需扩容各自的分配器
+    WarmupParams shared = warmup;
+    shared.runs = std::min(warmup.runs, 1);
+    LoadStats& stats = g->stats;
+    for (int i = 0; i < n; i++) {
+        PooledYolov8* detector = new PooledYolov8;
+        detector->generation = g;
+        detector->slot = i;
+        detector->set_profile(profile);
+        detector->set_rect_inference(rect_inference.load());
+        detector->set_thread_policy(interactive);
+        g->detectors[i] = detector;
+        int ret;
+        if (i == 0) {
+            detector->set_warmup(warmup);
+            ret = detector->load(mgr, param, bin);
+            stats = detector->load_stats();
+        } else {
+            ret = detector->attach(*g->detectors[0]);
+            if (ret == 0) ret = detector->warmup(shared);
+            stats.warmup_ms += detector->load_stats().warmup_ms;
+            stats.warmup_runs += detector->load_stats().warmup_runs;
+        }
+        if (ret != 0) {
+            LOGE("load %s failed, keep current model", param);
+            delete g;
+            return 0;
+        }
+    }
+    g->num_workers = n;
+    return g;
+}
+
+void Yolov8Pool::set_caller_limit(int caller, int limit) {
+    caller_limit[caller_index(caller)] = limit;
+    // 放宽上限后等待中的 acquire 可以重试
+    notify_waiters();
+}
+
+void Yolov8Pool::set_rect_inference(bool enabled) {
+    rect_inference = enabled;
+}
+
+void Yolov8Pool::set_thread_policy(int caller, const ThreadPolicy& policy) {
+    caller = caller_index(caller);
+    policy_mask[caller] = policy.mask;
+    policy_mode[caller] = policy.mode;
+}
+
+void Yolov8Pool::set_profile(const InferenceProfile& p) {
+    profile = p;
+}
+
+void Yolov8Pool::set_warmup(const WarmupParams& params) {
+    warmup = params;
+}
+
+LoadStats Yolov8Pool::load_stats(int caller) const {
+    const Generation* g = current[caller_index(caller)].load();
+    return g ? g->stats : LoadStats();
+}
+
+int Yolov8Pool::trim(int level) {
+    // 两个调用方共用一代时只裁剪一次；引用保持到最后，比较的指针不会被释放后复用
+    Generation* generations[CALLER_COUNT];
+    int num_generations = 0;
+    int trimmed = -1;
+    for (int i = 0; i < CALLER_COUNT; i++) {
+        Generation* g = enter(i);
+        if (!g) continue;
+        generations[num_generations++] = g;
+        if (std::find(generations, generations + num_generations - 1, g) != generations + num_generations - 1) continue;
+        const int applied = trim_generation(g, level);
+        trimmed = trimmed < 0 ? applied : std::min(trimmed, applied);
+    }
+    for (int i = 0; i < num_generations; i++) unref(generations[i]);
+    return trimmed;
+}
+
+int Yolov8Pool::trim_generation(Generation* g, int level) {
+    // 占下全部空闲实例，期间 acquire 等待；释放本身只需几毫秒
+    bool taken[max_workers];
+    int num_taken = 0;
+    for (int i = 0; i < g->num_workers; i++) {
+        int expected = 0;
+        taken[i] = g->busy[i].compare_exchange_strong(expected, 1);
+        if (taken[i]) num_taken++;
+    }
+    // 共享网络的实例有在推理的，不能卸载网络
+    if (level >= TRIM_WEIGHTS && num_taken < g->num_workers) level = TRIM_BUFFERS;
+
+    {
+        ncnn::MutexLockGuard guard(g->lock);
+        for (int i = g->num_workers - 1; i >= 0; i--) {
+            if (taken[i]) g->detectors[i]->trim(level);
+        }
+        if (level >= TRIM_WEIGHTS) {
+            if (g->detectors[0]->weights_released()) g->released = true;
+            else level = TRIM_BUFFERS;
+        }
+    }
+
+    LOGD("trim level %d, %d of %d workers idle", level, num_taken, g->num_workers);
+    for (int i = 0; i < g->num_workers; i++) {
+        if (taken[i]) g->busy[i].store(0);
+    }
+    notify_waiters();
+    return level;
+}
+
+bool Yolov8Pool::reserve_caller(int caller) {
+    std::atomic<int>& active = caller_active[caller];
+    int n = active.load();
+    for (;;) {
+        const int limit = caller_limit[caller].load();
+        if (limit > 0 && n >= limit) return false;
+        if (active.compare_exchange_weak(n, n + 1)) return true;
+    }
+}
+
+Yolov8* Yolov8Pool::try_acquire(int caller) {
+    caller = caller_index(caller);
+    if (!reserve_caller(caller)) return 0;
+
+    Generation* g = enter(caller);
+    if (g) {
+        for (int i = 0; i < g->num_workers; i++) {
+            int expected = 0;
+            if (!g->busy[i].compare_exchange_strong(expected, 1)) continue;
+            // 取出的实例持有 enter 加上的引用，归还时释放
+            Yolov8* detector = g->detectors[i];
+            if (g->released.load()) g->restore();
+            detector->set_rect_inference(rect_inference.load());
+            detector->set_thread_policy(ThreadPolicy(policy_mode[caller].load(), policy_mask[caller].load()));
+            return detector;
+        }
+        unref(g);
+    }
+
+    caller_active[caller].fetch_sub(1);
+    return 0;
+}
+
+Yolov8* Yolov8Pool::acquire(int caller, const std::atomic<bool>* running) {
+    const int index = caller_index(caller);
+    Yolov8* detector = try_acquire(index);
+    if (detector || !current[index].load()) return detector;
+
+    // 先登记等待再重试：release 在归还之后读 waiters，两者都是顺序一致的原子操作，
+    // 要么重试时已能取到，要么 release 看到等待者并推进 wake_seq；重试期间的归还使 wake_seq 变化，不会错过
+    // running 在读取 wake_seq 之后检查，停止方置 false 再唤醒，同理不会错过
+    waiters.fetch_add(1);
+    for (;;) {
+        const unsigned seq = wake_seq.load();
+        if (running && !running->load()) break;
+        detector = try_acquire(index);
+        if (detector || !current[index].load()) break;
+        ncnn::MutexLockGuard guard(wait_lock);
+        while (wake_seq.load() == seq) wait_cond.wait(wait_lock);
+    }
+    waiters.fetch_sub(1);
+    return detector;
+}
+
+void Yolov8Pool::release(Yolov8* detector, int caller) {
+    if (!detector) return;
+    PooledYolov8* pooled = static_cast<PooledYolov8*>(detector);
+    Generation* g = pooled->generation;
+    g->busy[pooled->slot].store(0);
+    caller_active[caller_index(caller)].fetch_sub(1);
+    unref(g);
+    notify_waiters();
+}
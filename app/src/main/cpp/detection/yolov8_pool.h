@@ -0,0 +1,117 @@
+#ifndef YOLOV8_POOL_H
+#define YOLOV8_POOL_H
+
+#include <atomic>
+#include <string>
+#include <ncnn/platform.h>
+#include <android/asset_manager.h>
+
+#include "yolov8.h"
+
+// 调用方：实时相机与后台任务（图库索引、场景识别）分开限流，互不排队
+enum DetectCaller {
+    CALLER_INTERACTIVE = 0,
+    CALLER_BACKGROUND = 1,
+    CALLER_COUNT = 2
+};
+
+// 检测实例池：多个 Yolov8 共享一份已加载的权重，各自持有 extractor 与推理缓冲，可在不同线程并发推理
+// 没有线程在等待时 acquire / release 只用原子操作，不经过互斥锁；load / set_* / load_stats 由调用方保证串行
+// 每次加载得到一代实例，按引用计数管理：新一代加载完成后原子替换，已取出的旧实例照常推理，
+// 最后一个归还时旧一代随之释放；被替换后仍在推理的旧一代同时最多一个
+// 各调用方分别持有当前一代：模型、实例数与选项相同时共用一代，不同时各自一代，一方换模型不影响另一方
+class Yolov8Pool {
+public:
+    Yolov8Pool();
+    ~Yolov8Pool();
+
+    // 为 caller 加载模型并建立 num_workers 个实例（1 ~ max_workers），完成后替换 caller 的当前一代；加载期间检测照常进行
+    // caller 已用相同模型、实例数与选项加载时直接返回 0，另一调用方已加载时共用其实例；
+    // 加载失败时保留当前一代并返回 -1
+    int load(int caller, AAssetManager* mgr, const char* param_path, const char* bin_path, int num_workers);
+    // caller 同时持有的实例数上限，<= 0 表示只受池大小限制
+    void set_caller_limit(int caller, int limit);
+    // 在实例被取出时生效，重新加载后保持
+    void set_rect_inference(bool enabled);
+    // caller 取到的实例按 policy 绑定核心，下一次 acquire 起生效
+    void set_thread_policy(int caller, const ThreadPolicy& policy);
+    // 推理选项在下一次 load 时生效，与已加载的选项不同时换一代实例
+    void set_profile(const InferenceProfile& profile);
+    // 之后每次 load 在替换前预热新一代：持有网络的实例按 params 预热，共享实例各尺寸推理一次
+    void set_warmup(const WarmupParams& params);
+    // caller 当前一代的加载与预热耗时，warmup_ms 含全部实例；尚未加载时全为 0
+    LoadStats load_stats(int caller) const;
+    // 内存紧张时按 level（TrimLevel）释放各调用方当前一代空闲实例的内存，可与检测并发调用；
+    // TRIM_WEIGHTS 要求一代的全部实例空闲，否则该代只释放缓冲；卸载后第一次 acquire 从权重映射重建网络
+    // 返回各代中最低的实际生效级别，尚未加载时返回 -1
+    int trim(int level);
+
+    // 取 caller 当前一代的一个空闲实例；已占满或 caller 已达上限时阻塞到有实例归还，caller 尚未加载时返回 0
+    // 给出 running 时，等待中发现其为 false 即返回 0；置 false 后调用 notify_waiters 唤醒正在等待的线程
+    Yolov8* acquire(int caller, const std::atomic<bool>* running = 0);
+    // 取不到时立即返回 0
+    Yolov8* try_acquire(int caller);
+    // 归还到实例所属的那一代，即使期间已换代
+    void release(Yolov8* detector, int caller);
+    // 唤醒 acquire 中等待的线程重新检查，有实例归还、换代或放宽上限时池自己调用
+    void notify_waiters();
+    // 进入 acquire 等待流程与 load 中等旧一代释放的线程数，测试据此确认线程已在等待而非尚未开始
+    int waiting() const { return waiters.load(); }
+
+    static const int max_workers = 8;
+    // 相机流水线同时占两个实例（一帧预处理、一帧推理），另留一个给后台任务
+    static const int default_workers = 3;
+
+private:
+    struct Generation;
+    struct PooledYolov8;
+
+    // 占用 caller 的一个名额，已达上限返回 false
+    bool reserve_caller(int caller);
+    // 建立一代实例，失败时返回 0
+    Generation* build(AAssetManager* mgr, const char* param_path, const char* bin_path, int num_workers);
+    // 取 caller 的当前一代并加一次引用，尚未加载时返回 0
+    Generation* enter(int caller);
+    // 减一次引用，归零时释放
+    void unref(Generation* generation);
+    // 释放 generation 中空闲实例的内存，返回实际生效的级别
+    int trim_generation(Generation* generation, int level);
+
+    std::atomic<Generation*> current[CALLER_COUNT];
+    std::atomic<int> readers;  // 正在 enter 中的线程数，换代后等其归零再放开旧一代
+    // wait_lock 保护 retiring 与 wake_seq；wait_cond 在有实例归还、换代或旧一代释放时广播
+    ncnn::Mutex wait_lock;
+    ncnn::ConditionVariable wait_cond;
+    int retiring;                     // 已被替换、仍有实例在推理的代数
+    std::atomic<unsigned> wake_seq;   // 每次广播加一，等待者据此判断重试之后是否有过归还
+    std::atomic<int> waiters;         // acquire / load 中等待的线程数，为 0 时 release 不取锁
+    std::atomic<int> caller_limit[CALLER_COUNT];
+    std::atomic<int> caller_active[CALLER_COUNT];
+    std::atomic<bool> rect_inference;
+    std::atomic<int> policy_mode[CALLER_COUNT];
+    std::atomic<unsigned long long> policy_mask[CALLER_COUNT];
+    InferenceProfile profile;
+    WarmupParams warmup;
+};
+
+// 在作用域内持有池中的一个实例，析构时归还
+class Yolov8PoolGuard {
+public:
+    Yolov8PoolGuard(Yolov8Pool& pool, int caller) : pool(pool), caller(caller), detector(pool.acquire(caller)) {}
+    ~Yolov8PoolGuard() {
+        if (detector) pool.release(detector, caller);
+    }
+
+    Yolov8* get() const { return detector; }
+    Yolov8* operator->() const { return detector; }
+
+private:
+    Yolov8PoolGuard(const Yolov8PoolGuard&);
+    Yolov8PoolGuard& operator=(const Yolov8PoolGuard&);
+
+    Yolov8Pool& pool;
+    int caller;
+    Yolov8* detector;
+};
+
+#endif // YOLOV8_POOL_H
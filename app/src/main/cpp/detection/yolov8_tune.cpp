@@ -0,0 +1,310 @@
+#include "yolov8_tune.h"
+#include "yolov8_decode.h"
+#include "nms.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <ncnn/net.h>
+#include <ncnn/cpu.h>
+#include <ncnn/benchmark.h>
+#include <ncnn/datareader.h>
+
+#if __ANDROID__
+#include <android/log.h>
+#define TAG "Yolov8Tune"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+#else
+#define LOGD(...) do { fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while (0)
+#define LOGE(...) LOGD(__VA_ARGS__)
+#endif
+
+InferenceProfile::InferenceProfile()
+    : num_threads(0), fp16(true), packing_layout(true), winograd(true), sgemm(true), openmp_blocktime(20),
+      latency_ms(0.f) {}
+
+void InferenceProfile::apply(ncnn::Option& opt) const {
+    if (num_threads > 0) opt.num_threads = num_threads;
+    opt.use_fp16_packed = fp16;
+    opt.use_fp16_storage = fp16;
+    opt.use_fp16_arithmetic = fp16;
+    opt.use_packing_layout = packing_layout;
+    opt.use_winograd_convolution = winograd;
+    opt.use_sgemm_convolution = sgemm;
+    opt.openmp_blocktime = openmp_blocktime;
+}
+
+bool InferenceProfile::same_options(const InferenceProfile& other) const {
+    return num_threads == other.num_threads && fp16 == other.fp16 && packing_layout == other.packing_layout
+           && winograd == other.winograd && sgemm == other.sgemm && openmp_blocktime == other.openmp_blocktime;
+}
+
+int InferenceProfile::load(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    InferenceProfile p;
+    int n = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), fp)) {
+        char key[64];
+        float value;
+        if (sscanf(line, "%63[^=]=%f", key, &value) != 2) continue;
+        n++;
+        if (strcmp(key, "num_threads") == 0) p.num_threads = (int)value;
+        else if (strcmp(key, "fp16") == 0) p.fp16 = value != 0.f;
+        else if (strcmp(key, "packing_layout") == 0) p.packing_layout = value != 0.f;
+        else if (strcmp(key, "winograd") == 0) p.winograd = value != 0.f;
+        else if (strcmp(key, "sgemm") == 0) p.sgemm = value != 0.f;
+        else if (strcmp(key, "openmp_blocktime") == 0) p.openmp_blocktime = (int)value;
+        else if (strcmp(key, "latency_ms") == 0) p.latency_ms = value;
+        else n--;
+    }
+    fclose(fp);
+    if (n == 0) return -1;
+    *this = p;
+    return 0;
+}
+
+int InferenceProfile::save(const char* path) const {
+    const std::string tmp = std::string(path) + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return -1;
+    fprintf(fp, "num_threads=%d\n", num_threads);
+    fprintf(fp, "fp16=%d\n", fp16 ? 1 : 0);
+    fprintf(fp, "packing_layout=%d\n", packing_layout ? 1 : 0);
+    fprintf(fp, "winograd=%d\n", winograd ? 1 : 0);
+    fprintf(fp, "sgemm=%d\n", sgemm ? 1 : 0);
+    fprintf(fp, "openmp_blocktime=%d\n", openmp_blocktime);
+    fprintf(fp, "latency_ms=%.2f\n", latency_ms);
+    if (fclose(fp) != 0) return -1;
+    return rename(tmp.c_str(), path) == 0 ? 0 : -1;
+}
+
+// 固定的合成输入：渐变叠加 32 像素棋盘格，各尺度卷积都有响应；每次相同，结果可比
+static void make_input(int size, ncnn::Mat& in) {
+    in.create(size, size, 3);
+    for (int q = 0; q < 3; q++) {
+        float* p = in.channel(q);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const int v = (x * (q + 1) + y * (3 - q)) % 192 + (((x >> 5) ^ (y >> 5)) & 1) * 63;
+                p[y * size + x] = v / 255.f;
+            }
+        }
+    }
+}
+
+// 按 profile 加载并推理，out 为 out0 的拷贝，latency_ms 为计时的中位数；失败返回 -1
+static int run_profile(const char* param_text, const unsigned char* weights, const InferenceProfile& profile,
+                       const TuneParams& params, const ncnn::Mat& in, ncnn::Mat& out, float& latency_ms) {
+    ncnn::Net net;
+    net.opt.use_vulkan_compute = false;
+    profile.apply(net.opt);
+    const unsigned char* mem = weights;
+    ncnn::DataReaderFromMemory dr(mem);
+    if (net.load_param_mem(param_text) != 0 || net.load_model(dr) != 0) return -1;
+
+    std::vector<double> times;
+    for (int i = 0; i < params.warmup + params.runs; i++) {
+        const double start = ncnn::get_current_time();
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("in0", in);
+        ncnn::Mat result;
+        if (ex.extract("out0", result) != 0) return -1;
+        if (i >= params.warmup) times.push_back(ncnn::get_current_time() - start);
+        // 输出可能在网络自带的池中，网络析构前拷出
+        if (i == params.warmup + params.runs - 1) out = result.clone();
+    }
+    if (times.empty()) return -1;
+    std::sort(times.begin(), times.end());
+    latency_ms = times[times.size() / 2];
+    return 0;
+}
+
+// fp32 参考的输出及其检测框
+struct Reference {
+    ncnn::Mat out;
+    std::vector<Object> objects;
+};
+
+// 解码 + NMS，坐标为网络输入坐标
+static void decode_detections(const ncnn::Mat& out, float prob_threshold, std::vector<Object>& objects) {
+    const LetterboxTransform tf = {1.f, 0.f, 0.f};
+    std::vector<Object> proposals;
+    DecodeScratch scratch;
+    decode_yolov8_output(out, prob_threshold, std::vector<int>(), 0, tf, proposals, scratch);
+    NmsWorkspace ws;
+    suppress_bboxes(proposals, objects, NmsParams(), ws);
+}
+
+static float box_iou(const Object& a, const Object& b) {
+    const float w = std::min(a.rect.x + a.rect.width, b.rect.x + b.rect.width) - std::max(a.rect.x, b.rect.x);
+    const float h = std::min(a.rect.y + a.rect.height, b.rect.y + b.rect.height) - std::max(a.rect.y, b.rect.y);
+    if (w <= 0.f || h <= 0.f) return 0.f;
+    const float inter = w * h;
+    return inter / (a.rect.width * a.rect.height + b.rect.width * b.rect.height - inter);
+}
+
+// a 中分数不低于 prob_threshold + score_tolerance 的框逐个在 b 中找同类、IoU 最大的未用框，
+// IoU 与分数差在容差内即匹配；b 按 prob_threshold 解码，分数在阈值两侧小幅摆动不计为不一致
+// 返回未匹配数，count 加上参与匹配的框数
+static int count_unmatched(const std::vector<Object>& a, const std::vector<Object>& b, const TuneParams& params,
+                           int& count) {
+    std::vector<bool> used(b.size(), false);
+    int unmatched = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].prob < params.prob_threshold + params.score_tolerance) continue;
+        count++;
+        int best = -1;
+        float best_iou = params.min_iou;
+        for (size_t j = 0; j < b.size(); j++) {
+            if (used[j] || b[j].label != a[i].label || fabsf(b[j].prob - a[i].prob) > params.score_tolerance) continue;
+            const float iou = box_iou(a[i], b[j]);
+            if (iou >= best_iou) {
+                best = j;
+                best_iou = iou;
+            }
+        }
+        if (best >= 0) used[best] = true;
+        else unmatched++;
+    }
+    return unmatched;
+}
+
+// 与 fp32 参考的偏差：双方的检测框互相匹配，返回未匹配的框占双方框总数的比例
+// 参考输出一个框都没有时无从比较，退回类别分数逐元素绝对误差的 99 分位，超过 score_tolerance 视为不一致
+static float output_error(const ncnn::Mat& out, const Reference& ref, const TuneParams& params) {
+    if (out.w != ref.out.w || out.h != ref.out.h) return INFINITY;
+    std::vector<Object> objects;
+    decode_detections(out, params.prob_threshold, objects);
+
+    int count = 0;
+    const int unmatched = count_unmatched(ref.objects, objects, params, count)
+                          + count_unmatched(objects, ref.objects, params, count);
+    if (count > 0) return (float)unmatched / count;
+
+    std::vector<float> diffs;
+    diffs.reserve((size_t)(ref.out.h - 4) * ref.out.w);
+    for (int i = 4; i < ref.out.h; i++) {
+        const float* a = out.row(i);
+        const float* b = ref.out.row(i);
+        for (int j = 0; j < ref.out.w; j++) diffs.push_back(fabsf(a[j] - b[j]));
+    }
+    if (diffs.empty()) return 0.f;
+    std::vector<float>::iterator p99 = diffs.begin() + diffs.size() * 99 / 100;
+    std::nth_element(diffs.begin(), p99, diffs.end());
+    return *p99 <= params.score_tolerance ? 0.f : INFINITY;
+}
+
+// 测量 candidate，偏差在容差内且比 best 快 3% 以上时取代 best；更小的差距视为测量噪声
+static void try_profile(const char* param_text, const unsigned char* weights, const TuneParams& params,
+                        const ncnn::Mat& in, const Reference& ref, InferenceProfile candidate, InferenceProfile& best) {
+    if (candidate.same_options(best)) return;
+    ncnn::Mat out;
+    if (run_profile(param_text, weights, candidate, params, in, out, candidate.latency_ms) != 0) {
+        LOGE("threads %d fp16 %d packing %d winograd %d sgemm %d blocktime %d: failed", candidate.num_threads,
+             candidate.fp16, candidate.packing_layout, candidate.winograd, candidate.sgemm, candidate.openmp_blocktime);
+        return;
+    }
+    const float err = output_error(out, ref, params);
+    LOGD("threads %d fp16 %d packing %d winograd %d sgemm %d blocktime %d: %.2f ms, error %.4f", candidate.num_threads,
+         candidate.fp16, candidate.packing_layout, candidate.winograd, candidate.sgemm, candidate.openmp_blocktime,
+         candidate.latency_ms, err);
+    if (err <= params.tolerance && candidate.latency_ms < best.latency_ms * 0.97f) best = candidate;
+}
+
+int autotune_profile(const char* param_text, const unsigned char* weights, const TuneParams& params,
+                     InferenceProfile& best) {
+    ncnn::Mat in;
+    make_input(params.input_size, in);
+    const int cpus = ncnn::get_cpu_count();
+
+    // fp32 参考：关闭 fp16 与 winograd / sgemm 快速卷积
+    InferenceProfile reference;
+    reference.num_threads = ncnn::get_physical_big_cpu_count();
+    reference.fp16 = false;
+    reference.winograd = false;
+    reference.sgemm = false;
+    Reference ref;
+    if (run_profile(param_text, weights, reference, params, in, ref.out, reference.latency_ms) != 0) {
+        LOGE("reference inference failed");
+        return -1;
+    }
+    decode_detections(ref.out, params.prob_threshold, ref.objects);
+    LOGD("reference: %.2f ms, %d detections", reference.latency_ms, (int)ref.objects.size());
+
+    // 从原先的固定配置出发，它超出容差时从参考配置出发
+    best = InferenceProfile();
+    best.num_threads = reference.num_threads;
+    ncnn::Mat out;
+    if (run_profile(param_text, weights, best, params, in, out, best.latency_ms) != 0
+        || output_error(out, ref, params) > params.tolerance) {
+        best = reference;
+    }
+
+    const int threads[] = {1, 2, 4, ncnn::get_big_cpu_count(), cpus};
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        if (threads[i] < 1 || threads[i] > cpus) continue;
+        InferenceProfile c = best;
+        c.num_threads = threads[i];
+        try_profile(param_text, weights, params, in, ref, c, best);
+    }
+
+    InferenceProfile c = best;
+    c.fp16 = !best.fp16;
+    try_profile(param_text, weights, params, in, ref, c, best);
+    c = best;
+    c.packing_layout = !best.packing_layout;
+    try_profile(param_text, weights, params, in, ref, c, best);
+    c = best;
+    c.winograd = !best.winograd;
+    try_profile(param_text, weights, params, in, ref, c, best);
+    c = best;
+    c.sgemm = !best.sgemm;
+    try_profile(param_text, weights, params, in, ref, c, best);
+    c = best;
+    c.openmp_blocktime = best.openmp_blocktime > 0 ? 0 : 20;
+    try_profile(param_text, weights, params, in, ref, c, best);
+
+    LOGD("autotune: threads %d fp16 %d packing %d winograd %d sgemm %d blocktime %d, %.2f ms (fp32 %.2f ms)",
+         best.num_threads, best.fp16, best.packing_layout, best.winograd, best.sgemm, best.openmp_blocktime,
+         best.latency_ms, reference.latency_ms);
+    return 0;
+}
+
+#ifdef YOLOV8_TUNE_MAIN
+// 在 Linux 主机上生成档案：
+//   g++ -O2 -fopenmp -DYOLOV8_TUNE_MAIN yolov8_tune.cpp yolov8_decode.cpp nms.cpp -I<ncnn>/include -L<ncnn>/lib -lncnn -o yolov8_tune
+//   ./yolov8_tune model.ncnn.param model.ncnn.bin profile.txt
+static int read_file(const char* path, std::vector<unsigned char>& data) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data.resize(len > 0 ? len + 1 : 1);
+    size_t n = len > 0 ? fread(&data[0], 1, len, fp) : 0;
+    fclose(fp);
+    data[data.size() - 1] = 0;
+    return len >= 0 && n == (size_t)len ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s model.ncnn.param model.ncnn.bin profile.txt\n", argv[0]);
+        return 1;
+    }
+    std::vector<unsigned char> param, weights;
+    if (read_file(argv[1], param) != 0 || read_file(argv[2], weights) != 0) {
+        fprintf(stderr, "read model failed\n");
+        return 1;
+    }
+    InferenceProfile best;
+    if (autotune_profile((const char*)&param[0], &weights[0], TuneParams(), best) != 0) return 1;
+    return best.save(argv[3]) == 0 ? 0 : 1;
+}
+#endif // YOLOV8_TUNE_MAIN
@@ -0,0 +1,51 @@
+#ifndef YOLOV8_TUNE_H
+#define YOLOV8_TUNE_H
+
+#include <ncnn/option.h>
+
+// 推理选项档案：autotune 在本机实测选出后存为小文本文件，之后的加载直接套用
+// 默认值即调优前的固定配置
+struct InferenceProfile {
+    int num_threads;       // <= 0 时用 ncnn 默认（物理大核数）
+    bool fp16;             // fp16 packed / storage / arithmetic
+    bool packing_layout;
+    bool winograd;
+    bool sgemm;
+    int openmp_blocktime;  // 毫秒
+    float latency_ms;      // 调优时测得的单帧耗时，只作记录
+
+    InferenceProfile();
+
+    void apply(ncnn::Option& opt) const;
+    // 比较除 latency_ms 外的各项
+    bool same_options(const InferenceProfile& other) const;
+
+    // 每行一项 key=value，缺少的项保持默认；文件不存在或无法解析返回 -1
+    int load(const char* path);
+    // 先写临时文件再改名，中途退出不会留下半个档案
+    int save(const char* path) const;
+};
+
+// 与 fp32 参考是否一致按解码 + NMS 后的检测框判断，不看原始输出的逐元素偏差：
+// fp16 下个别低分 anchor 的偏差可以很大而检测结果不变
+struct TuneParams {
+    int warmup;             // 每个组合计时前的预热次数
+    int runs;               // 计时次数，取中位数
+    float prob_threshold;   // 解码阈值；合成输入上的分数普遍不高，取低值以得到足够多的框
+    float score_tolerance;  // 匹配框的分数差上限，阈值附近的框也按此放宽
+    float min_iou;          // 匹配框的最小 IoU
+    float tolerance;        // 允许未匹配的框占双方框总数的比例
+    int input_size;
+
+    TuneParams()
+        : warmup(2), runs(5), prob_threshold(0.1f), score_tolerance(0.05f), min_iou(0.8f), tolerance(0.05f),
+          input_size(640) {}
+};
+
+// 在本机逐项尝试线程数、fp16、packing、winograd / sgemm 与 blocktime，其余项固定为当前最优，
+// 保留偏差在容差内且明显更快的取值；param_text 为文本 param，weights 为 4 字节对齐的权重内存
+// 只依赖 ncnn，可在 Linux 主机上运行（见文件末尾的 YOLOV8_TUNE_MAIN）
+int autotune_profile(const char* param_text, const unsigned char* weights, const TuneParams& params,
+                     InferenceProfile& best);
+
+#endif // YOLOV8_TUNE_H
@@ -0,0 +1,459 @@
+// 由 param_to_bin.py 生成，与同次生成的 .param.bin 配套，请勿手工修改
+#ifndef YOLOV8N_PARAM_ID_H
+#define YOLOV8N_PARAM_ID_H
+
+namespace yolov8n_param_id {
+const int layer_count = 204;
+const int blob_count = 245;
+const unsigned int param_hash = 0x0c5a738d;  // 源 .param 文件的 FNV-1a 散列
+const int CUSTOM_LAYER_Yolov8DetectionOutput = 0;
+const int LAYER_in0 = 0;
+const int LAYER_conv_0 = 1;
+const int LAYER_silu_67 = 2;
+const int LAYER_conv_1 = 3;
+const int LAYER_silu_68 = 4;
+const int LAYER_conv_2 = 5;
+const int LAYER_silu_69 = 6;
+const int LAYER_split_0 = 7;
+const int LAYER_conv_3 = 9;
+const int LAYER_silu_70 = 10;
+const int LAYER_conv_4 = 11;
+const int LAYER_silu_71 = 12;
+const int LAYER_add_0 = 13;
+const int LAYER_cat_0 = 14;
+const int LAYER_conv_5 = 15;
+const int LAYER_silu_72 = 16;
+const int LAYER_conv_6 = 17;
+const int LAYER_silu_73 = 18;
+const int LAYER_conv_7 = 19;
+const int LAYER_silu_74 = 20;
+const int LAYER_split_1 = 21;
+const int LAYER_splitncnn_1 = 22;
+const int LAYER_conv_8 = 23;
+const int LAYER_silu_75 = 24;
+const int LAYER_conv_9 = 25;
+const int LAYER_silu_76 = 26;
+const int LAYER_add_1 = 27;
+const int LAYER_splitncnn_2 = 28;
+const int LAYER_conv_10 = 29;
+const int LAYER_silu_77 = 30;
+const int LAYER_conv_11 = 31;
+const int LAYER_silu_78 = 32;
+const int LAYER_add_2 = 33;
+const int LAYER_cat_1 = 34;
+const int LAYER_conv_12 = 35;
+const int LAYER_silu_79 = 36;
+const int LAYER_splitncnn_3 = 37;
+const int LAYER_conv_13 = 38;
+const int LAYER_silu_80 = 39;
+const int LAYER_conv_14 = 40;
+const int LAYER_silu_81 = 41;
+const int LAYER_split_2 = 42;
+const int LAYER_splitncnn_4 = 43;
+const int LAYER_conv_15 = 44;
+const int LAYER_silu_82 = 45;
+const int LAYER_conv_16 = 46;
+const int LAYER_silu_83 = 47;
+const int LAYER_add_3 = 48;
+const int LAYER_splitncnn_5 = 49;
+const int LAYER_conv_17 = 50;
+const int LAYER_silu_84 = 51;
+const int LAYER_conv_18 = 52;
+const int LAYER_silu_85 = 53;
+const int LAYER_add_4 = 54;
+const int LAYER_cat_2 = 55;
+const int LAYER_conv_19 = 56;
+const int LAYER_silu_86 = 57;
+const int LAYER_splitncnn_6 = 58;
+const int LAYER_conv_20 = 59;
+const int LAYER_silu_87 = 60;
+const int LAYER_conv_21 = 61;
+const int LAYER_silu_88 = 62;
+const int LAYER_split_3 = 63;
+const int LAYER_splitncnn_7 = 64;
+const int LAYER_conv_22 = 65;
+const int LAYER_silu_89 = 66;
+const int LAYER_conv_23 = 67;
+const int LAYER_silu_90 = 68;
+const int LAYER_add_5 = 69;
+const int LAYER_cat_3 = 70;
+const int LAYER_conv_24 = 71;
+const int LAYER_silu_91 = 72;
+const int LAYER_conv_25 = 73;
+const int LAYER_silu_92 = 74;
+const int LAYER_splitncnn_8 = 75;
+const int LAYER_maxpool2d_64 = 76;
+const int LAYER_splitncnn_9 = 77;
+const int LAYER_maxpool2d_65 = 78;
+const int LAYER_splitncnn_10 = 79;
+const int LAYER_maxpool2d_66 = 80;
+const int LAYER_cat_4 = 81;
+const int LAYER_conv_26 = 82;
+const int LAYER_silu_93 = 83;
+const int LAYER_splitncnn_11 = 84;
+const int LAYER_upsample_124 = 85;
+const int LAYER_cat_5 = 86;
+const int LAYER_conv_27 = 87;
+const int LAYER_silu_94 = 88;
+const int LAYER_split_4 = 89;
+const int LAYER_splitncnn_12 = 90;
+const int LAYER_conv_28 = 91;
+const int LAYER_silu_95 = 92;
+const int LAYER_conv_29 = 93;
+const int LAYER_silu_96 = 94;
+const int LAYER_cat_6 = 95;
+const int LAYER_conv_30 = 96;
+const int LAYER_silu_97 = 97;
+const int LAYER_splitncnn_13 = 98;
+const int LAYER_upsample_125 = 99;
+const int LAYER_cat_7 = 100;
+const int LAYER_conv_31 = 101;
+const int LAYER_silu_98 = 102;
+const int LAYER_split_5 = 103;
+const int LAYER_splitncnn_14 = 104;
+const int LAYER_conv_32 = 105;
+const int LAYER_silu_99 = 106;
+const int LAYER_conv_33 = 107;
+const int LAYER_silu_100 = 108;
+const int LAYER_cat_8 = 109;
+const int LAYER_conv_34 = 110;
+const int LAYER_silu_101 = 111;
+const int LAYER_splitncnn_15 = 112;
+const int LAYER_conv_35 = 113;
+const int LAYER_silu_102 = 114;
+const int LAYER_cat_9 = 115;
+const int LAYER_conv_36 = 116;
+const int LAYER_silu_103 = 117;
+const int LAYER_split_6 = 118;
+const int LAYER_splitncnn_16 = 119;
+const int LAYER_conv_37 = 120;
+const int LAYER_silu_104 = 121;
+const int LAYER_conv_38 = 122;
+const int LAYER_silu_105 = 123;
+const int LAYER_cat_10 = 124;
+const int LAYER_conv_39 = 125;
+const int LAYER_silu_106 = 126;
+const int LAYER_splitncnn_17 = 127;
+const int LAYER_conv_40 = 128;
+const int LAYER_silu_107 = 129;
+const int LAYER_cat_11 = 130;
+const int LAYER_conv_41 = 131;
+const int LAYER_silu_108 = 132;
+const int LAYER_split_7 = 133;
+const int LAYER_splitncnn_18 = 134;
+const int LAYER_conv_42 = 135;
+const int LAYER_silu_109 = 136;
+const int LAYER_conv_43 = 137;
+const int LAYER_silu_110 = 138;
+const int LAYER_cat_12 = 139;
+const int LAYER_conv_44 = 140;
+const int LAYER_silu_111 = 141;
+const int LAYER_splitncnn_19 = 142;
+const int LAYER_pnnx_99 = 143;
+const int LAYER_conv_45 = 144;
+const int LAYER_silu_112 = 145;
+const int LAYER_conv_46 = 146;
+const int LAYER_silu_113 = 147;
+const int LAYER_conv_47 = 148;
+const int LAYER_conv_48 = 149;
+const int LAYER_silu_114 = 150;
+const int LAYER_conv_49 = 151;
+const int LAYER_silu_115 = 152;
+const int LAYER_conv_50 = 153;
+const int LAYER_cat_13 = 154;
+const int LAYER_conv_51 = 155;
+const int LAYER_silu_116 = 156;
+const int LAYER_conv_52 = 157;
+const int LAYER_silu_117 = 158;
+const int LAYER_conv_53 = 159;
+const int LAYER_conv_54 = 160;
+const int LAYER_silu_118 = 161;
+const int LAYER_conv_55 = 162;
+const int LAYER_silu_119 = 163;
+const int LAYER_conv_56 = 164;
+const int LAYER_cat_14 = 165;
+const int LAYER_conv_57 = 166;
+const int LAYER_silu_120 = 167;
+const int LAYER_conv_58 = 168;
+const int LAYER_silu_121 = 169;
+const int LAYER_conv_59 = 170;
+const int LAYER_conv_60 = 171;
+const int LAYER_silu_122 = 172;
+const int LAYER_conv_61 = 173;
+const int LAYER_silu_123 = 174;
+const int LAYER_conv_62 = 175;
+const int LAYER_cat_15 = 176;
+const int LAYER_reshape_128 = 177;
+const int LAYER_reshape_129 = 178;
+const int LAYER_reshape_130 = 179;
+const int LAYER_cat_16 = 180;
+const int LAYER_split_8 = 181;
+const int LAYER_reshape_131 = 182;
+const int LAYER_transpose_134 = 183;
+const int LAYER_softmax_127 = 184;
+const int LAYER_conv_63 = 185;
+const int LAYER_reshape_132 = 186;
+const int LAYER_pnnx_fold_anchor_points_1 = 187;
+const int LAYER_chunk_0 = 189;
+const int LAYER_sub_6 = 190;
+const int LAYER_splitncnn_20 = 191;
+const int LAYER_add_7 = 192;
+const int LAYER_splitncnn_21 = 193;
+const int LAYER_add_8 = 194;
+const int LAYER_div_9 = 195;
+const int LAYER_sub_10 = 196;
+const int LAYER_cat_17 = 197;
+const int LAYER_reshape_133 = 198;
+const int LAYER_mul_11 = 199;
+const int LAYER_sigmoid_126 = 200;
+const int LAYER_cat_18 = 201;
+const int LAYER_det_param = 202;
+const int LAYER_Yolov8DetectionOutput = 203;
+const int BLOB_in0 = 0;
+const int BLOB_1 = 1;
+const int BLOB_2 = 2;
+const int BLOB_3 = 3;
+const int BLOB_4 = 4;
+const int BLOB_5 = 5;
+const int BLOB_6 = 6;
+const int BLOB_7 = 7;
+const int BLOB_8 = 8;
+const int BLOB_9 = 9;
+const int BLOB_10 = 10;
+const int BLOB_11 = 11;
+const int BLOB_12 = 12;
+const int BLOB_13 = 13;
+const int BLOB_14 = 14;
+const int BLOB_15 = 15;
+const int BLOB_16 = 16;
+const int BLOB_17 = 17;
+const int BLOB_18 = 18;
+const int BLOB_19 = 19;
+const int BLOB_20 = 20;
+const int BLOB_21 = 21;
+const int BLOB_22 = 22;
+const int BLOB_23 = 23;
+const int BLOB_24 = 24;
+const int BLOB_25 = 25;
+const int BLOB_26 = 26;
+const int BLOB_27 = 27;
+const int BLOB_28 = 28;
+const int BLOB_29 = 29;
+const int BLOB_30 = 30;
+const int BLOB_31 = 31;
+const int BLOB_32 = 32;
+const int BLOB_33 = 33;
+const int BLOB_34 = 34;
+const int BLOB_35 = 35;
+const int BLOB_36 = 36;
+const int BLOB_37 = 37;
+const int BLOB_38 = 38;
+const int BLOB_39 = 39;
+const int BLOB_40 = 40;
+const int BLOB_41 = 41;
+const int BLOB_42 = 42;
+const int BLOB_43 = 43;
+const int BLOB_44 = 44;
+const int BLOB_45 = 45;
+const int BLOB_46 = 46;
+const int BLOB_47 = 47;
+const int BLOB_48 = 48;
+const int BLOB_49 = 49;
+const int BLOB_50 = 50;
+const int BLOB_51 = 51;
+const int BLOB_52 = 52;
+const int BLOB_53 = 53;
+const int BLOB_54 = 54;
+const int BLOB_55 = 55;
+const int BLOB_56 = 56;
+const int BLOB_57 = 57;
+const int BLOB_58 = 58;
+const int BLOB_59 = 59;
+const int BLOB_60 = 60;
+const int BLOB_61 = 61;
+const int BLOB_62 = 62;
+const int BLOB_63 = 63;
+const int BLOB_64 = 64;
+const int BLOB_65 = 65;
+const int BLOB_66 = 66;
+const int BLOB_67 = 67;
+const int BLOB_68 = 68;
+const int BLOB_69 = 69;
+const int BLOB_70 = 70;
+const int BLOB_71 = 71;
+const int BLOB_72 = 72;
+const int BLOB_73 = 73;
+const int BLOB_74 = 74;
+const int BLOB_75 = 75;
+const int BLOB_76 = 76;
+const int BLOB_77 = 77;
+const int BLOB_78 = 78;
+const int BLOB_79 = 79;
+const int BLOB_80 = 80;
+const int BLOB_81 = 81;
+const int BLOB_82 = 82;
+const int BLOB_83 = 83;
+const int BLOB_84 = 84;
+const int BLOB_85 = 85;
+const int BLOB_86 = 86;
+const int BLOB_87 = 87;
+const int BLOB_88 = 88;
+const int BLOB_89 = 89;
+const int BLOB_90 = 90;
+const int BLOB_91 = 91;
+const int BLOB_92 = 92;
+const int BLOB_93 = 93;
+const int BLOB_94 = 94;
+const int BLOB_95 = 95;
+const int BLOB_96 = 96;
+const int BLOB_97 = 97;
+const int BLOB_98 = 98;
+const int BLOB_99 = 99;
+const int BLOB_100 = 100;
+const int BLOB_101 = 101;
+const int BLOB_102 = 102;
+const int BLOB_103 = 103;
+const int BLOB_104 = 104;
+const int BLOB_105 = 105;
+const int BLOB_106 = 106;
+const int BLOB_107 = 107;
+const int BLOB_108 = 108;
+const int BLOB_109 = 109;
+const int BLOB_110 = 110;
+const int BLOB_111 = 111;
+const int BLOB_112 = 112;
+const int BLOB_113 = 113;
+const int BLOB_114 = 114;
+const int BLOB_115 = 115;
+const int BLOB_116 = 116;
+const int BLOB_117 = 117;
+const int BLOB_118 = 118;
+const int BLOB_119 = 119;
+const int BLOB_120 = 120;
+const int BLOB_121 = 121;
+const int BLOB_122 = 122;
+const int BLOB_123 = 123;
+const int BLOB_124 = 124;
+const int BLOB_125 = 125;
+const int BLOB_126 = 126;
+const int BLOB_127 = 127;
+const int BLOB_128 = 128;
+const int BLOB_129 = 129;
+const int BLOB_130 = 130;
+const int BLOB_131 = 131;
+const int BLOB_132 = 132;
+const int BLOB_133 = 133;
+const int BLOB_134 = 134;
+const int BLOB_135 = 135;
+const int BLOB_136 = 136;
+const int BLOB_137 = 137;
+const int BLOB_138 = 138;
+const int BLOB_139 = 139;
+const int BLOB_140 = 140;
+const int BLOB_141 = 141;
+const int BLOB_142 = 142;
+const int BLOB_143 = 143;
+const int BLOB_144 = 144;
+const int BLOB_145 = 145;
+const int BLOB_146 = 146;
+const int BLOB_147 = 147;
+const int BLOB_148 = 148;
+const int BLOB_149 = 149;
+const int BLOB_150 = 150;
+const int BLOB_151 = 151;
+const int BLOB_152 = 152;
+const int BLOB_153 = 153;
+const int BLOB_154 = 154;
+const int BLOB_155 = 155;
+const int BLOB_156 = 156;
+const int BLOB_157 = 157;
+const int BLOB_158 = 158;
+const int BLOB_159 = 159;
+const int BLOB_160 = 160;
+const int BLOB_161 = 161;
+const int BLOB_162 = 162;
+const int BLOB_163 = 163;
+const int BLOB_164 = 164;
+const int BLOB_165 = 165;
+const int BLOB_166 = 166;
+const int BLOB_167 = 167;
+const int BLOB_168 = 168;
+const int BLOB_169 = 169;
+const int BLOB_170 = 170;
+const int BLOB_171 = 171;
+const int BLOB_172 = 172;
+const int BLOB_173 = 173;
+const int BLOB_174 = 174;
+const int BLOB_175 = 175;
+const int BLOB_176 = 176;
+const int BLOB_177 = 177;
+const int BLOB_178 = 178;
+const int BLOB_179 = 179;
+const int BLOB_180 = 180;
+const int BLOB_181 = 181;
+const int BLOB_182 = 182;
+const int BLOB_183 = 183;
+const int BLOB_184 = 184;
+const int BLOB_185 = 185;
+const int BLOB_186 = 186;
+const int BLOB_187 = 187;
+const int BLOB_188 = 188;
+const int BLOB_189 = 189;
+const int BLOB_190 = 190;
+const int BLOB_191 = 191;
+const int BLOB_192 = 192;
+const int BLOB_193 = 193;
+const int BLOB_194 = 194;
+const int BLOB_195 = 195;
+const int BLOB_196 = 196;
+const int BLOB_197 = 197;
+const int BLOB_198 = 198;
+const int BLOB_199 = 199;
+const int BLOB_200 = 200;
+const int BLOB_201 = 201;
+const int BLOB_202 = 202;
+const int BLOB_203 = 203;
+const int BLOB_204 = 204;
+const int BLOB_205 = 205;
+const int BLOB_206 = 206;
+const int BLOB_207 = 207;
+const int BLOB_208 = 208;
+const int BLOB_209 = 209;
+const int BLOB_210 = 210;
+const int BLOB_211 = 211;
+const int BLOB_212 = 212;
+const int BLOB_213 = 213;
+const int BLOB_214 = 214;
+const int BLOB_215 = 215;
+const int BLOB_216 = 216;
+const int BLOB_217 = 217;
+const int BLOB_218 = 218;
+const int BLOB_219 = 219;
+const int BLOB_220 = 220;
+const int BLOB_221 = 221;
+const int BLOB_222 = 222;
+const int BLOB_223 = 223;
+const int BLOB_224 = 224;
+const int BLOB_225 = 225;
+const int BLOB_226 = 226;
+const int BLOB_227 = 227;
+const int BLOB_228 = 228;
+const int BLOB_229 = 229;
+const int BLOB_230 = 230;
+const int BLOB_231 = 231;
+const int BLOB_232 = 232;
+const int BLOB_233 = 233;
+const int BLOB_234 = 234;
+const int BLOB_235 = 235;
+const int BLOB_236 = 236;
+const int BLOB_237 = 237;
+const int BLOB_238 = 238;
+const int BLOB_239 = 239;
+const int BLOB_240 = 240;
+const int BLOB_241 = 241;
+const int BLOB_out0 = 242;
+const int BLOB_det_param = 243;
+const int BLOB_detections = 244;
+} // namespace yolov8n_param_id
+
+#endif // YOLOV8N_PARAM_ID_H
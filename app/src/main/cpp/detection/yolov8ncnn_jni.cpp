@@ -1,4 +1,5 @@
 #include <jni.h>
+#include <pthread.h>
 #include <string>
 #include <vector>
 #include <android/bitmap.h>
@@ -6,12 +7,13 @@
 #include <android/log.h>
 
 #include <ncnn/net.h>
-#include <ncnn/gpu.h>
 #include <ncnn/cpu.h>
 #include <ncnn/mat.h>
 #include <ncnn/platform.h>
 
 #include "yolov8.h"
+#include "yolov8_pool.h"
+#include "detect_pipeline.h"
 
 using Object = ::Object;
 
@@ -19,80 +21,477 @@ using Object = ::Object;
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
 
-static Yolov8* g_yolov8 = 0;
+// 推理只在池中取还实例，互斥锁只串行化加载与配置
+static Yolov8Pool g_pool;
 static ncnn::Mutex lock;
+static int g_num_workers = Yolov8Pool::default_workers;
 
-extern "C" {
+// 相机异步流水线，指针由 pipeline_lock 保护，与加载用的 lock 分开，加载期间提交帧不被阻塞
+static DetectPipeline* g_pipeline = 0;
+static ncnn::Mutex pipeline_lock;
+static float g_latency_budget = 0.f;  // 新建的流水线沿用
+static JavaVM* g_vm = 0;               // JNI_OnLoad 中设置
 
-JNIEXPORT jint JNI_ONLOAD(JavaVM* vm, void* reserved) {
-    ncnn::create_gpu_instance();
-    return JNI_VERSION_1_4;
+// Java 端 Yolov8 实例所属的调用方，决定并发名额
+static int get_caller(JNIEnv* env, jobject thiz) {
+    jclass clazz = env->GetObjectClass(thiz);
+    jfieldID callerField = env->GetFieldID(clazz, "caller", "I");
+    return env->GetIntField(thiz, callerField);
+}
+
+// classIds 为 null 时检测全部类别
+static void get_class_ids(JNIEnv* env, jintArray classIds, std::vector<int>& class_ids) {
+    class_ids.clear();
+    if (classIds) {
+        jsize n = env->GetArrayLength(classIds);
+        class_ids.resize(n);
+        if (n > 0) env->GetIntArrayRegion(classIds, 0, n, class_ids.data());
+    }
+}
+
+// 检测结果转换为 Yolov8.DetectionResult[]；resultClass 由调用方给出，native 线程上 FindClass 找不到应用类
+static jobjectArray to_detection_results(JNIEnv* env, jclass resultClass, const std::vector<Object>& objects) {
+    jmethodID resultConstructor = env->GetMethodID(resultClass, "<init>", "()V");
+    jfieldID classIdField = env->GetFieldID(resultClass, "classId", "I");
+    jfieldID classNameField = env->GetFieldID(resultClass, "className", "Ljava/lang/String;");
+    jfieldID confidenceField = env->GetFieldID(resultClass, "confidence", "F");
+    jfieldID xField = env->GetFieldID(resultClass, "x", "F");
+    jfieldID yField = env->GetFieldID(resultClass, "y", "F");
+    jfieldID widthField = env->GetFieldID(resultClass, "width", "F");
+    jfieldID heightField = env->GetFieldID(resultClass, "height", "F");
+
+    jobjectArray resultArray = env->NewObjectArray(objects.size(), resultClass, nullptr);
+    for (size_t i = 0; i < objects.size(); i++) {
+        jobject result = env->NewObject(resultClass, resultConstructor);
+        env->SetIntField(result, classIdField, objects[i].label);
+        env->SetObjectField(result, classNameField, env->NewStringUTF(Yolov8::get_class_name(objects[i].label).c_str()));
+        env->SetFloatField(result, confidenceField, objects[i].prob);
+        env->SetFloatField(result, xField, objects[i].rect.x);
+        env->SetFloatField(result, yField, objects[i].rect.y);
+        env->SetFloatField(result, widthField, objects[i].rect.width);
+        env->SetFloatField(result, heightField, objects[i].rect.height);
+        env->SetObjectArrayElement(resultArray, i, result);
+    }
+    return resultArray;
+}
+
+static jobjectArray to_detection_results(JNIEnv* env, const std::vector<Object>& objects) {
+    return to_detection_results(env, env->FindClass("com/tencent/ncnn/Yolov8$DetectionResult"), objects);
 }
 
-JNIEXPORT void JNI_ONUNLOAD(JavaVM* vm, void* reserved) {
-    ncnn::destroy_gpu_instance();
+// 流水线线程首次回调时挂到 JVM，线程退出时自动分离
+static pthread_key_t g_env_key;
+static pthread_once_t g_env_key_once = PTHREAD_ONCE_INIT;
+
+static void detach_current_thread(void*) {
+    g_vm->DetachCurrentThread();
+}
+
+static void create_env_key() {
+    pthread_key_create(&g_env_key, detach_current_thread);
+}
+
+static JNIEnv* attach_current_thread() {
+    JNIEnv* env = 0;
+    if (g_vm->GetEnv((void**)&env, JNI_VERSION_1_4) == JNI_OK) return env;
+    if (g_vm->AttachCurrentThread(&env, 0) != JNI_OK) return 0;
+    pthread_once(&g_env_key_once, create_env_key);
+    pthread_setspecific(g_env_key, env);
+    return env;
+}
+
+// Java 端 Yolov8.DetectionCallback 及其所需的全局引用
+struct JavaPipelineCallback {
+    jobject callback;
+    jmethodID on_detections;
+    jclass result_class;
+};
+
+// 与 g_pipeline 一一对应，同由 pipeline_lock 保护；每条流水线持有自己的一份，旧流水线退出前不被新的覆盖
+static JavaPipelineCallback* g_pipeline_callback = 0;
+
+static void on_pipeline_result(void* userdata, long long frame_id, const std::vector<Object>& objects,
+                               int frame_w, int frame_h) {
+    const JavaPipelineCallback* cb = (const JavaPipelineCallback*)userdata;
+    JNIEnv* env = attach_current_thread();
+    if (!env) return;
+
+    // 推理线程没有 Java 栈帧，局部引用须在每帧结束时手动释放
+    if (env->PushLocalFrame(objects.size() * 2 + 16) != 0) return;
+    jobjectArray results = to_detection_results(env, cb->result_class, objects);
+    env->CallVoidMethod(cb->callback, cb->on_detections, (jlong)frame_id, results, frame_w, frame_h);
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    env->PopLocalFrame(0);
+}
+
+// 等待流水线线程退出后释放回调；调用时不得持有 pipeline_lock，回调中可能调用 submitYuv 等需要该锁的接口
+static void destroy_pipeline(JNIEnv* env, DetectPipeline* pipeline, JavaPipelineCallback* cb) {
+    if (!pipeline) return;
+    delete pipeline;
+    env->DeleteGlobalRef(cb->callback);
+    env->DeleteGlobalRef(cb->result_class);
+    delete cb;
+}
+
+// 在锁内摘下当前流水线，锁外析构
+static void stop_pipeline(JNIEnv* env) {
+    DetectPipeline* pipeline;
+    JavaPipelineCallback* cb;
+    {
+        ncnn::MutexLockGuard g(pipeline_lock);
+        pipeline = g_pipeline;
+        cb = g_pipeline_callback;
+        g_pipeline = 0;
+        g_pipeline_callback = 0;
+    }
+    destroy_pipeline(env, pipeline, cb);
+}
+
+// Image.Plane 的 direct ByteBuffer 转为 Yuv420Planes，不是 direct buffer 时返回 false
+static bool get_yuv_planes(JNIEnv* env, jobject yBuffer, jobject uBuffer, jobject vBuffer, jint width, jint height,
+                           jint yRowStride, jint uvRowStride, jint uvPixelStride, Yuv420Planes& yuv) {
+    yuv.y = (const unsigned char*)env->GetDirectBufferAddress(yBuffer);
+    yuv.u = (const unsigned char*)env->GetDirectBufferAddress(uBuffer);
+    yuv.v = (const unsigned char*)env->GetDirectBufferAddress(vBuffer);
+    yuv.width = width;
+    yuv.height = height;
+    yuv.y_row_stride = yRowStride;
+    yuv.uv_row_stride = uvRowStride;
+    yuv.uv_pixel_stride = uvPixelStride;
+    return yuv.y && yuv.u && yuv.v;
+}
+
+// roiWidth / roiHeight <= 0 时检测整幅画面
+static bool get_roi(jfloat roiX, jfloat roiY, jfloat roiWidth, jfloat roiHeight, Object::Rect& roi) {
+    if (roiWidth <= 0.f || roiHeight <= 0.f) return false;
+    roi.x = roiX;
+    roi.y = roiY;
+    roi.width = roiWidth;
+    roi.height = roiHeight;
+    return true;
+}
+
+extern "C" {
+
+// 只记录 JavaVM 供流水线线程回调；推理强制关闭了 Vulkan（见 Yolov8::load_network），不创建 GPU 实例，
+// 避免加载库时就初始化华为等设备上有问题的 Vulkan 驱动
+JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void* reserved) {
+    g_vm = vm;
+    return JNI_VERSION_1_4;
 }
 
 JNIEXPORT jint JNICALL
 Java_com_tencent_ncnn_Yolov8_loadModel(JNIEnv* env, jobject thiz, jobject assetManager, jstring paramPath, jstring binPath) {
     ncnn::MutexLockGuard g(lock);
-    if (g_yolov8) {
-        delete g_yolov8;
-        g_yolov8 = 0;
+    const char* param_path = env->GetStringUTFChars(paramPath, 0);
+    const char* bin_path = env->GetStringUTFChars(binPath, 0);
+    AAssetManager* mgr = AAssetManager_fromJava(env, assetManager);
+    // 模型按调用方分开，另一调用方已加载同一模型时共用其实例
+    int ret = g_pool.load(get_caller(env, thiz), mgr, param_path, bin_path, g_num_workers);
+    env->ReleaseStringUTFChars(paramPath, param_path);
+    env->ReleaseStringUTFChars(binPath, bin_path);
+    return ret;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setWarmup(JNIEnv* env, jobject thiz, jint runs, jintArray sizes) {
+    WarmupParams params;
+    params.runs = runs;
+    if (sizes) {
+        jsize n = env->GetArrayLength(sizes);
+        params.sizes.resize(n);
+        if (n > 0) env->GetIntArrayRegion(sizes, 0, n, params.sizes.data());
+    }
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_warmup(params);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_tencent_ncnn_Yolov8_getLoadStats(JNIEnv* env, jobject thiz) {
+    const int caller = get_caller(env, thiz);
+    LoadStats stats;
+    {
+        ncnn::MutexLockGuard g(lock);
+        stats = g_pool.load_stats(caller);
     }
+    jclass statsClass = env->FindClass("com/tencent/ncnn/Yolov8$LoadStats");
+    jobject result = env->NewObject(statsClass, env->GetMethodID(statsClass, "<init>", "()V"));
+    env->SetFloatField(result, env->GetFieldID(statsClass, "loadMs", "F"), stats.load_ms);
+    env->SetFloatField(result, env->GetFieldID(statsClass, "warmupMs", "F"), stats.warmup_ms);
+    env->SetFloatField(result, env->GetFieldID(statsClass, "firstMs", "F"), stats.first_ms);
+    env->SetFloatField(result, env->GetFieldID(statsClass, "steadyMs", "F"), stats.steady_ms);
+    env->SetIntField(result, env->GetFieldID(statsClass, "warmupRuns", "I"), stats.warmup_runs);
+    return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_tencent_ncnn_Yolov8_trimMemory(JNIEnv* env, jobject thiz, jint level) {
+    // 不取 lock：系统在主线程回调，不能等可能正在进行的模型加载；池的 trim 可与加载、检测并发
+    return g_pool.trim(level);
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setWorkerCount(JNIEnv* env, jobject thiz, jint count) {
+    ncnn::MutexLockGuard g(lock);
+    g_num_workers = count;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setCallerLimit(JNIEnv* env, jobject thiz, jint caller, jint limit) {
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_caller_limit(caller, limit);
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setRectInference(JNIEnv* env, jobject thiz, jboolean enabled) {
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_rect_inference(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setThreadPolicy(JNIEnv* env, jobject thiz, jint caller, jint policy, jlong mask) {
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_thread_policy(caller, ThreadPolicy(policy, (unsigned long long)mask));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_tencent_ncnn_Yolov8_loadProfile(JNIEnv* env, jobject thiz, jstring profilePath) {
+    const char* profile_path = env->GetStringUTFChars(profilePath, 0);
+    InferenceProfile profile;
+    int ret = profile.load(profile_path);
+    env->ReleaseStringUTFChars(profilePath, profile_path);
+    if (ret != 0) return -1;
+
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_profile(profile);
+    return 0;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_resetProfile(JNIEnv* env, jobject thiz) {
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_profile(InferenceProfile());
+}
+
+JNIEXPORT jint JNICALL
+Java_com_tencent_ncnn_Yolov8_autotune(JNIEnv* env, jobject thiz, jobject assetManager, jstring paramPath, jstring binPath,
+                                      jstring profilePath) {
     const char* param_path = env->GetStringUTFChars(paramPath, 0);
     const char* bin_path = env->GetStringUTFChars(binPath, 0);
+    const char* profile_path = env->GetStringUTFChars(profilePath, 0);
     AAssetManager* mgr = AAssetManager_fromJava(env, assetManager);
-    g_yolov8 = new Yolov8;
-    g_yolov8->load(mgr, param_path, bin_path);
+
+    // 调优用独立的网络，耗时数秒，不持有 lock，期间已加载的池照常推理
+    InferenceProfile profile;
+    int ret = Yolov8::autotune(mgr, param_path, bin_path, TuneParams(), profile);
+    if (ret == 0 && profile.save(profile_path) != 0) LOGE("save %s failed", profile_path);
+
     env->ReleaseStringUTFChars(paramPath, param_path);
     env->ReleaseStringUTFChars(binPath, bin_path);
+    env->ReleaseStringUTFChars(profilePath, profile_path);
+    if (ret != 0) return -1;
+
+    ncnn::MutexLockGuard g(lock);
+    g_pool.set_profile(profile);
     return 0;
 }
 
 JNIEXPORT jobjectArray JNICALL
-Java_com_tencent_ncnn_Yolov8_detect(JNIEnv* env, jobject thiz, jobject bitmap, jfloat threshold) {
-    ncnn::MutexLockGuard g(lock);
-    if (!g_yolov8) return nullptr;
+Java_com_tencent_ncnn_Yolov8_detect(JNIEnv* env, jobject thiz, jobject bitmap,
+                                    jfloat roiX, jfloat roiY, jfloat roiWidth, jfloat roiHeight, jint roiSize,
+                                    jfloat threshold, jintArray classIds,
+                                    jint maxCandidates, jint maxDetections, jint nmsMode, jfloat iouThreshold) {
+    std::vector<int> class_ids;
+    get_class_ids(env, classIds, class_ids);
 
     AndroidBitmapInfo info;
     AndroidBitmap_getInfo(env, bitmap, &info);
-    
-    void* indata;
-    AndroidBitmap_lockPixels(env, bitmap, &indata);
 
-    // 此时 in 只是引用了 indata 的指针，并未拷贝
-    ncnn::Mat in = ncnn::Mat::from_pixels((unsigned char*)indata, ncnn::Mat::PIXEL_RGBA, info.width, info.height);
+    std::vector<Object> objects;
+    NmsParams nms;
+    nms.mode = nmsMode;
+    nms.iou_threshold = iouThreshold;
+    // 实例只在推理期间借出，检测结果留在 objects 中，归还后再构造 Java 对象
+    {
+        Yolov8PoolGuard detector(g_pool, get_caller(env, thiz));
+        if (!detector.get()) return nullptr;
+
+        void* indata;
+        AndroidBitmap_lockPixels(env, bitmap, &indata);
+
+        // 直接读取锁定的像素，不做拷贝；必须在 unlock 之前调用，确保内存有效
+        Object::Rect roi;
+        if (get_roi(roiX, roiY, roiWidth, roiHeight, roi)) {
+            detector->detect_roi((const unsigned char*)indata, info.width, info.height, info.stride, roi, roiSize, objects,
+                                 threshold, class_ids, maxCandidates, maxDetections, nms);
+        } else {
+            detector->detect((const unsigned char*)indata, info.width, info.height, info.stride, objects, threshold, class_ids,
+                             maxCandidates, maxDetections, nms);
+        }
+
+        AndroidBitmap_unlockPixels(env, bitmap);
+    }
+
+    return to_detection_results(env, objects);
+}
+
+// 大图分块推理，块在并行的 extractor 上运行
+JNIEXPORT jobjectArray JNICALL
+Java_com_tencent_ncnn_Yolov8_detectTiled(JNIEnv* env, jobject thiz, jobject bitmap,
+                                         jint tileSize, jfloat overlap, jint inputSize, jboolean fullFrame,
+                                         jfloat threshold, jintArray classIds,
+                                         jint maxCandidates, jint maxDetections, jint nmsMode, jfloat iouThreshold) {
+    std::vector<int> class_ids;
+    get_class_ids(env, classIds, class_ids);
+
+    TileParams tiles;
+    tiles.tile_size = tileSize;
+    tiles.overlap = overlap;
+    tiles.input_size = inputSize;
+    tiles.full_frame = fullFrame;
+
+    AndroidBitmapInfo info;
+    AndroidBitmap_getInfo(env, bitmap, &info);
 
     std::vector<Object> objects;
-    // 必须在 unlock 之前调用，确保内存有效
-    g_yolov8->detect(in, objects, threshold);
+    NmsParams nms;
+    nms.mode = nmsMode;
+    nms.iou_threshold = iouThreshold;
+    int ret;
+    {
+        Yolov8PoolGuard detector(g_pool, get_caller(env, thiz));
+        if (!detector.get()) return nullptr;
 
-    AndroidBitmap_unlockPixels(env, bitmap);
+        void* indata;
+        AndroidBitmap_lockPixels(env, bitmap, &indata);
+        ret = detector->detect_tiled((const unsigned char*)indata, info.width, info.height, info.stride, tiles, objects,
+                                     threshold, class_ids, maxCandidates, maxDetections, nms);
+        AndroidBitmap_unlockPixels(env, bitmap);
+    }
+    if (ret != 0) return nullptr;
 
-    jclass resultClass = env->FindClass("com/tencent/ncnn/Yolov8$DetectionResult");
-    jmethodID resultConstructor = env->GetMethodID(resultClass, "<init>", "()V");
-    jfieldID classIdField = env->GetFieldID(resultClass, "classId", "I");
-    jfieldID classNameField = env->GetFieldID(resultClass, "className", "Ljava/lang/String;");
-    jfieldID confidenceField = env->GetFieldID(resultClass, "confidence", "F");
-    jfieldID xField = env->GetFieldID(resultClass, "x", "F");
-    jfieldID yField = env->GetFieldID(resultClass, "y", "F");
-    jfieldID widthField = env->GetFieldID(resultClass, "width", "F");
-    jfieldID heightField = env->GetFieldID(resultClass, "height", "F");
+    return to_detection_results(env, objects);
+}
 
-    jobjectArray resultArray = env->NewObjectArray(objects.size(), resultClass, nullptr);
-    for (size_t i = 0; i < objects.size(); i++) {
-        jobject result = env->NewObject(resultClass, resultConstructor);
-        env->SetIntField(result, classIdField, objects[i].label);
-        env->SetObjectField(result, classNameField, env->NewStringUTF(g_yolov8->get_class_name(objects[i].label).c_str()));
-        env->SetFloatField(result, confidenceField, objects[i].prob);
-        env->SetFloatField(result, xField, objects[i].rect.x);
-        env->SetFloatField(result, yField, objects[i].rect.y);
-        env->SetFloatField(result, widthField, objects[i].rect.width);
-        env->SetFloatField(result, heightField, objects[i].rect.height);
-        env->SetObjectArrayElement(resultArray, i, result);
+// 相机 YUV_420_888 三平面直接送入 native，buffer 须为 direct ByteBuffer 且在调用期间有效
+JNIEXPORT jobjectArray JNICALL
+Java_com_tencent_ncnn_Yolov8_detectYuv(JNIEnv* env, jobject thiz, jobject yBuffer, jobject uBuffer, jobject vBuffer,
+                                       jint width, jint height, jint yRowStride, jint uvRowStride, jint uvPixelStride,
+                                       jint rotationDegrees, jboolean mirror,
+                                       jfloat roiX, jfloat roiY, jfloat roiWidth, jfloat roiHeight, jint roiSize,
+                                       jfloat threshold, jintArray classIds,
+                                       jint maxCandidates, jint maxDetections, jint nmsMode, jfloat iouThreshold) {
+    Yuv420Planes yuv;
+    if (!get_yuv_planes(env, yBuffer, uBuffer, vBuffer, width, height, yRowStride, uvRowStride, uvPixelStride, yuv)) {
+        LOGE("detectYuv requires direct ByteBuffers");
+        return nullptr;
     }
-    return resultArray;
+
+    std::vector<int> class_ids;
+    get_class_ids(env, classIds, class_ids);
+
+    std::vector<Object> objects;
+    NmsParams nms;
+    nms.mode = nmsMode;
+    nms.iou_threshold = iouThreshold;
+    const int rotate_type = yuv420_rotate_type(rotationDegrees, mirror);
+    Object::Rect roi;
+    const bool has_roi = get_roi(roiX, roiY, roiWidth, roiHeight, roi);
+    int ret;
+    {
+        Yolov8PoolGuard detector(g_pool, get_caller(env, thiz));
+        if (!detector.get()) return nullptr;
+        ret = has_roi
+              ? detector->detect_yuv420_roi(yuv, rotate_type, roi, roiSize, objects, threshold, class_ids, maxCandidates, maxDetections, nms)
+              : detector->detect_yuv420(yuv, rotate_type, objects, threshold, class_ids, maxCandidates, maxDetections, nms);
+    }
+    if (ret != 0) return nullptr;
+
+    return to_detection_results(env, objects);
+}
+
+// 启动相机异步流水线，结果经 callback.onDetections 在 native 推理线程上回调；已启动时先停止旧的
+JNIEXPORT jint JNICALL
+Java_com_tencent_ncnn_Yolov8_startPipeline(JNIEnv* env, jobject thiz, jobject callback) {
+    stop_pipeline(env);
+    if (!callback) return -1;
+
+    jclass callbackClass = env->GetObjectClass(callback);
+    jmethodID onDetections = env->GetMethodID(callbackClass, "onDetections", "(J[Lcom/tencent/ncnn/Yolov8$DetectionResult;II)V");
+    if (!onDetections) return -1;
+
+    JavaPipelineCallback* cb = new JavaPipelineCallback;
+    cb->callback = env->NewGlobalRef(callback);
+    cb->on_detections = onDetections;
+    cb->result_class = (jclass)env->NewGlobalRef(env->FindClass("com/tencent/ncnn/Yolov8$DetectionResult"));
+    DetectPipeline* pipeline = new DetectPipeline(g_pool, get_caller(env, thiz), on_pipeline_result, cb);
+
+    // 与另一次 startPipeline 并发时，后发布的替换先发布的，被替换的在锁外析构
+    DetectPipeline* old_pipeline;
+    JavaPipelineCallback* old_cb;
+    int ret;
+    {
+        ncnn::MutexLockGuard g(pipeline_lock);
+        old_pipeline = g_pipeline;
+        old_cb = g_pipeline_callback;
+        pipeline->set_latency_budget(g_latency_budget);
+        ret = pipeline->start();
+        g_pipeline = pipeline;
+        g_pipeline_callback = cb;
+    }
+    destroy_pipeline(env, old_pipeline, old_cb);
+    return ret;
+}
+
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_setLatencyBudget(JNIEnv* env, jobject thiz, jfloat budgetMs) {
+    ncnn::MutexLockGuard g(pipeline_lock);
+    g_latency_budget = budgetMs;
+    if (g_pipeline) g_pipeline->set_latency_budget(budgetMs);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_tencent_ncnn_Yolov8_getPipelineInputSize(JNIEnv* env, jobject thiz) {
+    ncnn::MutexLockGuard g(pipeline_lock);
+    return g_pipeline ? g_pipeline->input_size() : 0;
+}
+
+// 等待流水线线程退出，之后不再回调
+JNIEXPORT void JNICALL
+Java_com_tencent_ncnn_Yolov8_stopPipeline(JNIEnv* env, jobject thiz) {
+    stop_pipeline(env);
+}
+
+// 拷贝帧后立即返回帧序号，调用方随即可以关闭图像；流水线未启动或参数无效时返回 -1
+JNIEXPORT jlong JNICALL
+Java_com_tencent_ncnn_Yolov8_submitYuv(JNIEnv* env, jobject thiz, jobject yBuffer, jobject uBuffer, jobject vBuffer,
+                                       jint width, jint height, jint yRowStride, jint uvRowStride, jint uvPixelStride,
+                                       jint rotationDegrees, jboolean mirror,
+                                       jfloat roiX, jfloat roiY, jfloat roiWidth, jfloat roiHeight, jint roiSize,
+                                       jfloat threshold, jintArray classIds,
+                                       jint maxCandidates, jint maxDetections, jint nmsMode, jfloat iouThreshold) {
+    Yuv420Planes yuv;
+    if (!get_yuv_planes(env, yBuffer, uBuffer, vBuffer, width, height, yRowStride, uvRowStride, uvPixelStride, yuv)) {
+        LOGE("submitYuv requires direct ByteBuffers");
+        return -1;
+    }
+
+    PipelineParams params;
+    params.rotate_type = yuv420_rotate_type(rotationDegrees, mirror);
+    if (get_roi(roiX, roiY, roiWidth, roiHeight, params.roi)) params.roi_size = roiSize;
+    params.prob_threshold = threshold;
+    get_class_ids(env, classIds, params.class_ids);
+    params.max_candidates = maxCandidates;
+    params.max_detections = maxDetections;
+    params.nms.mode = nmsMode;
+    params.nms.iou_threshold = iouThreshold;
+
+    ncnn::MutexLockGuard g(pipeline_lock);
+    if (!g_pipeline) return -1;
+    return g_pipeline->submit(yuv, params);
 }
 }
 
@@ -0,0 +1,136 @@
+#include "yuv_convert.h"
+#include <string.h>
+#include <ncnn/mat.h>
+
+Yuv420Layout yuv420_layout(const Yuv420Planes& yuv) {
+    const int w = yuv.width;
+    const int h = yuv.height;
+    if (yuv.y_row_stride != w || yuv.uv_row_stride != w || yuv.uv_pixel_stride != 2) return YUV420_STRIDED;
+
+    // 相机 HAL 常把 VU 交错平面紧跟在 Y 之后分配，此时三个 buffer 只是同一块内存的不同视图
+    const unsigned char* uv_begin = yuv.y + w * h;
+    if (yuv.v == uv_begin && yuv.u == yuv.v + 1) return YUV420_NV21;
+    if (yuv.u == uv_begin && yuv.v == yuv.u + 1) return YUV420_NV12;
+    return YUV420_STRIDED;
+}
+
+void yuv420_to_nv21(const Yuv420Planes& yuv, unsigned char* nv21) {
+    const int w = yuv.width;
+    const int h = yuv.height;
+
+    const unsigned char* y = yuv.y;
+    unsigned char* dst = nv21;
+    if (yuv.y_row_stride == w) {
+        memcpy(dst, y, w * h);
+    } else {
+        for (int i = 0; i < h; i++) {
+            memcpy(dst + i * w, y + i * yuv.y_row_stride, w);
+        }
+    }
+
+    // 色度半分辨率，逐行交错为 VU
+    const int cw = w / 2;
+    const int ch = h / 2;
+    const int ps = yuv.uv_pixel_stride;
+    dst = nv21 + w * h;
+    for (int i = 0; i < ch; i++) {
+        const unsigned char* u = yuv.u + i * yuv.uv_row_stride;
+        const unsigned char* v = yuv.v + i * yuv.uv_row_stride;
+        unsigned char* vu = dst + i * w;
+        if (ps == 2 && u == v + 1) {
+            // 行内已是 VU 交错，只是有行填充
+            memcpy(vu, v, w);
+            continue;
+        }
+        for (int j = 0; j < cw; j++) {
+            vu[0] = v[j * ps];
+            vu[1] = u[j * ps];
+            vu += 2;
+        }
+    }
+}
+
+int yuv420_rotate_type(int rotation_degrees, bool mirror) {
+    switch (rotation_degrees) {
+    case 0: return mirror ? 2 : 1;
+    case 90: return mirror ? 5 : 6;
+    case 180: return mirror ? 4 : 3;
+    case 270: return mirror ? 7 : 8;
+    default: return 1;
+    }
+}
+
+void rotate_rect(int rotate_type, int w, int h, int& x0, int& y0, int& x1, int& y1) {
+    const int ax0 = x0, ay0 = y0, ax1 = x1, ay1 = y1;
+    switch (rotate_type) {
+    case 2: x0 = w - ax1; x1 = w - ax0; break;
+    case 3: x0 = w - ax1; x1 = w - ax0; y0 = h - ay1; y1 = h - ay0; break;
+    case 4: y0 = h - ay1; y1 = h - ay0; break;
+    case 5: x0 = ay0; x1 = ay1; y0 = ax0; y1 = ax1; break;
+    case 6: x0 = h - ay1; x1 = h - ay0; y0 = ax0; y1 = ax1; break;
+    case 7: x0 = h - ay1; x1 = h - ay0; y0 = w - ax1; y1 = w - ax0; break;
+    case 8: x0 = ay0; x1 = ay1; y0 = w - ax1; y1 = w - ax0; break;
+    default: break;
+    }
+}
+
+Yuv420Planes yuv420_crop(const Yuv420Planes& yuv, int x, int y, int w, int h) {
+    Yuv420Planes roi = yuv;
+    roi.y = yuv.y + (size_t)y * yuv.y_row_stride + x;
+    roi.u = yuv.u + (size_t)(y / 2) * yuv.uv_row_stride + (x / 2) * yuv.uv_pixel_stride;
+    roi.v = yuv.v + (size_t)(y / 2) * yuv.uv_row_stride + (x / 2) * yuv.uv_pixel_stride;
+    roi.width = w;
+    roi.height = h;
+    return roi;
+}
+
+int yuv420_to_rgb_resize(const Yuv420Planes& yuv, int target_w, int target_h, int rotate_type, unsigned char* rgb,
+                         std::vector<unsigned char>& scratch) {
+    const int w = yuv.width;
+    const int h = yuv.height;
+    if (w <= 0 || h <= 0 || (w & 1) || (h & 1) || (target_w & 1) || (target_h & 1)) return -1;
+
+    // 缩放在旋转前的方向上进行
+    const bool transposed = rotate_type_transposed(rotate_type);
+    const int resize_w = transposed ? target_h : target_w;
+    const int resize_h = transposed ? target_w : target_h;
+    const bool resize = resize_w != w || resize_h != h;
+    const bool rotate = rotate_type > 1 && rotate_type <= 8;
+
+    const size_t src_size = (size_t)w * h * 3 / 2;
+    const size_t dst_size = (size_t)target_w * target_h * 3 / 2;
+
+    Yuv420Layout layout = yuv420_layout(yuv);
+    const size_t pack_offset = 0;
+    const size_t resize_offset = pack_offset + (layout == YUV420_STRIDED ? src_size : 0);
+    const size_t rotate_offset = resize_offset + (resize ? dst_size : 0);
+    const size_t need = rotate_offset + (rotate ? dst_size : 0);
+    if (scratch.size() < need) scratch.resize(need);
+
+    const unsigned char* src = yuv.y;
+    if (layout == YUV420_STRIDED) {
+        yuv420_to_nv21(yuv, &scratch[pack_offset]);
+        src = &scratch[pack_offset];
+        layout = YUV420_NV21;
+    }
+
+    // resize_bilinear_yuv420sp / kanna_rotate_yuv420sp 对 NV21 / NV12 通用，缩放后再旋转、转色
+    if (resize) {
+        unsigned char* dst = &scratch[resize_offset];
+        ncnn::resize_bilinear_yuv420sp(src, w, h, dst, resize_w, resize_h);
+        src = dst;
+    }
+
+    if (rotate) {
+        unsigned char* dst = &scratch[rotate_offset];
+        ncnn::kanna_rotate_yuv420sp(src, resize_w, resize_h, dst, target_w, target_h, rotate_type);
+        src = dst;
+    }
+
+    if (layout == YUV420_NV12) {
+        ncnn::yuv420sp2rgb_nv12(src, target_w, target_h, rgb);
+    } else {
+        ncnn::yuv420sp2rgb(src, target_w, target_h, rgb);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <vector>
+
+// Android YUV_420_888 的三个平面，行距 / 像素步长取自 Image.Plane
+struct Yuv420Planes {
+    const unsigned char* y;
+    const unsigned char* u;
+    const unsigned char* v;
+    int width;
+    int height;
+    int y_row_stride;
+    int uv_row_stride;
+    int uv_pixel_stride;
+};
+
+// 平面布局：紧凑 NV21 / NV12 可直接交给 ncnn，其余布局需先整理
+enum Yuv420Layout {
+    YUV420_STRIDED = 0,
+    YUV420_NV21 = 1,
+    YUV420_NV12 = 2
+};
+
+Yuv420Layout yuv420_layout(const Yuv420Planes& yuv);
+
+// 按行距 / 像素步长把三个平面整理为紧凑 NV21，nv21 至少 width * height * 3 / 2 字节
+void yuv420_to_nv21(const Yuv420Planes& yuv, unsigned char* nv21);
+
+// 相机帧需顺时针旋转 rotation_degrees (0/90/180/270) 才是正向画面，mirror 表示旋转后再水平翻转（前置镜头）
+// 返回 ncnn kanna_rotate 的 EXIF 方向类型 1~8，角度非法时返回 1（不旋转）
+int yuv420_rotate_type(int rotation_degrees, bool mirror);
+
+// kanna_rotate 类型 5~8 会交换宽高
+static inline bool rotate_type_transposed(int type) {
+    return type >= 5 && type <= 8;
+}
+
+// 矩形 [x0, x1) x [y0, y1) 从 w x h 的传感器画面映射到按 rotate_type 旋转后的画面
+void rotate_rect(int rotate_type, int w, int h, int& x0, int& y0, int& x1, int& y1);
+
+// rotate_type 的逆变换：旋转 90 / 270 互逆，其余类型为自身
+static inline int inverse_rotate_type(int type) {
+    return type == 6 ? 8 : type == 8 ? 6 : type;
+}
+
+// 裁剪 [x, x + w) x [y, y + h)，只调整平面指针与尺寸不拷贝；x / y / w / h 需为偶数
+Yuv420Planes yuv420_crop(const Yuv420Planes& yuv, int x, int y, int w, int h);
+
+// 转换并双线性缩放到 target_w x target_h 的 RGB，先在 YUV 上缩放再旋转、转色，只处理缩小后的像素
+// target_w / target_h 为旋转后的尺寸；宽高与目标尺寸都需为偶数；scratch 跨帧复用，返回 0 成功
+int yuv420_to_rgb_resize(const Yuv420Planes& yuv, int target_w, int target_h, int rotate_type, unsigned char* rgb,
+                         std::vector<unsigned char>& scratch);
+
+#endif // YUV_CONVERT_H
@@ -0,0 +1,93 @@
+// <android/asset_manager.h> 桩的实现，见 stub/android/asset_manager.h
+#include <android/asset_manager.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+
+struct AAssetManager {
+    std::string root;
+    bool compressed;
+};
+
+struct AAsset {
+    int fd;
+    off_t size;
+    off_t pos;
+    bool compressed;
+    void* map;            // 未压缩时的文件映射
+    unsigned char* heap;  // 压缩时解压到堆上的内容
+};
+
+AAssetManager* AAssetManager_createHost(const char* root, int compressed) {
+    AAssetManager* mgr = new AAssetManager;
+    mgr->root = root;
+    mgr->compressed = compressed != 0;
+    return mgr;
+}
+
+void AAssetManager_destroyHost(AAssetManager* mgr) {
+    delete mgr;
+}
+
+AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode) {
+    const std::string path = mgr->root + "/" + filename;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+
+    AAsset* asset = new AAsset;
+    asset->fd = fd;
+    asset->size = st.st_size;
+    asset->pos = 0;
+    asset->compressed = mgr->compressed;
+    asset->map = 0;
+    asset->heap = 0;
+    if (mode == AASSET_MODE_BUFFER && !asset->compressed && st.st_size > 0) {
+        void* map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) asset->map = map;
+    }
+    return asset;
+}
+
+off_t AAsset_getLength(AAsset* asset) {
+    return asset->size;
+}
+
+int AAsset_read(AAsset* asset, void* buf, size_t count) {
+    ssize_t n = pread(asset->fd, buf, count, asset->pos);
+    if (n < 0) return -1;
+    asset->pos += n;
+    return (int)n;
+}
+
+const void* AAsset_getBuffer(AAsset* asset) {
+    if (asset->map) return asset->map;
+    if (!asset->heap) {
+        asset->heap = (unsigned char*)malloc(asset->size > 0 ? asset->size : 1);
+        if (!asset->heap) return 0;
+        if (pread(asset->fd, asset->heap, asset->size, 0) != asset->size) {
+            free(asset->heap);
+            asset->heap = 0;
+        }
+    }
+    return asset->heap;
+}
+
+int AAsset_isAllocated(AAsset* asset) {
+    return asset->heap ? 1 : 0;
+}
+
+void AAsset_close(AAsset* asset) {
+    if (asset->map) munmap(asset->map, asset->size);
+    free(asset->heap);
+    close(asset->fd);
+    delete asset;
+}
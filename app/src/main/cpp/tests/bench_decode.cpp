@@ -0,0 +1,163 @@
+// 解码基准：按类别行连续扫描的 SIMD argmax + top-K（decode_yolov8_output）
+// 对比逐 anchor 按列比较的标量基线（重构前 Yolov8::detect 中的循环），并校验两者输出逐位一致
+//
+// 用法：bench_decode [--iters N] [--threads N]
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "yolov8_decode.h"
+#include "yolov8_fixture.h"
+
+// 标量基线：每个 anchor 依次读取 num_class 个相隔 num_anchor 的分数，再按 (分数降序, 下标升序) 截取 top-K
+static void decode_scalar(const ncnn::Mat& out, float prob_threshold, int max_candidates,
+                          const LetterboxTransform& tf, std::vector<Candidate>& candidates,
+                          std::vector<int>& labels, std::vector<Object>& proposals) {
+    const int num_anchor = out.w;
+    const int num_class = out.h - 4;
+    candidates.clear();
+    labels.resize(num_anchor);
+    for (int i = 0; i < num_anchor; i++) {
+        int label = -1;
+        float score = -1.f;
+        for (int j = 0; j < num_class; j++) {
+            float class_score = out.row(4 + j)[i];
+            if (class_score > score) {
+                label = j;
+                score = class_score;
+            }
+        }
+        labels[i] = label;
+        if (score >= prob_threshold) {
+            Candidate c = {score, i};
+            candidates.push_back(c);
+        }
+    }
+
+    if (max_candidates > 0 && (int)candidates.size() > max_candidates) {
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.score != b.score ? a.score > b.score : a.index < b.index;
+        });
+        candidates.resize(max_candidates);
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.index < b.index;
+        });
+    }
+
+    for (size_t k = 0; k < candidates.size(); k++) {
+        const int i = candidates[k].index;
+        const float x = out.row(0)[i], y = out.row(1)[i], w = out.row(2)[i], h = out.row(3)[i];
+        Object obj;
+        letterbox_to_image(x - w * 0.5f, y - h * 0.5f, x + w * 0.5f, y + h * 0.5f, tf, obj);
+        obj.label = labels[i];
+        obj.prob = candidates[k].score;
+        proposals.push_back(obj);
+    }
+}
+
+static bool same_objects(const std::vector<Object>& a, const std::vector<Object>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].label != b[i].label || memcmp(&a[i].prob, &b[i].prob, sizeof(float)) != 0
+            || memcmp(&a[i].rect, &b[i].rect, sizeof(Object::Rect)) != 0)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int iters = 200;
+    int threads = 4;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--iters") == 0) iters = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+    }
+    if (iters < 1) iters = 1;
+
+    const int num_class = 80;
+    const int num_anchor = 8400;
+    const float prob_threshold = 0.25f;
+    const LetterboxTransform tf = {0.5f, 0.f, 80.f};
+    const std::vector<int> all_classes;
+
+    TestRng rng(20240601);
+    ncnn::Mat out;
+    random_yolov8_output(out, num_class, num_anchor, 0.05f, rng);
+
+    // 分别在不限候选数与 top-K 截断（候选数多于上限）两种情况下对比
+    const int limits[2] = {0, 100};
+    for (int l = 0; l < 2; l++) {
+        const int max_candidates = limits[l];
+
+        std::vector<Candidate> base_candidates;
+        std::vector<int> base_labels;
+        std::vector<Object> base, simd, simd_mt;
+        DecodeScratch scratch;
+
+        double t0 = test_now_ms();
+        for (int it = 0; it < iters; it++) {
+            base.clear();
+            decode_scalar(out, prob_threshold, max_candidates, tf, base_candidates, base_labels, base);
+        }
+        double t1 = test_now_ms();
+        for (int it = 0; it < iters; it++) {
+            simd.clear();
+            decode_yolov8_output(out, prob_threshold, all_classes, max_candidates, tf, simd, scratch, 1);
+        }
+        double t2 = test_now_ms();
+        for (int it = 0; it < iters; it++) {
+            simd_mt.clear();
+            decode_yolov8_output(out, prob_threshold, all_classes, max_candidates, tf, simd_mt, scratch, threads);
+        }
+        double t3 = test_now_ms();
+
+        CHECK(!base.empty());
+        CHECK(same_objects(base, simd));
+        CHECK(same_objects(base, simd_mt));
+
+        const double scalar_ms = (t1 - t0) / iters;
+        const double simd_ms = (t2 - t1) / iters;
+        const double mt_ms = (t3 - t2) / iters;
+        printf("max_candidates=%-4d proposals=%-4d scalar %.3f ms  simd %.3f ms (x%.2f)  simd %d threads %.3f ms (x%.2f)\n",
+               max_candidates, (int)base.size(), scalar_ms, simd_ms, scalar_ms / simd_ms, threads, mt_ms, scalar_ms / mt_ms);
+    }
+
+    // 只看 argmax 扫描本身：逐列标量 vs 按行 SIMD
+    {
+        std::vector<int> ids;
+        prepare_class_ids(all_classes, num_class, ids);
+        std::vector<float> ms(num_anchor), base_ms(num_anchor);
+        std::vector<int> ml(num_anchor), base_ml(num_anchor);
+
+        double t0 = test_now_ms();
+        for (int it = 0; it < iters; it++) {
+            for (int i = 0; i < num_anchor; i++) {
+                int label = -1;
+                float score = -1.f;
+                for (int j = 0; j < num_class; j++) {
+                    float s = out.row(4 + j)[i];
+                    if (s > score) {
+                        label = j;
+                        score = s;
+                    }
+                }
+                base_ms[i] = score;
+                base_ml[i] = label;
+            }
+        }
+        double t1 = test_now_ms();
+        for (int it = 0; it < iters; it++) {
+            argmax_class_rows(out.row(4), out.w, ids.data(), num_class, num_anchor, ms.data(), ml.data());
+        }
+        double t2 = test_now_ms();
+
+        CHECK(memcmp(ms.data(), base_ms.data(), num_anchor * sizeof(float)) == 0);
+        CHECK(ml == base_ml);
+
+        const double scalar_ms = (t1 - t0) / iters;
+        const double simd_ms = (t2 - t1) / iters;
+        printf("argmax only          scalar %.3f ms  simd %.3f ms (x%.2f)\n", scalar_ms, simd_ms, scalar_ms / simd_ms);
+    }
+
+    return 0;
+}
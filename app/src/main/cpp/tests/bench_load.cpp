@@ -0,0 +1,205 @@
+// 模型加载基准：对比三种权重来源的加载耗时与常驻内存，并校验检测结果一致
+//   asset (compressed)  asset 被压缩，AAsset_getBuffer 解压到堆上，权重全部计入匿名内存（改为 noCompress 前的情形）
+//   asset (stored)      noCompress 存放，AAsset_getBuffer 返回文件映射，权重页为干净的文件页
+//   file mmap           Yolov8::load(param_path, bin_path)，权重文件 mmap
+// 每种方式在独立子进程中加载，读取 /proc/self/status 中 VmRSS / RssAnon / RssFile 的增量；
+// 随后检测一幅合成图，再分别在 trim(TRIM_BUFFERS) 与 trim(TRIM_WEIGHTS) + reload 后各检测一次，各路径的结果须逐位一致
+//
+// 用法：bench_load [--model-dir DIR] [--param NAME] [--bin NAME]
+// 需要主机上的 ncnn 与模型文件，见 tests/CMakeLists.txt
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "yolov8.h"
+#include "test_util.h"
+
+#ifndef YOLOV8NCNN_MODEL_DIR
+#define YOLOV8NCNN_MODEL_DIR "."
+#endif
+
+enum LoadMode {
+    LOAD_ASSET_COMPRESSED = 0,
+    LOAD_ASSET_STORED = 1,
+    LOAD_FILE_MMAP = 2
+};
+
+static const char* const mode_names[] = {"asset (compressed)", "asset (stored)", "file mmap"};
+
+static const int max_objects = 64;
+
+// 子进程经管道交回的结果
+struct LoadResult {
+    int ret;
+    double load_ms;
+    long rss_kb;
+    long anon_kb;
+    long file_kb;
+    int num_objects;
+    int num_trimmed;
+    int num_reloaded;
+    Object objects[max_objects];
+    Object trimmed[max_objects];
+    Object reloaded[max_objects];
+};
+
+// 读取 /proc/self/status 中的一项，单位 kB；没有该项时返回 0
+static long read_status_kb(const char* key) {
+    FILE* fp = fopen("/proc/self/status", "r");
+    if (!fp) return 0;
+    char line[256];
+    long value = 0;
+    const size_t key_len = strlen(key);
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ':') {
+            value = atol(line + key_len + 1);
+            break;
+        }
+    }
+    fclose(fp);
+    return value;
+}
+
+static int copy_objects(const std::vector<Object>& objects, Object* out) {
+    const int n = std::min((int)objects.size(), max_objects);
+    for (int i = 0; i < n; i++) out[i] = objects[i];
+    return n;
+}
+
+static void run_load(int mode, const std::string& dir, const std::string& param, const std::string& bin,
+                     const std::vector<unsigned char>& rgba, LoadResult& r) {
+    memset(&r, 0, sizeof(r));
+    AAssetManager* mgr = mode == LOAD_FILE_MMAP ? 0 : AAssetManager_createHost(dir.c_str(), mode == LOAD_ASSET_COMPRESSED);
+    const std::string param_path = mode == LOAD_FILE_MMAP ? dir + "/" + param : param;
+    const std::string bin_path = mode == LOAD_FILE_MMAP ? dir + "/" + bin : bin;
+
+    const long rss0 = read_status_kb("VmRSS");
+    const long anon0 = read_status_kb("RssAnon");
+    const long file0 = read_status_kb("RssFile");
+    const double start = test_now_ms();
+
+    Yolov8* detector = new Yolov8;
+    r.ret = mgr ? detector->load(mgr, param_path.c_str(), bin_path.c_str())
+                : detector->load(param_path.c_str(), bin_path.c_str());
+    r.load_ms = test_now_ms() - start;
+    r.rss_kb = read_status_kb("VmRSS") - rss0;
+    r.anon_kb = read_status_kb("RssAnon") - anon0;
+    r.file_kb = read_status_kb("RssFile") - file0;
+
+    if (r.ret == 0) {
+        std::vector<Object> objects;
+        r.ret = detector->detect(&rgba[0], 640, 480, 640 * 4, objects, 0.05f);
+        r.num_objects = copy_objects(objects, r.objects);
+
+        // 只释放缓冲（含融合层的后处理缓冲），下一次检测重新分配
+        detector->trim(TRIM_BUFFERS);
+        if (r.ret == 0) r.ret = detector->detect(&rgba[0], 640, 480, 640 * 4, objects, 0.05f);
+        r.num_trimmed = copy_objects(objects, r.trimmed);
+
+        // 卸载网络后从保留的 param 与权重重建
+        detector->trim(TRIM_WEIGHTS);
+        if (r.ret == 0) r.ret = detector->reload();
+        if (r.ret == 0) r.ret = detector->detect(&rgba[0], 640, 480, 640 * 4, objects, 0.05f);
+        r.num_reloaded = copy_objects(objects, r.reloaded);
+    }
+
+    delete detector;
+    if (mgr) AAssetManager_destroyHost(mgr);
+}
+
+// 在子进程中加载，内存增量不受前一种方式残留的影响
+static bool run_in_child(int mode, const std::string& dir, const std::string& param, const std::string& bin,
+                         const std::vector<unsigned char>& rgba, LoadResult& r) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fds[0]);
+        LoadResult* child = new LoadResult;
+        run_load(mode, dir, param, bin, rgba, *child);
+        const char* p = (const char*)child;
+        size_t left = sizeof(LoadResult);
+        while (left > 0) {
+            ssize_t n = write(fds[1], p, left);
+            if (n <= 0) _exit(1);
+            p += n;
+            left -= n;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    char* p = (char*)&r;
+    size_t left = sizeof(LoadResult);
+    while (left > 0) {
+        ssize_t n = read(fds[0], p, left);
+        if (n <= 0) break;
+        p += n;
+        left -= n;
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return left == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool same_objects(const Object* a, int na, const Object* b, int nb) {
+    if (na != nb) return false;
+    for (int i = 0; i < na; i++) {
+        if (a[i].label != b[i].label || a[i].prob != b[i].prob || a[i].rect.x != b[i].rect.x || a[i].rect.y != b[i].rect.y
+            || a[i].rect.width != b[i].rect.width || a[i].rect.height != b[i].rect.height)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string dir = YOLOV8NCNN_MODEL_DIR;
+    std::string param = "model.ncnn.param";
+    std::string bin = "model.ncnn.bin";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--model-dir") == 0) dir = argv[i + 1];
+        else if (strcmp(argv[i], "--param") == 0) param = argv[i + 1];
+        else if (strcmp(argv[i], "--bin") == 0) bin = argv[i + 1];
+    }
+
+    // 合成图：平滑的色块加噪声，低阈值下能产生若干检测框
+    TestRng rng(1717);
+    std::vector<unsigned char> rgba(640 * 480 * 4);
+    for (int y = 0; y < 480; y++) {
+        for (int x = 0; x < 640; x++) {
+            unsigned char* p = &rgba[(y * 640 + x) * 4];
+            p[0] = (unsigned char)((x / 80 * 37 + rng.below(16)) & 255);
+            p[1] = (unsigned char)((y / 60 * 53 + rng.below(16)) & 255);
+            p[2] = (unsigned char)(((x + y) / 100 * 71 + rng.below(16)) & 255);
+            p[3] = 255;
+        }
+    }
+
+    LoadResult results[3];
+    for (int m = 0; m < 3; m++) {
+        CHECK(run_in_child(m, dir, param, bin, rgba, results[m]));
+        const LoadResult& r = results[m];
+        CHECK(r.ret == 0);
+        printf("%-20s load %7.1f ms  VmRSS %+7ld kB  RssAnon %+7ld kB  RssFile %+7ld kB  %d objects\n", mode_names[m],
+               r.load_ms, r.rss_kb, r.anon_kb, r.file_kb, r.num_objects);
+    }
+
+    for (int m = 0; m < 3; m++) {
+        const LoadResult& r = results[m];
+        CHECK(same_objects(r.objects, r.num_objects, results[0].objects, results[0].num_objects));
+        CHECK(same_objects(r.trimmed, r.num_trimmed, r.objects, r.num_objects));
+        CHECK(same_objects(r.reloaded, r.num_reloaded, r.objects, r.num_objects));
+    }
+
+    // 引用映射的两种方式不应比解压到堆上多占匿名内存
+    CHECK(results[LOAD_ASSET_STORED].anon_kb <= results[LOAD_ASSET_COMPRESSED].anon_kb);
+    CHECK(results[LOAD_FILE_MMAP].anon_kb <= results[LOAD_ASSET_COMPRESSED].anon_kb);
+    return 0;
+}
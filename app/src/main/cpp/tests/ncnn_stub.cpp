@@ -0,0 +1,412 @@
+// 主机测试用的 ncnn 桩，只在找不到主机版 ncnn 时参与链接
+// 头文件取自仓库中的 app/ncnn/include，这里只实现测试代码实际用到的非内联符号，语义与 ncnn 一致
+#include <math.h>
+#include <string.h>
+#include <ncnn/mat.h>
+#include <ncnn/layer.h>
+#include <ncnn/net.h>
+#include <ncnn/cpu.h>
+#include <ncnn/option.h>
+#include <ncnn/paramdict.h>
+
+namespace ncnn {
+
+Allocator::~Allocator() {}
+
+// ---------------- Mat ----------------
+
+void Mat::create(int _w, size_t _elemsize, Allocator* _allocator) {
+    create(_w, _elemsize, 1, _allocator);
+}
+
+void Mat::create(int _w, int _h, size_t _elemsize, Allocator* _allocator) {
+    create(_w, _h, _elemsize, 1, _allocator);
+}
+
+void Mat::create(int _w, int _h, int _c, size_t _elemsize, Allocator* _allocator) {
+    create(_w, _h, _c, _elemsize, 1, _allocator);
+}
+
+void Mat::create(int _w, int _h, int _d, int _c, size_t _elemsize, Allocator* _allocator) {
+    create(_w, _h, _d, _c, _elemsize, 1, _allocator);
+}
+
+// 与 ncnn 相同：尺寸与分配器都不变时复用，否则释放后按 cstep 16 字节对齐重新分配
+static void mat_alloc(Mat& m, int dims, int w, int h, int d, int c, size_t elemsize, int elempack, Allocator* allocator) {
+    if (m.dims == dims && m.w == w && m.h == h && m.d == d && m.c == c && m.elemsize == elemsize
+        && m.elempack == elempack && m.allocator == allocator)
+        return;
+
+    m.release();
+
+    m.elemsize = elemsize;
+    m.elempack = elempack;
+    m.allocator = allocator;
+    m.dims = dims;
+    m.w = w;
+    m.h = h;
+    m.d = d;
+    m.c = c;
+    m.cstep = dims == 3 || dims == 4 ? alignSize((size_t)w * h * d * elemsize, 16) / elemsize : (size_t)w * h * d;
+
+    size_t totalsize = alignSize(m.total() * elemsize, 4);
+    if (totalsize > 0) {
+        m.data = allocator ? allocator->fastMalloc(totalsize + sizeof(*m.refcount))
+                           : fastMalloc(totalsize + sizeof(*m.refcount));
+        m.refcount = (int*)(((unsigned char*)m.data) + totalsize);
+        *m.refcount = 1;
+    }
+}
+
+void Mat::create(int _w, size_t _elemsize, int _elempack, Allocator* _allocator) {
+    mat_alloc(*this, 1, _w, 1, 1, 1, _elemsize, _elempack, _allocator);
+}
+
+void Mat::create(int _w, int _h, size_t _elemsize, int _elempack, Allocator* _allocator) {
+    mat_alloc(*this, 2, _w, _h, 1, 1, _elemsize, _elempack, _allocator);
+}
+
+void Mat::create(int _w, int _h, int _c, size_t _elemsize, int _elempack, Allocator* _allocator) {
+    mat_alloc(*this, 3, _w, _h, 1, _c, _elemsize, _elempack, _allocator);
+}
+
+void Mat::create(int _w, int _h, int _d, int _c, size_t _elemsize, int _elempack, Allocator* _allocator) {
+    mat_alloc(*this, 4, _w, _h, _d, _c, _elemsize, _elempack, _allocator);
+}
+
+void Mat::create_like(const Mat& m, Allocator* _allocator) {
+    if (m.dims == 1) create(m.w, m.elemsize, m.elempack, _allocator);
+    else if (m.dims == 2) create(m.w, m.h, m.elemsize, m.elempack, _allocator);
+    else if (m.dims == 3) create(m.w, m.h, m.c, m.elemsize, m.elempack, _allocator);
+    else if (m.dims == 4) create(m.w, m.h, m.d, m.c, m.elemsize, m.elempack, _allocator);
+}
+
+Mat Mat::clone(Allocator* _allocator) const {
+    if (empty()) return Mat();
+    Mat m;
+    m.create_like(*this, _allocator);
+    if (total() > 0) memcpy(m.data, data, total() * elemsize);
+    return m;
+}
+
+// ---------------- YUV420sp 缩放 / 旋转 / 转色 ----------------
+// 逐像素浮点实现，语义与 ncnn 相同（中心对齐双线性、EXIF 方向、BT.601 近似系数），不追求速度
+
+// 中心对齐的双线性缩放，channels 个交错通道
+static void resize_bilinear_cn(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, int channels) {
+    const float scale_x = (float)srcw / w;
+    const float scale_y = (float)srch / h;
+    for (int dy = 0; dy < h; dy++) {
+        float fy = (dy + 0.5f) * scale_y - 0.5f;
+        int sy = (int)floorf(fy);
+        fy -= sy;
+        if (sy < 0) {
+            sy = 0;
+            fy = 0.f;
+        }
+        if (sy >= srch - 1) {
+            sy = srch > 1 ? srch - 2 : 0;
+            fy = srch > 1 ? 1.f : 0.f;
+        }
+        const int sy1 = srch > 1 ? sy + 1 : sy;
+
+        for (int dx = 0; dx < w; dx++) {
+            float fx = (dx + 0.5f) * scale_x - 0.5f;
+            int sx = (int)floorf(fx);
+            fx -= sx;
+            if (sx < 0) {
+                sx = 0;
+                fx = 0.f;
+            }
+            if (sx >= srcw - 1) {
+                sx = srcw > 1 ? srcw - 2 : 0;
+                fx = srcw > 1 ? 1.f : 0.f;
+            }
+            const int sx1 = srcw > 1 ? sx + 1 : sx;
+
+            for (int k = 0; k < channels; k++) {
+                float v00 = src[((size_t)sy * srcw + sx) * channels + k];
+                float v01 = src[((size_t)sy * srcw + sx1) * channels + k];
+                float v10 = src[((size_t)sy1 * srcw + sx) * channels + k];
+                float v11 = src[((size_t)sy1 * srcw + sx1) * channels + k];
+                float v = (v00 * (1.f - fx) + v01 * fx) * (1.f - fy) + (v10 * (1.f - fx) + v11 * fx) * fy;
+                dst[((size_t)dy * w + dx) * channels + k] = (unsigned char)(v + 0.5f);
+            }
+        }
+    }
+}
+
+void resize_bilinear_yuv420sp(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h) {
+    resize_bilinear_cn(src, srcw, srch, dst, w, h, 1);
+    resize_bilinear_cn(src + srcw * srch, srcw / 2, srch / 2, dst + w * h, w / 2, h / 2, 2);
+}
+
+// EXIF 方向：1 原样 2 水平翻转 3 旋转 180 4 垂直翻转 5 转置 6 顺时针 90 7 反转置 8 逆时针 90
+static void kanna_rotate_cn(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, int type, int channels) {
+    for (int y = 0; y < srch; y++) {
+        for (int x = 0; x < srcw; x++) {
+            int dx = x, dy = y;
+            switch (type) {
+            case 2: dx = srcw - 1 - x; break;
+            case 3: dx = srcw - 1 - x; dy = srch - 1 - y; break;
+            case 4: dy = srch - 1 - y; break;
+            case 5: dx = y; dy = x; break;
+            case 6: dx = srch - 1 - y; dy = x; break;
+            case 7: dx = srch - 1 - y; dy = srcw - 1 - x; break;
+            case 8: dx = y; dy = srcw - 1 - x; break;
+            default: break;
+            }
+            if (dx < 0 || dx >= w || dy < 0 || dy >= h) continue;
+            memcpy(dst + ((size_t)dy * w + dx) * channels, src + ((size_t)y * srcw + x) * channels, channels);
+        }
+    }
+}
+
+void kanna_rotate_yuv420sp(const unsigned char* src, int srcw, int srch, unsigned char* dst, int w, int h, int type) {
+    kanna_rotate_cn(src, srcw, srch, dst, w, h, type, 1);
+    kanna_rotate_cn(src + srcw * srch, srcw / 2, srch / 2, dst + w * h, w / 2, h / 2, type, 2);
+}
+
+static inline unsigned char saturate_uchar(int v) {
+    return (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+// v_first：色度平面为 VU 交错（NV21）
+static void yuv420sp_to_rgb(const unsigned char* yuv420sp, int w, int h, unsigned char* rgb, bool v_first) {
+    const unsigned char* uv = yuv420sp + w * h;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const unsigned char* c = uv + (size_t)(y / 2) * w + (x / 2) * 2;
+            const int v = (v_first ? c[0] : c[1]) - 128;
+            const int u = (v_first ? c[1] : c[0]) - 128;
+            const int yy = yuv420sp[(size_t)y * w + x] << 6;
+            unsigned char* p = rgb + ((size_t)y * w + x) * 3;
+            p[0] = saturate_uchar((yy + 90 * v) >> 6);
+            p[1] = saturate_uchar((yy - 46 * v - 22 * u) >> 6);
+            p[2] = saturate_uchar((yy + 113 * u) >> 6);
+        }
+    }
+}
+
+void yuv420sp2rgb(const unsigned char* yuv420sp, int w, int h, unsigned char* rgb) {
+    yuv420sp_to_rgb(yuv420sp, w, h, rgb, true);
+}
+
+void yuv420sp2rgb_nv12(const unsigned char* yuv420sp, int w, int h, unsigned char* rgb) {
+    yuv420sp_to_rgb(yuv420sp, w, h, rgb, false);
+}
+
+// ---------------- 半精度 ----------------
+
+float float16_to_float32(unsigned short value) {
+    unsigned int sign = (value & 0x8000) << 16;
+    unsigned int exponent = (value >> 10) & 0x1f;
+    unsigned int significand = value & 0x3ff;
+
+    unsigned int bits;
+    if (exponent == 0) {
+        if (significand == 0) {
+            bits = sign;
+        } else {
+            // 非规格化数规格化
+            exponent = 127 - 14;
+            while (!(significand & 0x400)) {
+                significand <<= 1;
+                exponent--;
+            }
+            significand &= 0x3ff;
+            bits = sign | (exponent << 23) | (significand << 13);
+        }
+    } else if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (significand << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (significand << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+unsigned short float32_to_float16(float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    unsigned short sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    unsigned int significand = bits & 0x7fffff;
+
+    if (exponent >= 0x1f) return sign | 0x7c00;  // 溢出为无穷
+    if (exponent <= 0) {
+        if (exponent < -10) return sign;
+        significand = (significand | 0x800000) >> (1 - exponent);
+        return sign | (unsigned short)((significand + 0x1000) >> 13);
+    }
+    unsigned short h = sign | (unsigned short)(exponent << 10) | (unsigned short)(significand >> 13);
+    if (significand & 0x1000) h++;  // 就近舍入
+    return h;
+}
+
+// ---------------- ParamDict ----------------
+
+#define NCNN_MAX_PARAM_COUNT 32
+
+class ParamDictPrivate {
+public:
+    struct {
+        int type;  // 0 未设置 2 int 3 float 5 数组
+        union {
+            int i;
+            float f;
+        };
+        Mat v;
+    } params[NCNN_MAX_PARAM_COUNT];
+};
+
+ParamDict::ParamDict() : d(new ParamDictPrivate) {
+    clear();
+}
+
+ParamDict::~ParamDict() {
+    delete d;
+}
+
+ParamDict::ParamDict(const ParamDict& rhs) : d(new ParamDictPrivate) {
+    for (int i = 0; i < NCNN_MAX_PARAM_COUNT; i++) d->params[i] = rhs.d->params[i];
+}
+
+ParamDict& ParamDict::operator=(const ParamDict& rhs) {
+    if (this == &rhs) return *this;
+    for (int i = 0; i < NCNN_MAX_PARAM_COUNT; i++) d->params[i] = rhs.d->params[i];
+    return *this;
+}
+
+int ParamDict::type(int id) const {
+    return d->params[id].type;
+}
+
+int ParamDict::get(int id, int def) const {
+    return d->params[id].type ? d->params[id].i : def;
+}
+
+float ParamDict::get(int id, float def) const {
+    return d->params[id].type ? d->params[id].f : def;
+}
+
+Mat ParamDict::get(int id, const Mat& def) const {
+    return d->params[id].type ? d->params[id].v : def;
+}
+
+void ParamDict::set(int id, int i) {
+    d->params[id].type = 2;
+    d->params[id].i = i;
+}
+
+void ParamDict::set(int id, float f) {
+    d->params[id].type = 3;
+    d->params[id].f = f;
+}
+
+void ParamDict::set(int id, const Mat& v) {
+    d->params[id].type = 5;
+    d->params[id].v = v;
+}
+
+void ParamDict::clear() {
+    for (int i = 0; i < NCNN_MAX_PARAM_COUNT; i++) {
+        d->params[i].type = 0;
+        d->params[i].v = Mat();
+    }
+}
+
+// ---------------- Option ----------------
+
+// 只保证测试读取的字段与 ncnn 默认值一致，其余清零
+Option::Option() {
+    memset(this, 0, sizeof(*this));
+    lightmode = true;
+    num_threads = 1;
+    openmp_blocktime = 20;
+    use_packing_layout = true;
+    vulkan_device_index = -1;
+}
+
+// ---------------- Layer ----------------
+
+Layer::Layer() {
+    one_blob_only = false;
+    support_inplace = false;
+    support_vulkan = false;
+    support_packing = false;
+    support_bf16_storage = false;
+    support_fp16_storage = false;
+    support_int8_storage = false;
+    support_tensor_storage = false;
+    featmask = 0;
+    vkdev = 0;
+    userdata = 0;
+    typeindex = -1;
+}
+
+Layer::~Layer() {}
+
+int Layer::load_param(const ParamDict&) { return 0; }
+int Layer::load_model(const ModelBin&) { return 0; }
+int Layer::create_pipeline(const Option&) { return 0; }
+int Layer::destroy_pipeline(const Option&) { return 0; }
+
+int Layer::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const {
+    if (!support_inplace) return -1;
+    top_blobs = bottom_blobs;
+    for (size_t i = 0; i < top_blobs.size(); i++) top_blobs[i] = bottom_blobs[i].clone(opt.blob_allocator);
+    return forward_inplace(top_blobs, opt);
+}
+
+int Layer::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const {
+    if (!support_inplace) return -1;
+    top_blob = bottom_blob.clone(opt.blob_allocator);
+    return forward_inplace(top_blob, opt);
+}
+
+int Layer::forward_inplace(std::vector<Mat>&, const Option&) const { return -1; }
+int Layer::forward_inplace(Mat&, const Option&) const { return -1; }
+
+#if NCNN_VULKAN
+int Layer::upload_model(VkTransfer&, const Option&) { return 0; }
+int Layer::forward(const std::vector<VkMat>&, std::vector<VkMat>&, VkCompute&, const Option&) const { return -1; }
+int Layer::forward(const VkMat&, VkMat&, VkCompute&, const Option&) const { return -1; }
+int Layer::forward_inplace(std::vector<VkMat>&, VkCompute&, const Option&) const { return -1; }
+int Layer::forward_inplace(VkMat&, VkCompute&, const Option&) const { return -1; }
+#endif // NCNN_VULKAN
+
+// ---------------- Net / 分配器 / CpuSet ----------------
+
+// 只供 yolov8_stub.cpp 中的 Yolov8 成员构造与析构，不加载、不推理
+Net::Net() : d(0) {}
+Net::~Net() {}
+int Net::custom_layer_to_index(const char*) { return -1; }
+Layer* Net::create_custom_layer(const char*) { return 0; }
+Layer* Net::create_overwrite_builtin_layer(const char*) { return 0; }
+Layer* Net::create_custom_layer(int) { return 0; }
+Layer* Net::create_overwrite_builtin_layer(int) { return 0; }
+
+Extractor::~Extractor() {}
+
+// 不缓存，直接转给 fastMalloc / fastFree
+PoolAllocator::PoolAllocator() : d(0) {}
+PoolAllocator::~PoolAllocator() {}
+void PoolAllocator::clear() {}
+void* PoolAllocator::fastMalloc(size_t size) { return ncnn::fastMalloc(size); }
+void PoolAllocator::fastFree(void* ptr) { ncnn::fastFree(ptr); }
+
+UnlockedPoolAllocator::UnlockedPoolAllocator() : d(0) {}
+UnlockedPoolAllocator::~UnlockedPoolAllocator() {}
+void UnlockedPoolAllocator::clear() {}
+void* UnlockedPoolAllocator::fastMalloc(size_t size) { return ncnn::fastMalloc(size); }
+void UnlockedPoolAllocator::fastFree(void* ptr) { ncnn::fastFree(ptr); }
+
+CpuSet::CpuSet() {
+    CPU_ZERO(&cpu_set);
+}
+
+} // namespace ncnn
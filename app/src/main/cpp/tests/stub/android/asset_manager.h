@@ -0,0 +1,60 @@
+#ifndef ANDROID_ASSET_MANAGER_STUB_H
+#define ANDROID_ASSET_MANAGER_STUB_H
+
+// 主机测试用的 <android/asset_manager.h> 桩：以本地目录作为 assets 根
+// 未压缩存放的 asset 以 AASSET_MODE_BUFFER 打开时 mmap 整个文件，与 APK 中 noCompress 的 asset 相同；
+// 模拟压缩存放时 AAsset_getBuffer 把内容读到堆上，AAsset_isAllocated 返回 1
+#include <sys/types.h>
+#include <stddef.h>
+
+struct AAssetManager;
+struct AAsset;
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+
+enum {
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode);
+off_t AAsset_getLength(AAsset* asset);
+int AAsset_read(AAsset* asset, void* buf, size_t count);
+const void* AAsset_getBuffer(AAsset* asset);
+int AAsset_isAllocated(AAsset* asset);
+void AAsset_close(AAsset* asset);
+
+// 仅主机桩提供：root 为 assets 根目录，compressed 为 true 时模拟压缩存放
+AAssetManager* AAssetManager_createHost(const char* root, int compressed);
+void AAssetManager_destroyHost(AAssetManager* mgr);
+
+#ifdef __cplusplus
+}
+
+// 主机构建的 ncnn 不含 DataReaderFromAndroidAsset，此处按 AAsset_read 补上
+#include <ncnn/datareader.h>
+#if !(NCNN_PLATFORM_API && __ANDROID_API__ >= 9)
+namespace ncnn {
+class DataReaderFromAndroidAsset : public DataReader {
+public:
+    explicit DataReaderFromAndroidAsset(AAsset* _asset) : asset(_asset) {}
+
+    virtual size_t read(void* buf, size_t size) const {
+        int n = AAsset_read(asset, buf, size);
+        return n > 0 ? (size_t)n : 0;
+    }
+
+private:
+    AAsset* asset;
+};
+} // namespace ncnn
+#endif
+#endif
+
+#endif // ANDROID_ASSET_MANAGER_STUB_H
@@ -0,0 +1,7 @@
+#ifndef ANDROID_ASSET_MANAGER_JNI_STUB_H
+#define ANDROID_ASSET_MANAGER_JNI_STUB_H
+
+// 主机测试不经过 JNI，只转到 asset_manager.h 桩
+#include "asset_manager.h"
+
+#endif // ANDROID_ASSET_MANAGER_JNI_STUB_H
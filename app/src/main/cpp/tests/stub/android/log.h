@@ -0,0 +1,31 @@
+#ifndef ANDROID_LOG_STUB_H
+#define ANDROID_LOG_STUB_H
+
+// 主机测试用的 <android/log.h> 桩：WARN 及以上打印到 stderr，其余丢弃
+#include <stdarg.h>
+#include <stdio.h>
+
+enum {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+static inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) return 0;
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    int n = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return n;
+}
+
+#endif // ANDROID_LOG_STUB_H
@@ -0,0 +1,73 @@
+// 并行解码与单线程结果一致：随机 84x8400 输出，在不同线程数、候选上限、类别子集下
+// 比较候选集合（下标、分数）与还原后的 proposals 逐位相同
+#include <string.h>
+#include <vector>
+
+#include "yolov8_decode.h"
+#include "yolov8_fixture.h"
+
+static bool same_candidates(const std::vector<Candidate>& a, const std::vector<Candidate>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].index != b[i].index || memcmp(&a[i].score, &b[i].score, sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+static bool same_objects(const std::vector<Object>& a, const std::vector<Object>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].label != b[i].label || memcmp(&a[i].prob, &b[i].prob, sizeof(float)) != 0
+            || memcmp(&a[i].rect, &b[i].rect, sizeof(Object::Rect)) != 0)
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    const int num_class = 80;
+    const int thread_counts[] = {2, 3, 4, 8};
+    const int limits[] = {0, 1, 100, 1000};
+    const float hit_ratios[] = {0.f, 0.02f, 0.3f};
+    const int anchor_counts[] = {8400, 6300, 700, 100};  // 方形 640、矩形 640x480 与不足一块的情况
+    const LetterboxTransform tf = {0.75f, 0.f, 80.f};
+
+    std::vector<int> subset;
+    subset.push_back(67);
+    subset.push_back(0);
+    subset.push_back(39);
+    subset.push_back(39);  // 重复与乱序由 prepare_class_ids 整理
+    const std::vector<int> all_classes;
+
+    TestRng rng(12345);
+    ncnn::Mat out;
+    int cases = 0;
+    for (size_t a = 0; a < sizeof(anchor_counts) / sizeof(anchor_counts[0]); a++) {
+        for (size_t h = 0; h < sizeof(hit_ratios) / sizeof(hit_ratios[0]); h++) {
+            random_yolov8_output(out, num_class, anchor_counts[a], hit_ratios[h], rng);
+
+            for (int s = 0; s < 2; s++) {
+                const std::vector<int>& class_ids = s == 0 ? all_classes : subset;
+                for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+                    DecodeScratch ref_scratch;
+                    std::vector<Object> ref;
+                    decode_yolov8_output(out, 0.25f, class_ids, limits[l], tf, ref, ref_scratch, 1);
+                    if (limits[l] > 0) CHECK((int)ref.size() <= limits[l]);
+
+                    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+                        // 复用一个已被其他线程数用过的 scratch，thread_candidates 中的残留不应影响结果
+                        static DecodeScratch scratch;
+                        std::vector<Object> proposals;
+                        decode_yolov8_output(out, 0.25f, class_ids, limits[l], tf, proposals, scratch, thread_counts[t]);
+                        CHECK(same_candidates(scratch.candidates, ref_scratch.candidates));
+                        CHECK(same_objects(proposals, ref));
+                        cases++;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("decode: %d multi-threaded cases match single-threaded\n", cases);
+    return 0;
+}
@@ -0,0 +1,233 @@
+// Yolov8DetectionOutput 融合层与主机解码 + NMS 对比：
+// - fp32 / fp16、elempack 1 / 4 的 out0 输出与 decode_yolov8_output + suppress_bboxes 逐位一致
+// - det_param 逐帧覆盖阈值与类别
+// - roi 裁剪（pad 为负）时，融合层输出经 letterbox_to_image + clip_to_image 还原的结果
+//   与非融合路径直接按 tf 解码的结果一致，跨越裁剪边缘的框不被截短或平移
+// - release_scratch 与 forward 并发调用，释放后结果不变
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ncnn/option.h>
+#include <ncnn/paramdict.h>
+
+#include "nms.h"
+#include "yolov8_decode.h"
+#include "yolov8_layer.h"
+#include "yolov8_fixture.h"
+
+static const float kProbThreshold = 0.25f;
+static const float kNmsThreshold = 0.45f;
+static const int kMaxCandidates = 1000;
+static const int kMaxDetections = 300;
+
+// 把 h 行 fp32 输出重排为 elempack / elembits 指定的布局
+static ncnn::Mat pack_output(const ncnn::Mat& out, int elempack, int elembits) {
+    const size_t elemsize = (size_t)elembits / 8 * elempack;
+    ncnn::Mat packed(out.w, out.h / elempack, elemsize, elempack);
+    for (int g = 0; g < packed.h; g++) {
+        unsigned char* row = (unsigned char*)packed.data + (size_t)packed.w * elemsize * g;
+        for (int i = 0; i < out.w; i++) {
+            for (int l = 0; l < elempack; l++) {
+                const float v = out.row(g * elempack + l)[i];
+                if (elembits == 16) ((unsigned short*)row)[(size_t)i * elempack + l] = ncnn::float32_to_float16(v);
+                else ((float*)row)[(size_t)i * elempack + l] = v;
+            }
+        }
+    }
+    return packed;
+}
+
+// fp16 往返后的 fp32 输出，作为半精度输入的参考
+static ncnn::Mat round_fp16(const ncnn::Mat& out) {
+    ncnn::Mat r = out.clone();
+    float* p = r;
+    for (size_t i = 0; i < r.total(); i++) p[i] = ncnn::float16_to_float32(ncnn::float32_to_float16(p[i]));
+    return r;
+}
+
+// 参考实现：按 tf 解码，抑制后截断到 max_detections
+static void reference(const ncnn::Mat& out, const std::vector<int>& class_ids, const LetterboxTransform& tf,
+                      std::vector<Object>& objects) {
+    DecodeScratch scratch;
+    NmsWorkspace ws;
+    std::vector<Object> proposals;
+    decode_yolov8_output(out, kProbThreshold, class_ids, kMaxCandidates, tf, proposals, scratch, 1);
+    NmsParams params;
+    params.iou_threshold = kNmsThreshold;
+    params.score_threshold = kProbThreshold;
+    suppress_bboxes(proposals, objects, params, ws);
+    if ((int)objects.size() > kMaxDetections) objects.resize(kMaxDetections);
+}
+
+static int run_layer(const Yolov8DetectionOutput& layer, const ncnn::Mat& out, const ncnn::Mat& det_param,
+                     int num_threads, ncnn::Mat& dets) {
+    // 按输入个数一次建好，不在 push_back 中扩容（GCC 在 -O2 下对扩容路径误报 -Warray-bounds）
+    std::vector<ncnn::Mat> bottoms(det_param.empty() ? 1 : 2);
+    bottoms[0] = out;
+    if (!det_param.empty()) bottoms[1] = det_param;
+    std::vector<ncnn::Mat> tops(1);
+    ncnn::Option opt;
+    opt.num_threads = num_threads;
+    int ret = layer.forward(bottoms, tops, opt);
+    dets = tops[0];
+    return ret;
+}
+
+static void check_rows_exact(const ncnn::Mat& dets, const std::vector<Object>& expected) {
+    CHECK(dets.h == (int)expected.size() || (dets.empty() && expected.empty()));
+    for (int i = 0; i < dets.h; i++) {
+        const float* row = dets.row(i);
+        const Object& o = expected[i];
+        CHECK((int)row[0] == o.label);
+        CHECK(row[1] == o.prob);
+        CHECK(row[2] == o.rect.x && row[3] == o.rect.y);
+        CHECK(row[4] == o.rect.x + o.rect.width && row[5] == o.rect.y + o.rect.height);
+    }
+}
+
+static bool close(float a, float b) {
+    return fabsf(a - b) <= 1e-3f * (1.f + fabsf(b));
+}
+
+int main() {
+    Yolov8DetectionOutput layer;
+    {
+        ncnn::ParamDict pd;
+        pd.set(0, kProbThreshold);
+        pd.set(1, kNmsThreshold);
+        pd.set(2, kMaxCandidates);
+        pd.set(3, kMaxDetections);
+        CHECK(layer.load_param(pd) == 0);
+    }
+
+    TestRng rng(606);
+    ncnn::Mat out;
+    random_yolov8_output(out, 80, 8400, 0.02f, rng);
+    const LetterboxTransform identity = {1.f, 0.f, 0.f};
+    const std::vector<int> all_classes;
+
+    // 各种存储布局，网络输入坐标逐位一致；fp16 以往返后的 fp32 为参考
+    const int packs[2] = {1, 4};
+    const int bits[2] = {32, 16};
+    for (int b = 0; b < 2; b++) {
+        const ncnn::Mat ref_out = bits[b] == 16 ? round_fp16(out) : out;
+        std::vector<Object> expected;
+        reference(ref_out, all_classes, identity, expected);
+        CHECK(!expected.empty());
+
+        for (int p = 0; p < 2; p++) {
+            const ncnn::Mat in = pack_output(out, packs[p], bits[b]);
+            for (int nt = 1; nt <= 4; nt += 3) {
+                ncnn::Mat dets;
+                CHECK(run_layer(layer, in, ncnn::Mat(), nt, dets) == 0);
+                check_rows_exact(dets, expected);
+            }
+        }
+    }
+
+    // det_param 覆盖阈值与类别
+    {
+        std::vector<int> subset;
+        subset.push_back(2);
+        subset.push_back(0);
+        ncnn::Mat det_param(YOLOV8_DET_PARAM_HEADER + 2);
+        float* p = det_param;
+        p[0] = kProbThreshold;
+        p[1] = kNmsThreshold;
+        p[2] = kMaxCandidates;
+        p[3] = kMaxDetections;
+        p[4] = NMS_HARD;
+        p[5] = 0.5f;
+        p[6] = 2;
+        p[7] = 0;
+
+        std::vector<Object> expected;
+        reference(out, subset, identity, expected);
+        ncnn::Mat dets;
+        CHECK(run_layer(layer, out, det_param, 1, dets) == 0);
+        check_rows_exact(dets, expected);
+        for (int i = 0; i < dets.h; i++) CHECK((int)dets.row(i)[0] == 0 || (int)dets.row(i)[0] == 2);
+    }
+
+    // roi 裁剪：原图 (200, 120) 起的区域缩放 0.5 送入网络，pad 为负
+    {
+        const LetterboxTransform roi = {0.5f, -100.f, -60.f};
+
+        std::vector<Object> expected;
+        reference(out, all_classes, roi, expected);
+        for (size_t i = 0; i < expected.size(); i++) clip_to_image(expected[i]);
+
+        ncnn::Mat dets;
+        CHECK(run_layer(layer, out, ncnn::Mat(), 1, dets) == 0);
+        CHECK(dets.h == (int)expected.size());
+        int crossing = 0;
+        for (int i = 0; i < dets.h; i++) {
+            const float* row = dets.row(i);
+            if (row[2] < 0.f || row[3] < 0.f) crossing++;
+
+            Object o;
+            letterbox_to_image(row[2], row[3], row[4], row[5], roi, o);
+            clip_to_image(o);
+            CHECK((int)row[0] == expected[i].label && row[1] == expected[i].prob);
+            CHECK(close(o.rect.x, expected[i].rect.x) && close(o.rect.y, expected[i].rect.y));
+            CHECK(close(o.rect.width, expected[i].rect.width) && close(o.rect.height, expected[i].rect.height));
+        }
+        // 随机框中需有跨越裁剪边缘的，否则没有覆盖到该情况
+        CHECK(crossing > 0);
+    }
+
+    // 单个跨越裁剪左边缘的框：网络坐标 x0 = -20 在原图中仍在图内，宽度应完整保留
+    {
+        ncnn::Mat one(1, 84);
+        one.fill(0.f);
+        one.row(0)[0] = 10.f;
+        one.row(1)[0] = 300.f;
+        one.row(2)[0] = 60.f;
+        one.row(3)[0] = 40.f;
+        one.row(4)[0] = 0.9f;
+
+        ncnn::Mat dets;
+        CHECK(run_layer(layer, one, ncnn::Mat(), 1, dets) == 0);
+        CHECK(dets.h == 1);
+        CHECK(dets.row(0)[2] == -20.f);
+
+        const LetterboxTransform roi = {0.5f, -100.f, -60.f};
+        Object o;
+        letterbox_to_image(dets.row(0)[2], dets.row(0)[3], dets.row(0)[4], dets.row(0)[5], roi, o);
+        clip_to_image(o);
+        CHECK(o.rect.x == 160.f && o.rect.width == 120.f);
+        CHECK(o.rect.y == 680.f && o.rect.height == 80.f);
+
+        // 原图左边缘之外的部分才截断
+        const LetterboxTransform full = {0.5f, 0.f, 0.f};
+        letterbox_to_image(dets.row(0)[2], dets.row(0)[3], dets.row(0)[4], dets.row(0)[5], full, o);
+        clip_to_image(o);
+        CHECK(o.rect.x == 0.f && o.rect.width == 80.f);
+    }
+
+    // trim 释放空闲缓冲后结果不变；与其他线程上的 forward 交错调用，正在使用的缓冲不受影响
+    {
+        std::vector<Object> expected;
+        reference(out, all_classes, identity, expected);
+        std::atomic<bool> done(false);
+        std::thread worker([&]() {
+            for (int i = 0; i < 20; i++) {
+                ncnn::Mat dets;
+                CHECK(run_layer(layer, out, ncnn::Mat(), 2, dets) == 0);
+                check_rows_exact(dets, expected);
+            }
+            done = true;
+        });
+        while (!done.load()) layer.release_scratch();
+        worker.join();
+
+        layer.release_scratch();
+        ncnn::Mat dets;
+        CHECK(run_layer(layer, out, ncnn::Mat(), 1, dets) == 0);
+        check_rows_exact(dets, expected);
+    }
+
+    printf("detection output: layer matches host decode + nms\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+// nms_bboxes / suppress_bboxes(NMS_HARD) 与暴力贪心 NMS 逐个比较保留结果
+// 暴力版本：全部框按 (分数降序, 下标升序) 排序，依次与所有已保留的同类框计算 IoU
+#include <algorithm>
+#include <vector>
+
+#include "nms.h"
+#include "test_util.h"
+
+static float brute_iou(const Object& a, const Object& b) {
+    float inter_left = std::max(a.rect.x, b.rect.x);
+    float inter_top = std::max(a.rect.y, b.rect.y);
+    float inter_right = std::min(a.rect.x + a.rect.width, b.rect.x + b.rect.width);
+    float inter_bottom = std::min(a.rect.y + a.rect.height, b.rect.y + b.rect.height);
+    float inter = inter_right < inter_left || inter_bottom < inter_top ? 0.f : (inter_right - inter_left) * (inter_bottom - inter_top);
+    float uni = a.rect.width * a.rect.height + b.rect.width * b.rect.height - inter;
+    return uni > 0.f ? inter / uni : 0.f;
+}
+
+static void brute_nms(const std::vector<Object>& objects, float threshold, std::vector<int>& picked) {
+    std::vector<int> order(objects.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&objects](int a, int b) {
+        if (objects[a].prob != objects[b].prob) return objects[a].prob > objects[b].prob;
+        return a < b;
+    });
+
+    picked.clear();
+    for (size_t k = 0; k < order.size(); k++) {
+        const Object& a = objects[order[k]];
+        bool keep = true;
+        for (size_t p = 0; p < picked.size() && keep; p++) {
+            const Object& b = objects[picked[p]];
+            if (a.label == b.label && brute_iou(a, b) > threshold) keep = false;
+        }
+        if (keep) picked.push_back(order[k]);
+    }
+}
+
+// 随机框：围绕少量簇中心抖动以产生大量重叠，夹杂零面积框、完全重复的框与并列分数
+static void random_boxes(std::vector<Object>& objects, int n, int num_class, TestRng& rng) {
+    const int num_clusters = std::max(1, n / 20);
+    std::vector<float> cx(num_clusters), cy(num_clusters);
+    for (int c = 0; c < num_clusters; c++) {
+        cx[c] = rng.uniform(0.f, 1920.f);
+        cy[c] = rng.uniform(0.f, 1080.f);
+    }
+
+    objects.resize(n);
+    for (int i = 0; i < n; i++) {
+        Object& o = objects[i];
+        const int c = rng.below(num_clusters);
+        o.rect.width = rng.below(32) == 0 ? 0.f : rng.uniform(8.f, 400.f);
+        o.rect.height = rng.uniform(8.f, 400.f);
+        o.rect.x = cx[c] + rng.uniform(-40.f, 40.f) - o.rect.width * 0.5f;
+        o.rect.y = cy[c] + rng.uniform(-40.f, 40.f) - o.rect.height * 0.5f;
+        o.label = rng.below(num_class);
+        o.prob = (float)(rng.below(200) + 50) / 256.f;  // 离散分数，制造并列
+        if (i > 0 && rng.below(16) == 0) o = objects[rng.below(i)];
+    }
+}
+
+int main() {
+    TestRng rng(7);
+    NmsWorkspace ws;
+    std::vector<Object> objects, results;
+    std::vector<int> picked, expected;
+
+    const int sizes[] = {0, 1, 2, 17, 100, 1000, 4000};
+    const float thresholds[] = {0.f, 0.3f, 0.45f, 0.7f, 1.f};
+    const int classes[] = {1, 3, 80};
+    int cases = 0;
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); si++) {
+        for (size_t ci = 0; ci < sizeof(classes) / sizeof(classes[0]); ci++) {
+            for (size_t ti = 0; ti < sizeof(thresholds) / sizeof(thresholds[0]); ti++) {
+                random_boxes(objects, sizes[si], classes[ci], rng);
+
+                // 同一 workspace 跨多次调用复用，顺带检查残留状态不影响结果
+                nms_bboxes(objects, picked, thresholds[ti], ws);
+                brute_nms(objects, thresholds[ti], expected);
+                CHECK(picked == expected);
+
+                NmsParams params;
+                params.mode = NMS_HARD;
+                params.iou_threshold = thresholds[ti];
+                suppress_bboxes(objects, results, params, ws);
+                CHECK(results.size() == expected.size());
+                for (size_t k = 0; k < expected.size(); k++) {
+                    const Object& a = results[k];
+                    const Object& b = objects[expected[k]];
+                    CHECK(a.label == b.label && a.prob == b.prob);
+                    CHECK(a.rect.x == b.rect.x && a.rect.y == b.rect.y);
+                    CHECK(a.rect.width == b.rect.width && a.rect.height == b.rect.height);
+                }
+                cases++;
+            }
+        }
+    }
+
+    printf("nms: %d cases match brute force\n", cases);
+    return 0;
+}
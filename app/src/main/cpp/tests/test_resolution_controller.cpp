@@ -0,0 +1,129 @@
+// ResolutionController 在注入的假时钟上运行：帧耗时按输入边长的像素数模拟，
+// 检查降档、收敛不振荡、冷却间隔、恢复升档、关闭调节与预算变化
+#include <vector>
+
+#include "resolution_controller.h"
+#include "test_util.h"
+
+static double g_now_ms = 0.0;
+
+static double fake_clock() {
+    return g_now_ms;
+}
+
+static std::vector<ResolutionDecision> g_decisions;
+
+static void record_decision(void*, const ResolutionDecision& d) {
+    g_decisions.push_back(d);
+}
+
+// 模拟设备：单帧耗时与像素数成正比，640 时为 ms_at_640
+static float frame_latency(int size, float ms_at_640) {
+    const float r = size / 640.f;
+    return ms_at_640 * r * r;
+}
+
+// 按帧耗时推进时钟并喂给控制器，返回最后的输入边长
+static int run_frames(ResolutionController& rc, int frames, float ms_at_640) {
+    for (int i = 0; i < frames; i++) {
+        const double begin = rc.now();
+        g_now_ms += frame_latency(rc.input_size(), ms_at_640);
+        rc.frame_end(begin);
+    }
+    return rc.input_size();
+}
+
+static void reset(ResolutionController& rc) {
+    g_now_ms = 0.0;
+    g_decisions.clear();
+    rc.set_listener(record_decision, 0);
+}
+
+int main() {
+    // 预算为 0：固定 640，不切换
+    {
+        ResolutionController rc(0.f, fake_clock);
+        reset(rc);
+        CHECK(run_frames(rc, 300, 200.f) == 640);
+        CHECK(g_decisions.empty());
+    }
+
+    // 640 需 60 ms、预算 33 ms：512 仍超出（38.4 ms），应停在 416（25.3 ms）；
+    // 416 升到 512 的估算超出预算，之后不再来回切换
+    {
+        ResolutionController rc(33.f, fake_clock);
+        reset(rc);
+        CHECK(run_frames(rc, 600, 60.f) == 416);
+        CHECK(g_decisions.size() == 2);
+        CHECK(g_decisions[0].from == 640 && g_decisions[0].to == 512);
+        CHECK(g_decisions[1].from == 512 && g_decisions[1].to == 416);
+        // 两次切换至少间隔冷却时间
+        CHECK(g_decisions[1].time_ms - g_decisions[0].time_ms >= rc.cooldown_ms);
+        for (size_t i = 0; i < g_decisions.size(); i++) CHECK(g_decisions[i].latency_ms > 33.f);
+
+        // 设备降温后 640 只需 20 ms：逐档升回 640
+        g_decisions.clear();
+        CHECK(run_frames(rc, 1200, 20.f) == 640);
+        CHECK(g_decisions.size() == 2);
+        CHECK(g_decisions[0].to == 512 && g_decisions[1].to == 640);
+        CHECK(g_decisions[1].time_ms - g_decisions[0].time_ms >= rc.cooldown_ms);
+    }
+
+    // 极慢的设备降到最小档后停住
+    {
+        ResolutionController rc(33.f, fake_clock);
+        reset(rc);
+        CHECK(run_frames(rc, 1000, 500.f) == 320);
+        CHECK(g_decisions.size() == 3);
+        CHECK(g_decisions.back().to == 320);
+    }
+
+    // 偶发的单帧尖峰不足以触发降档
+    {
+        ResolutionController rc(33.f, fake_clock);
+        reset(rc);
+        for (int i = 0; i < 300; i++) {
+            const double begin = rc.now();
+            g_now_ms += i % 50 == 0 ? 45.f : frame_latency(rc.input_size(), 20.f);
+            rc.frame_end(begin);
+        }
+        CHECK(rc.input_size() == 640);
+        CHECK(g_decisions.empty());
+    }
+
+    // 关闭调节：立即回到 640，期间不论耗时都不降档；重新开启后从 640 重新调节
+    {
+        ResolutionController rc(33.f, fake_clock);
+        reset(rc);
+        CHECK(run_frames(rc, 600, 60.f) == 416);
+        rc.set_enabled(false);
+        CHECK(rc.input_size() == 640);
+        const size_t switches = g_decisions.size();
+        CHECK(run_frames(rc, 300, 60.f) == 640);
+        // 只有关闭时回到 640 的那一次
+        CHECK(g_decisions.size() == switches + 1 && g_decisions.back().to == 640);
+
+        rc.set_enabled(true);
+        g_decisions.clear();
+        CHECK(run_frames(rc, 600, 60.f) == 416);
+        CHECK(g_decisions.size() == 2 && g_decisions[0].from == 640);
+    }
+
+    // 预算放宽后升回 640；预算改为 0 时立即回到 640
+    {
+        ResolutionController rc(33.f, fake_clock);
+        reset(rc);
+        CHECK(run_frames(rc, 600, 60.f) == 416);
+        rc.set_budget(100.f);
+        CHECK(run_frames(rc, 1200, 60.f) == 640);
+
+        rc.set_budget(33.f);
+        CHECK(run_frames(rc, 600, 60.f) == 416);
+        rc.set_budget(0.f);
+        CHECK(rc.input_size() == 640);
+        CHECK(run_frames(rc, 10, 60.f) == 640);
+    }
+
+    printf("resolution controller ok\n");
+    return 0;
+}
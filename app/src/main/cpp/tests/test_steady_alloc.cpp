@@ -0,0 +1,265 @@
+// 稳态下后处理不再分配内存：替换 malloc / posix_memalign 等计数，
+// 预热若干帧后，letterbox、解码、检测头拼接、NMS 与融合层 forward 在每帧上的分配次数应为 0
+// 只在 glibc 上构建（转发到 __libc_*），sanitizer 构建时不加入
+#include <errno.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ncnn/option.h>
+#include <ncnn/paramdict.h>
+
+#include "letterbox.h"
+#include "nms.h"
+#include "yolov8_decode.h"
+#include "yolov8_layer.h"
+#include "yolov8_fixture.h"
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<bool> g_counting(false);
+static std::atomic<int> g_allocs(0);
+static std::atomic<int> g_frees(0);
+
+static inline void count_alloc() {
+    if (g_counting.load(std::memory_order_relaxed)) g_allocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* malloc(size_t size) {
+    count_alloc();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    count_alloc();
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    count_alloc();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t align, size_t size) {
+    count_alloc();
+    return __libc_memalign(align, size);
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+    count_alloc();
+    return __libc_memalign(align, size);
+}
+
+void free(void* ptr) {
+    if (ptr && g_counting.load(std::memory_order_relaxed)) g_frees.fetch_add(1, std::memory_order_relaxed);
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** ptr, size_t align, size_t size) {
+    count_alloc();
+    void* p = __libc_memalign(align, size);
+    if (!p) return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+}
+
+// 模拟 Extractor 的 blob_allocator：释放的块留作下次使用
+class CachingAllocator : public ncnn::Allocator {
+public:
+    virtual ~CachingAllocator() {
+        for (size_t i = 0; i < blocks.size(); i++) ncnn::fastFree(blocks[i].ptr);
+    }
+
+    virtual void* fastMalloc(size_t size) {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (!blocks[i].used && blocks[i].size >= size) {
+                blocks[i].used = true;
+                return blocks[i].ptr;
+            }
+        }
+        Block b = {ncnn::fastMalloc(size), size, true};
+        blocks.push_back(b);
+        return b.ptr;
+    }
+
+    virtual void fastFree(void* ptr) {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (blocks[i].ptr == ptr) blocks[i].used = false;
+        }
+    }
+
+private:
+    struct Block {
+        void* ptr;
+        size_t size;
+        bool used;
+    };
+    std::vector<Block> blocks;
+};
+
+// 一帧完整的后处理，与 Yolov8::detect_letterboxed 中非融合、融合两条路径相同
+struct Frame {
+    LetterboxScratch letterbox_scratch;
+    ncnn::Mat in_pad;
+    DecodeScratch decode_scratch;
+    ncnn::Mat assembled;
+    std::vector<Object> proposals;
+    std::vector<Object> objects;
+    NmsWorkspace nms_ws;
+    // tops 中的 Mat 析构时经 blob_allocator 归还，分配器须先于它们声明、后于它们析构
+    CachingAllocator blob_allocator;
+    std::vector<ncnn::Mat> bottoms;
+    std::vector<ncnn::Mat> tops;
+};
+
+static void run_frame(Frame& f, const std::vector<unsigned char>& rgba, const ncnn::Mat& out,
+                      const std::vector<ncnn::Mat>& heads, const Yolov8DetectionOutput& layer, int num_threads,
+                      int nms_mode) {
+    int wpad, hpad;
+    letterbox_normalize(&rgba[0], 640, 480, 640 * 4, 4, 640, 480, 640, 640, 114.f, 1 / 255.f, f.in_pad, &wpad, &hpad,
+                        f.letterbox_scratch, num_threads);
+    const LetterboxTransform tf = {1.f, (float)wpad, (float)hpad};
+    const std::vector<int> all_classes;
+
+    f.proposals.clear();
+    decode_yolov8_output(out, 0.25f, all_classes, 1000, tf, f.proposals, f.decode_scratch, num_threads);
+    NmsParams params;
+    params.mode = nms_mode;
+    params.score_threshold = 0.25f;
+    suppress_bboxes(f.proposals, f.objects, params, f.nms_ws);
+
+    // 矩形推理路径：检测头输出拼成 out0 布局后解码
+    const int strides[3] = {8, 16, 32};
+    assemble_head_output(heads, strides, all_classes, f.assembled, f.decode_scratch, num_threads);
+    f.proposals.clear();
+    decode_yolov8_output(f.assembled, 0.25f, all_classes, 1000, tf, f.proposals, f.decode_scratch, num_threads);
+    suppress_bboxes(f.proposals, f.objects, params, f.nms_ws);
+
+    // 融合层：与 Extractor 一样每帧拿到新的 top blob
+    f.bottoms[0] = out;
+    f.tops[0].release();
+    ncnn::Option opt;
+    opt.num_threads = num_threads;
+    opt.blob_allocator = &f.blob_allocator;
+    CHECK(layer.forward(f.bottoms, f.tops, opt) == 0);
+}
+
+static const int num_outs = 4;
+
+// 一种抑制方式下检查全部场景，融合层与逐级后处理用同一方式
+static void check_mode(int nms_mode, const std::vector<unsigned char>& rgba, const ncnn::Mat* outs,
+                       const std::vector<ncnn::Mat>& heads) {
+    Yolov8DetectionOutput layer;
+    ncnn::ParamDict pd;
+    pd.set(5, nms_mode);
+    CHECK(layer.load_param(pd) == 0);
+
+    const int thread_counts[2] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        Frame f;
+        f.bottoms.resize(1);
+        f.tops.resize(1);
+        for (int i = 0; i < num_outs * 4; i++)
+            run_frame(f, rgba, outs[i % num_outs], heads, layer, thread_counts[t], nms_mode);
+
+        g_allocs = 0;
+        g_counting = true;
+        for (int i = 0; i < num_outs * 8; i++)
+            run_frame(f, rgba, outs[i % num_outs], heads, layer, thread_counts[t], nms_mode);
+        g_counting = false;
+
+        printf("nms mode %d, %d threads: %d allocations in %d steady-state frames\n", nms_mode, thread_counts[t],
+               g_allocs.load(), num_outs * 8);
+        CHECK(g_allocs.load() == 0);
+    }
+
+    // 融合层的缓冲归层所有而非按线程持有：每帧换一个新线程调用 forward（如 Kotlin 的 IO 线程池）也不再分配
+    {
+        Frame f;
+        f.bottoms.resize(1);
+        f.tops.resize(1);
+        for (int i = 0; i < num_outs * 4; i++) run_frame(f, rgba, outs[i % num_outs], heads, layer, 1, nms_mode);
+
+        g_allocs = 0;
+        for (int i = 0; i < num_outs * 2; i++) {
+            std::thread worker([&]() {
+                f.bottoms[0] = outs[i % num_outs];
+                f.tops[0].release();
+                ncnn::Option opt;
+                opt.num_threads = 1;
+                opt.blob_allocator = &f.blob_allocator;
+                g_counting = true;
+                int ret = layer.forward(f.bottoms, f.tops, opt);
+                g_counting = false;
+                CHECK(ret == 0);
+            });
+            worker.join();
+        }
+        printf("nms mode %d, fresh threads: %d allocations in %d layer forwards\n", nms_mode, g_allocs.load(), num_outs * 2);
+        CHECK(g_allocs.load() == 0);
+    }
+
+    // trim 时释放融合层的空闲缓冲；之后的第一帧重新分配，再次预热后又回到无分配
+    {
+        Frame f;
+        f.bottoms.resize(1);
+        f.tops.resize(1);
+        for (int i = 0; i < num_outs * 4; i++) run_frame(f, rgba, outs[i % num_outs], heads, layer, 4, nms_mode);
+
+        g_frees = 0;
+        g_counting = true;
+        layer.release_scratch();
+        g_counting = false;
+        printf("nms mode %d, release scratch: %d blocks freed\n", nms_mode, g_frees.load());
+        CHECK(g_frees.load() > 0);
+
+        g_allocs = 0;
+        g_counting = true;
+        run_frame(f, rgba, outs[num_outs - 1], heads, layer, 4, nms_mode);
+        g_counting = false;
+        CHECK(g_allocs.load() > 0);
+
+        for (int i = 0; i < num_outs * 4; i++) run_frame(f, rgba, outs[i % num_outs], heads, layer, 4, nms_mode);
+        g_allocs = 0;
+        g_counting = true;
+        for (int i = 0; i < num_outs * 8; i++) run_frame(f, rgba, outs[i % num_outs], heads, layer, 4, nms_mode);
+        g_counting = false;
+        printf("nms mode %d, after release: %d allocations in %d steady-state frames\n", nms_mode, g_allocs.load(),
+               num_outs * 8);
+        CHECK(g_allocs.load() == 0);
+    }
+}
+
+int main() {
+    TestRng rng(1414);
+    std::vector<unsigned char> rgba(640 * 480 * 4);
+    for (size_t i = 0; i < rgba.size(); i++) rgba[i] = (unsigned char)rng.below(256);
+
+    // 候选数各不相同的几帧轮流输入，预热后各缓冲都已达到最大容量
+    const float hit_ratios[num_outs] = {0.001f, 0.05f, 0.01f, 0.2f};
+    ncnn::Mat outs[num_outs];
+    for (int i = 0; i < num_outs; i++) random_yolov8_output(outs[i], 80, 8400, hit_ratios[i], rng);
+
+    std::vector<ncnn::Mat> heads(3);
+    const int sizes[3] = {80, 40, 20};
+    for (int l = 0; l < 3; l++) {
+        heads[l].create(sizes[l], sizes[l] * 3 / 4, 4 * kDflBins + 80);
+        for (int q = 0; q < heads[l].c; q++) {
+            float* p = heads[l].channel(q);
+            for (int i = 0; i < heads[l].w * heads[l].h; i++) p[i] = rng.uniform(-6.f, 2.f);
+        }
+    }
+
+    // 每种抑制方式都检查：Soft-NMS / WBF 的输出重排不能每帧申请临时缓冲
+    const int nms_modes[4] = {NMS_HARD, NMS_SOFT_LINEAR, NMS_SOFT_GAUSSIAN, NMS_WBF};
+    for (int m = 0; m < 4; m++) check_mode(nms_modes[m], rgba, outs, heads);
+    return 0;
+}
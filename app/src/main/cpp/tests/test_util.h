@@ -0,0 +1,48 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+// 主机测试的公共工具：断言、固定种子的随机数、计时
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// 失败时打印位置并以非 0 退出，交给 ctest 判定
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                            \
+        }                                                                       \
+    } while (0)
+
+// xorshift32，各平台结果一致，便于复现
+struct TestRng {
+    unsigned int state;
+
+    explicit TestRng(unsigned int seed) : state(seed ? seed : 1u) {}
+
+    unsigned int next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // [lo, hi) 内的均匀浮点数
+    float uniform(float lo, float hi) {
+        return lo + (hi - lo) * (float)(next() >> 8) * (1.f / 16777216.f);
+    }
+
+    // [0, n) 内的整数
+    int below(int n) {
+        return (int)(next() % (unsigned int)n);
+    }
+};
+
+static inline double test_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,294 @@
+// Yolov8Pool 的换代、按调用方分开的模型、阻塞 acquire 与 trim，Yolov8 由 yolov8_stub.cpp 代替
+// 最后多线程并发检测、换模型与 trim，配合 YOLOV8NCNN_SANITIZE=thread / address 检查竞争与释放后使用
+#include <sched.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yolov8_pool.h"
+#include "test_util.h"
+
+extern std::atomic<int> stub_live_detectors;
+extern std::atomic<int> stub_peak_detectors;
+
+static const int num_workers = 2;
+
+static int load(Yolov8Pool& pool, int caller, const char* model) {
+    const std::string param = std::string(model) + ".param";
+    const std::string bin = std::string(model) + ".bin";
+    return pool.load(caller, 0, param.c_str(), bin.c_str(), num_workers);
+}
+
+// 取一个实例检测一次，返回模型的标记字符，失败返回 0
+static int detect_label(Yolov8* detector) {
+    std::vector<Object> objects;
+    if (!detector || detector->detect(0, 0, 0, 0, objects, 0.25f) != 0 || objects.size() != 1) return 0;
+    return objects[0].label;
+}
+
+static int detect_label(Yolov8Pool& pool, int caller) {
+    Yolov8PoolGuard detector(pool, caller);
+    return detect_label(detector.get());
+}
+
+// 等到池中有 n 个线程进入等待：它们已确认取不到实例（或旧一代未释放），在池被唤醒之前不会返回
+static void wait_for_waiters(const Yolov8Pool& pool, int n) {
+    while (pool.waiting() < n) sched_yield();
+}
+
+static void test_callers() {
+    Yolov8Pool pool;
+    CHECK(pool.acquire(CALLER_INTERACTIVE) == 0);
+    CHECK(pool.try_acquire(CALLER_BACKGROUND) == 0);
+    CHECK(pool.trim(TRIM_WEIGHTS) == -1);
+    CHECK(pool.load_stats(CALLER_INTERACTIVE).load_ms == 0.0);
+
+    // 两个调用方加载不同模型，各自一代，互不替换
+    CHECK(load(pool, CALLER_INTERACTIVE, "a") == 0);
+    CHECK(pool.acquire(CALLER_BACKGROUND) == 0);
+    CHECK(load(pool, CALLER_BACKGROUND, "b") == 0);
+    CHECK(stub_live_detectors.load() == 2 * num_workers);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'a');
+    CHECK(detect_label(pool, CALLER_BACKGROUND) == 'b');
+    CHECK(pool.load_stats(CALLER_BACKGROUND).load_ms == 1.0);
+
+    // 重复加载同一模型不换代
+    CHECK(load(pool, CALLER_BACKGROUND, "b") == 0);
+    CHECK(stub_live_detectors.load() == 2 * num_workers);
+
+    // 加载另一方已有的模型时共用其实例，原先的一代空闲，随即释放
+    CHECK(load(pool, CALLER_BACKGROUND, "a") == 0);
+    CHECK(stub_live_detectors.load() == num_workers);
+    CHECK(detect_label(pool, CALLER_BACKGROUND) == 'a');
+
+    // 共用后一方换模型，另一方保持
+    CHECK(load(pool, CALLER_INTERACTIVE, "c") == 0);
+    CHECK(stub_live_detectors.load() == 2 * num_workers);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'c');
+    CHECK(detect_label(pool, CALLER_BACKGROUND) == 'a');
+
+    // 加载失败时保留当前一代
+    CHECK(load(pool, CALLER_INTERACTIVE, "missing") == -1);
+    CHECK(stub_live_detectors.load() == 2 * num_workers);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'c');
+}
+
+static void test_blocking_acquire() {
+    Yolov8Pool pool;
+    CHECK(load(pool, CALLER_INTERACTIVE, "a") == 0);
+    CHECK(load(pool, CALLER_BACKGROUND, "a") == 0);
+
+    // 后台名额为 1：第二个 acquire 阻塞到第一个归还
+    {
+        Yolov8* held = pool.acquire(CALLER_BACKGROUND);
+        CHECK(held);
+        CHECK(pool.try_acquire(CALLER_BACKGROUND) == 0);
+        std::atomic<bool> done(false);
+        Yolov8* second = 0;
+        std::thread waiter([&]() {
+            second = pool.acquire(CALLER_BACKGROUND);
+            done = true;
+        });
+        wait_for_waiters(pool, 1);
+        CHECK(!done.load());
+        pool.release(held, CALLER_BACKGROUND);
+        waiter.join();
+        CHECK(done.load());
+        CHECK(second);
+        pool.release(second, CALLER_BACKGROUND);
+    }
+
+    // 实例全被占用：阻塞到有实例归还
+    {
+        pool.set_caller_limit(CALLER_BACKGROUND, 0);
+        Yolov8* held[num_workers];
+        for (int i = 0; i < num_workers; i++) {
+            held[i] = pool.acquire(i == 0 ? CALLER_BACKGROUND : CALLER_INTERACTIVE);
+            CHECK(held[i]);
+        }
+        std::atomic<bool> done(false);
+        Yolov8* extra = 0;
+        std::thread waiter([&]() {
+            extra = pool.acquire(CALLER_INTERACTIVE);
+            done = true;
+        });
+        wait_for_waiters(pool, 1);
+        CHECK(!done.load());
+        pool.release(held[0], CALLER_BACKGROUND);
+        waiter.join();
+        CHECK(done.load());
+        CHECK(extra == held[0]);
+        pool.release(extra, CALLER_INTERACTIVE);
+        for (int i = 1; i < num_workers; i++) pool.release(held[i], CALLER_INTERACTIVE);
+    }
+
+    // 放宽名额唤醒等待者
+    {
+        pool.set_caller_limit(CALLER_BACKGROUND, 1);
+        Yolov8* held = pool.acquire(CALLER_BACKGROUND);
+        std::atomic<bool> done(false);
+        Yolov8* second = 0;
+        std::thread waiter([&]() {
+            second = pool.acquire(CALLER_BACKGROUND);
+            done = true;
+        });
+        wait_for_waiters(pool, 1);
+        CHECK(!done.load());
+        pool.set_caller_limit(CALLER_BACKGROUND, 2);
+        waiter.join();
+        CHECK(done.load());
+        CHECK(second && second != held);
+        pool.release(second, CALLER_BACKGROUND);
+        pool.release(held, CALLER_BACKGROUND);
+    }
+
+    // 等在已占满的旧一代上的 acquire 在换代后从新一代取到实例
+    {
+        Yolov8* held[num_workers];
+        for (int i = 0; i < num_workers; i++) held[i] = pool.acquire(CALLER_INTERACTIVE);
+        std::atomic<bool> done(false);
+        int label = 0;
+        std::thread waiter([&]() {
+            Yolov8* detector = pool.acquire(CALLER_INTERACTIVE);
+            label = detect_label(detector);
+            done = true;
+            pool.release(detector, CALLER_INTERACTIVE);
+        });
+        wait_for_waiters(pool, 1);
+        CHECK(!done.load());
+        CHECK(load(pool, CALLER_INTERACTIVE, "b") == 0);
+        waiter.join();
+        CHECK(done.load());
+        CHECK(label == 'b');
+        for (int i = 0; i < num_workers; i++) pool.release(held[i], CALLER_INTERACTIVE);
+    }
+
+    // 流水线停止：running 置 false 并唤醒后，阻塞中的 acquire 返回 0，不再等实例归还
+    {
+        Yolov8* held[num_workers];
+        for (int i = 0; i < num_workers; i++) held[i] = pool.acquire(CALLER_INTERACTIVE);
+        std::atomic<bool> running(true);
+        Yolov8* extra = held[0];
+        std::thread waiter([&]() { extra = pool.acquire(CALLER_INTERACTIVE, &running); });
+        wait_for_waiters(pool, 1);
+        running = false;
+        pool.notify_waiters();
+        waiter.join();
+        CHECK(extra == 0);
+        for (int i = 0; i < num_workers; i++) pool.release(held[i], CALLER_INTERACTIVE);
+    }
+}
+
+static void test_generations() {
+    Yolov8Pool pool;
+    CHECK(load(pool, CALLER_INTERACTIVE, "a") == 0);
+
+    // 换代后已取出的旧实例照常推理，归还后旧一代释放
+    Yolov8* old = pool.acquire(CALLER_INTERACTIVE);
+    CHECK(load(pool, CALLER_INTERACTIVE, "b") == 0);
+    CHECK(stub_live_detectors.load() == 2 * num_workers);
+    CHECK(detect_label(old) == 'a');
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'b');
+
+    // 旧一代仍在推理时，再次换代等它归还，同时最多存在新旧两代加正在建立的一代
+    std::atomic<bool> done(false);
+    std::thread loader([&]() {
+        CHECK(load(pool, CALLER_INTERACTIVE, "c") == 0);
+        done = true;
+    });
+    wait_for_waiters(pool, 1);
+    CHECK(!done.load());
+    CHECK(stub_live_detectors.load() == 3 * num_workers);
+    pool.release(old, CALLER_INTERACTIVE);
+    loader.join();
+    CHECK(done.load());
+    CHECK(stub_live_detectors.load() == num_workers);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'c');
+}
+
+static void test_trim() {
+    Yolov8Pool pool;
+    CHECK(load(pool, CALLER_INTERACTIVE, "a") == 0);
+    CHECK(load(pool, CALLER_BACKGROUND, "b") == 0);
+
+    // 全部空闲时卸载网络，下一次取出时重建
+    CHECK(pool.trim(TRIM_WEIGHTS) == TRIM_WEIGHTS);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'a');
+    CHECK(detect_label(pool, CALLER_BACKGROUND) == 'b');
+
+    // 一代中有实例在推理时该代只释放缓冲
+    Yolov8* held = pool.acquire(CALLER_BACKGROUND);
+    CHECK(pool.trim(TRIM_WEIGHTS) == TRIM_BUFFERS);
+    CHECK(detect_label(held) == 'b');
+    pool.release(held, CALLER_BACKGROUND);
+    CHECK(detect_label(pool, CALLER_INTERACTIVE) == 'a');
+    CHECK(pool.trim(TRIM_BUFFERS) == TRIM_BUFFERS);
+}
+
+// 检测线程两个调用方各半，后台名额为 1；同时不断换模型与 trim
+static void test_stress() {
+    Yolov8Pool pool;
+    CHECK(load(pool, CALLER_INTERACTIVE, "a") == 0);
+    CHECK(load(pool, CALLER_BACKGROUND, "b") == 0);
+    stub_peak_detectors = stub_live_detectors.load();
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> detections(0);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 6; t++) {
+        const int caller = t % 2 == 0 ? CALLER_INTERACTIVE : CALLER_BACKGROUND;
+        threads.push_back(std::thread([&, caller]() {
+            while (!stop.load()) {
+                const int label = detect_label(pool, caller);
+                if (label < 'a' || label > 'c') failures.fetch_add(1);
+                detections.fetch_add(1);
+            }
+        }));
+    }
+    // trim 与换模型都按检测进度推进：每一步之后等检测线程至少再完成若干次，保证三者交错而不依赖耗时
+    threads.push_back(std::thread([&]() {
+        for (int i = 0; !stop.load(); i++) {
+            const int level = pool.trim(i % 2 == 0 ? TRIM_WEIGHTS : TRIM_BUFFERS);
+            if (level != TRIM_BUFFERS && level != TRIM_WEIGHTS) failures.fetch_add(1);
+            const int target = detections.load() + 1;
+            while (!stop.load() && detections.load() < target) sched_yield();
+        }
+    }));
+
+    // 换模型由调用方串行，与 JNI 中持锁调用 load 一致
+    static const char* const models[] = {"a", "b", "c", "missing"};
+    for (int i = 0; i < 300; i++) {
+        const int caller = i % 2 == 0 ? CALLER_INTERACTIVE : CALLER_BACKGROUND;
+        const int m = i % 7 % 4;
+        const int ret = load(pool, caller, models[m]);
+        CHECK(ret == (m == 3 ? -1 : 0));
+        if (i % 50 == 0) pool.set_caller_limit(CALLER_BACKGROUND, i % 100 == 0 ? 1 : 2);
+        const int target = detections.load() + 6;
+        while (detections.load() < target) sched_yield();
+    }
+    stop = true;
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    CHECK(failures.load() == 0);
+    CHECK(detections.load() >= 300 * 6);
+    // 两个调用方的当前一代、一个被替换的旧一代与正在建立的一代
+    CHECK(stub_peak_detectors.load() <= 4 * num_workers);
+    printf("stress: %d detections, peak %d detectors\n", detections.load(), stub_peak_detectors.load());
+}
+
+int main() {
+    test_callers();
+    CHECK(stub_live_detectors.load() == 0);
+    test_blocking_acquire();
+    CHECK(stub_live_detectors.load() == 0);
+    test_generations();
+    CHECK(stub_live_detectors.load() == 0);
+    test_trim();
+    CHECK(stub_live_detectors.load() == 0);
+    test_stress();
+    CHECK(stub_live_detectors.load() == 0);
+    printf("yolov8 pool ok\n");
+    return 0;
+}
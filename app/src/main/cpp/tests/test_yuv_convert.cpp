@@ -0,0 +1,271 @@
+// yuv420_layout / yuv420_to_nv21 / yuv420_to_rgb_resize 对照参考帧：
+// 同一幅由 16x16 纯色块组成的画面按 NV21、NV12、I420 及带行填充的布局打包，
+// 检查布局识别、整理出的 NV21 字节，以及 8 种 EXIF 方向（含 0/90/180/270 四种旋转）下转出的 RGB
+#include <string.h>
+#include <vector>
+#include <ncnn/mat.h>
+
+#include "yuv_convert.h"
+#include "test_util.h"
+
+static const int kBlock = 16;
+
+// 平面 YUV420 参考帧，色块与色度采样对齐，每个像素的颜色只取决于所在色块
+struct RefFrame {
+    int w;
+    int h;
+    std::vector<unsigned char> y;
+    std::vector<unsigned char> u;
+    std::vector<unsigned char> v;
+};
+
+static void make_ref(RefFrame& f, int w, int h) {
+    f.w = w;
+    f.h = h;
+    f.y.resize(w * h);
+    f.u.resize(w / 2 * h / 2);
+    f.v.resize(w / 2 * h / 2);
+    for (int i = 0; i < h; i++) {
+        for (int j = 0; j < w; j++) {
+            const int bx = j / kBlock, by = i / kBlock;
+            f.y[i * w + j] = (unsigned char)(40 + 13 * (bx + by * (w / kBlock)));
+        }
+    }
+    for (int i = 0; i < h / 2; i++) {
+        for (int j = 0; j < w / 2; j++) {
+            const int bx = j * 2 / kBlock, by = i * 2 / kBlock;
+            f.u[i * (w / 2) + j] = (unsigned char)(98 + 20 * bx);
+            f.v[i * (w / 2) + j] = (unsigned char)(158 - 25 * by);
+        }
+    }
+}
+
+// 打包后的一帧，planes 指向 buf
+struct PackedFrame {
+    std::vector<unsigned char> buf;
+    Yuv420Planes planes;
+};
+
+// 半平面布局：y 行距 y_stride，色度交错行距 uv_stride，v_first 为 VU 顺序；
+// contiguous 时色度紧跟在 Y 之后（相机 HAL 常见的一块内存）
+static void pack_semi_planar(const RefFrame& f, bool v_first, int y_stride, int uv_stride, bool contiguous, PackedFrame& p) {
+    const int ch = f.h / 2, cw = f.w / 2;
+    const size_t y_size = (size_t)y_stride * f.h;
+    const size_t gap = contiguous ? 0 : 32;
+    p.buf.assign(y_size + gap + (size_t)uv_stride * ch, 0xee);
+    for (int i = 0; i < f.h; i++) memcpy(&p.buf[(size_t)i * y_stride], &f.y[i * f.w], f.w);
+    unsigned char* uv = &p.buf[y_size + gap];
+    for (int i = 0; i < ch; i++) {
+        for (int j = 0; j < cw; j++) {
+            uv[i * uv_stride + j * 2 + (v_first ? 0 : 1)] = f.v[i * cw + j];
+            uv[i * uv_stride + j * 2 + (v_first ? 1 : 0)] = f.u[i * cw + j];
+        }
+    }
+    p.planes.y = &p.buf[0];
+    p.planes.v = v_first ? uv : uv + 1;
+    p.planes.u = v_first ? uv + 1 : uv;
+    p.planes.width = f.w;
+    p.planes.height = f.h;
+    p.planes.y_row_stride = y_stride;
+    p.planes.uv_row_stride = uv_stride;
+    p.planes.uv_pixel_stride = 2;
+}
+
+// 平面布局（I420），色度行距 uv_stride，像素步长 1
+static void pack_planar(const RefFrame& f, int y_stride, int uv_stride, PackedFrame& p) {
+    const int ch = f.h / 2, cw = f.w / 2;
+    const size_t y_size = (size_t)y_stride * f.h;
+    const size_t c_size = (size_t)uv_stride * ch;
+    p.buf.assign(y_size + c_size * 2, 0xee);
+    for (int i = 0; i < f.h; i++) memcpy(&p.buf[(size_t)i * y_stride], &f.y[i * f.w], f.w);
+    for (int i = 0; i < ch; i++) {
+        memcpy(&p.buf[y_size + (size_t)i * uv_stride], &f.u[i * cw], cw);
+        memcpy(&p.buf[y_size + c_size + (size_t)i * uv_stride], &f.v[i * cw], cw);
+    }
+    p.planes.y = &p.buf[0];
+    p.planes.u = &p.buf[y_size];
+    p.planes.v = &p.buf[y_size + c_size];
+    p.planes.width = f.w;
+    p.planes.height = f.h;
+    p.planes.y_row_stride = y_stride;
+    p.planes.uv_row_stride = uv_stride;
+    p.planes.uv_pixel_stride = 1;
+}
+
+static void ref_nv21(const RefFrame& f, std::vector<unsigned char>& nv21) {
+    const int cw = f.w / 2;
+    nv21.assign(f.y.begin(), f.y.end());
+    for (int i = 0; i < f.h / 2; i++) {
+        for (int j = 0; j < cw; j++) {
+            nv21.push_back(f.v[i * cw + j]);
+            nv21.push_back(f.u[i * cw + j]);
+        }
+    }
+}
+
+// 传感器方向的参考 RGB：每个色块的颜色由 ncnn 对一个 2x2 纯色 NV21 块转色得到，
+// 与被测路径使用同一转色实现，只比较几何关系
+static void ref_rgb(const RefFrame& f, std::vector<unsigned char>& rgb) {
+    rgb.resize((size_t)f.w * f.h * 3);
+    for (int i = 0; i < f.h; i++) {
+        for (int j = 0; j < f.w; j++) {
+            const int c = (i / 2) * (f.w / 2) + j / 2;
+            unsigned char patch[6] = {f.y[i * f.w + j], f.y[i * f.w + j], f.y[i * f.w + j], f.y[i * f.w + j], f.v[c], f.u[c]};
+            unsigned char px[12];
+            ncnn::yuv420sp2rgb(patch, 2, 2, px);
+            memcpy(&rgb[((size_t)i * f.w + j) * 3], px, 3);
+        }
+    }
+}
+
+// 传感器坐标 (x, y) 在按 EXIF 类型旋转后画面中的位置
+static void rotate_point(int type, int w, int h, int x, int y, int& dx, int& dy) {
+    switch (type) {
+    case 2: dx = w - 1 - x; dy = y; break;
+    case 3: dx = w - 1 - x; dy = h - 1 - y; break;
+    case 4: dx = x; dy = h - 1 - y; break;
+    case 5: dx = y; dy = x; break;
+    case 6: dx = h - 1 - y; dy = x; break;
+    case 7: dx = h - 1 - y; dy = w - 1 - x; break;
+    case 8: dx = y; dy = w - 1 - x; break;
+    default: dx = x; dy = y; break;
+    }
+}
+
+static void rotate_rgb(const std::vector<unsigned char>& src, int w, int h, int type, std::vector<unsigned char>& dst) {
+    dst.resize(src.size());
+    const int ow = rotate_type_transposed(type) ? h : w;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int dx, dy;
+            rotate_point(type, w, h, x, y, dx, dy);
+            memcpy(&dst[((size_t)dy * ow + dx) * 3], &src[((size_t)y * w + x) * 3], 3);
+        }
+    }
+}
+
+static bool near_pixel(const unsigned char* a, const unsigned char* b, int tol) {
+    for (int k = 0; k < 3; k++) {
+        if (a[k] - b[k] > tol || b[k] - a[k] > tol) return false;
+    }
+    return true;
+}
+
+int main() {
+    RefFrame f;
+    make_ref(f, 64, 48);
+    std::vector<unsigned char> nv21_ref, rgb_ref;
+    ref_nv21(f, nv21_ref);
+    ref_rgb(f, rgb_ref);
+
+    // 各种打包方式及应识别出的布局
+    const int w = f.w;
+    PackedFrame frames[7];
+    Yuv420Layout layouts[7];
+    pack_semi_planar(f, true, w, w, true, frames[0]);            layouts[0] = YUV420_NV21;
+    pack_semi_planar(f, false, w, w, true, frames[1]);           layouts[1] = YUV420_NV12;
+    pack_semi_planar(f, true, w, w, false, frames[2]);           layouts[2] = YUV420_STRIDED;  // 色度与 Y 不相连
+    pack_planar(f, w, w / 2, frames[3]);                         layouts[3] = YUV420_STRIDED;  // I420
+    pack_semi_planar(f, true, w + 24, w + 24, true, frames[4]);  layouts[4] = YUV420_STRIDED;  // 行填充 VU
+    pack_semi_planar(f, false, w + 24, w + 8, true, frames[5]);  layouts[5] = YUV420_STRIDED;  // 行填充 UV
+    pack_planar(f, w + 16, w / 2 + 8, frames[6]);                layouts[6] = YUV420_STRIDED;  // 行填充 I420
+    const int num_frames = 7;
+
+    std::vector<unsigned char> nv21(nv21_ref.size());
+    std::vector<unsigned char> scratch;
+    std::vector<unsigned char> expected, out;
+    for (int n = 0; n < num_frames; n++) {
+        const Yuv420Planes& yuv = frames[n].planes;
+        CHECK(yuv420_layout(yuv) == layouts[n]);
+
+        memset(&nv21[0], 0, nv21.size());
+        yuv420_to_nv21(yuv, &nv21[0]);
+        CHECK(nv21 == nv21_ref);
+
+        // 不缩放：8 种方向逐像素一致
+        for (int type = 1; type <= 8; type++) {
+            const bool t = rotate_type_transposed(type);
+            const int ow = t ? f.h : f.w, oh = t ? f.w : f.h;
+            out.assign((size_t)ow * oh * 3, 0);
+            CHECK(yuv420_to_rgb_resize(yuv, ow, oh, type, &out[0], scratch) == 0);
+            rotate_rgb(rgb_ref, f.w, f.h, type, expected);
+            CHECK(out == expected);
+        }
+
+        // 缩小一半再旋转：比较各色块中心，缩放只在块边界处混色
+        for (int type = 1; type <= 8; type++) {
+            const bool t = rotate_type_transposed(type);
+            const int rw = f.w / 2, rh = f.h / 2;
+            const int ow = t ? rh : rw, oh = t ? rw : rh;
+            out.assign((size_t)ow * oh * 3, 0);
+            CHECK(yuv420_to_rgb_resize(yuv, ow, oh, type, &out[0], scratch) == 0);
+            for (int by = 0; by < f.h / kBlock; by++) {
+                for (int bx = 0; bx < f.w / kBlock; bx++) {
+                    int dx, dy;
+                    rotate_point(type, rw, rh, bx * kBlock / 2 + kBlock / 4, by * kBlock / 2 + kBlock / 4, dx, dy);
+                    const unsigned char* want = &rgb_ref[((size_t)(by * kBlock + kBlock / 2) * f.w + bx * kBlock + kBlock / 2) * 3];
+                    CHECK(near_pixel(&out[((size_t)dy * ow + dx) * 3], want, 2));
+                }
+            }
+        }
+    }
+
+    // 相机 rotation_degrees 与方向类型：顺时针 90 后传感器左上角的色块出现在右上角，270 时出现在左下角
+    {
+        const unsigned char* corner = &rgb_ref[0];
+        const int ow = f.h, oh = f.w;
+        out.assign((size_t)ow * oh * 3, 0);
+        CHECK(yuv420_to_rgb_resize(frames[0].planes, ow, oh, yuv420_rotate_type(90, false), &out[0], scratch) == 0);
+        CHECK(near_pixel(&out[(size_t)(ow - 1) * 3], corner, 0));
+        CHECK(yuv420_to_rgb_resize(frames[0].planes, ow, oh, yuv420_rotate_type(270, false), &out[0], scratch) == 0);
+        CHECK(near_pixel(&out[(size_t)(oh - 1) * ow * 3], corner, 0));
+        CHECK(yuv420_to_rgb_resize(frames[0].planes, f.w, f.h, yuv420_rotate_type(180, false), &out[0], scratch) == 0);
+        CHECK(near_pixel(&out[((size_t)f.h * f.w - 1) * 3], corner, 0));
+        CHECK(yuv420_to_rgb_resize(frames[0].planes, f.w, f.h, yuv420_rotate_type(0, true), &out[0], scratch) == 0);
+        CHECK(near_pixel(&out[(size_t)(f.w - 1) * 3], corner, 0));
+    }
+
+    // rotate_rect 与逐点映射一致：矩形四角映射后落在变换后的矩形内
+    for (int type = 1; type <= 8; type++) {
+        int x0 = 16, y0 = 8, x1 = 48, y1 = 32;
+        rotate_rect(type, f.w, f.h, x0, y0, x1, y1);
+        int dx, dy;
+        rotate_point(type, f.w, f.h, 16, 8, dx, dy);
+        CHECK(dx >= x0 && dx < x1 && dy >= y0 && dy < y1);
+        rotate_point(type, f.w, f.h, 47, 31, dx, dy);
+        CHECK(dx >= x0 && dx < x1 && dy >= y0 && dy < y1);
+        const bool t = rotate_type_transposed(type);
+        CHECK(x1 - x0 == (t ? 24 : 32) && y1 - y0 == (t ? 32 : 24));
+        CHECK(inverse_rotate_type(inverse_rotate_type(type)) == type);
+    }
+
+    // 裁剪后旋转：与参考帧裁出同一区域再旋转逐像素一致，覆盖各种行距 / 像素步长的指针偏移
+    {
+        const int cx = 16, cy = 16, cw = 32, ch = 32;
+        std::vector<unsigned char> crop_ref((size_t)cw * ch * 3);
+        for (int i = 0; i < ch; i++) memcpy(&crop_ref[(size_t)i * cw * 3], &rgb_ref[((size_t)(cy + i) * f.w + cx) * 3], cw * 3);
+
+        for (int n = 0; n < num_frames; n++) {
+            const Yuv420Planes roi = yuv420_crop(frames[n].planes, cx, cy, cw, ch);
+            CHECK(yuv420_layout(roi) == YUV420_STRIDED);
+            for (int type = 1; type <= 8; type++) {
+                out.assign((size_t)cw * ch * 3, 0);
+                CHECK(yuv420_to_rgb_resize(roi, cw, ch, type, &out[0], scratch) == 0);
+                rotate_rgb(crop_ref, cw, ch, type, expected);
+                CHECK(out == expected);
+            }
+        }
+    }
+
+    // 奇数尺寸拒绝
+    {
+        Yuv420Planes odd = frames[0].planes;
+        odd.width = 63;
+        out.assign(64 * 48 * 3, 0);
+        CHECK(yuv420_to_rgb_resize(odd, 62, 48, 1, &out[0], scratch) != 0);
+        CHECK(yuv420_to_rgb_resize(frames[0].planes, 31, 24, 1, &out[0], scratch) != 0);
+    }
+
+    printf("yuv convert: layouts, nv21 packing and rotations match reference frames\n");
+    return 0;
+}
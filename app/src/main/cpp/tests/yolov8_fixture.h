@@ -0,0 +1,30 @@
+#ifndef YOLOV8_FIXTURE_H
+#define YOLOV8_FIXTURE_H
+
+// 随机构造与 out0 同布局的 (4 + num_class) x num_anchor 输出
+#include <ncnn/mat.h>
+#include "test_util.h"
+
+// 框中心落在 640 输入内，宽高 4~320；分类分数大多低于 0.1，约 hit_ratio 的 anchor 有一个类别高分，
+// 另以 1/16 的概率复制相邻类别分数制造并列，覆盖 argmax 取较小类别的分支
+static inline void random_yolov8_output(ncnn::Mat& out, int num_class, int num_anchor, float hit_ratio, TestRng& rng) {
+    out.create(num_anchor, 4 + num_class);
+    for (int i = 0; i < num_anchor; i++) {
+        out.row(0)[i] = rng.uniform(0.f, 640.f);
+        out.row(1)[i] = rng.uniform(0.f, 640.f);
+        out.row(2)[i] = rng.uniform(4.f, 320.f);
+        out.row(3)[i] = rng.uniform(4.f, 320.f);
+    }
+    for (int j = 0; j < num_class; j++) {
+        float* row = out.row(4 + j);
+        for (int i = 0; i < num_anchor; i++) row[i] = rng.uniform(0.f, 0.1f);
+    }
+    for (int i = 0; i < num_anchor; i++) {
+        if (rng.uniform(0.f, 1.f) >= hit_ratio) continue;
+        const int j = rng.below(num_class);
+        out.row(4 + j)[i] = rng.uniform(0.2f, 1.f);
+        if (j + 1 < num_class && rng.below(16) == 0) out.row(4 + j + 1)[i] = out.row(4 + j)[i];
+    }
+}
+
+#endif // YOLOV8_FIXTURE_H
@@ -0,0 +1,110 @@
+// 检测池测试用的 Yolov8 桩：只实现 Yolov8Pool 用到的成员与 detect，不加载网络、不推理
+// 网络是否可用记在持有网络的实例的 yolov8.opt.num_threads（0 为已卸载），共享实例经 net 指针读取；
+// detect 以 inference_threads 标记占用并改写本实例的缓冲，同一实例被两个线程同时使用时
+// 直接失败，在 thread sanitizer 下另报数据竞争
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+
+#include "yolov8.h"
+
+// 存活的实例数与其峰值，测试据此检查同时存在的代数
+std::atomic<int> stub_live_detectors(0);
+std::atomic<int> stub_peak_detectors(0);
+
+// 与 yolov8_tune.cpp 一致；yolov8_tune.cpp 依赖完整的 ncnn，不参与链接
+InferenceProfile::InferenceProfile()
+    : num_threads(0), fp16(true), packing_layout(true), winograd(true), sgemm(true), openmp_blocktime(20),
+      latency_ms(0.f) {}
+
+bool InferenceProfile::same_options(const InferenceProfile& other) const {
+    return num_threads == other.num_threads && fp16 == other.fp16 && packing_layout == other.packing_layout
+           && winograd == other.winograd && sgemm == other.sgemm && openmp_blocktime == other.openmp_blocktime;
+}
+
+Yolov8::Yolov8() : net(&yolov8), weights_asset(0), weights_map(0), weights_map_size(0),
+                   loaded_param_binary(false), weights_mem(0), loaded_fused(false), network_released(false),
+                   fused_postprocess(false), rect_inference(false), inference_threads(0),
+                   in_blob(-1), out_blob(-1), det_param_blob(-1), detections_blob(-1), prepared_empty(false) {
+    yolov8.opt.num_threads = 0;
+    const int live = stub_live_detectors.fetch_add(1) + 1;
+    int peak = stub_peak_detectors.load();
+    while (live > peak && !stub_peak_detectors.compare_exchange_weak(peak, live)) {
+    }
+}
+
+Yolov8::~Yolov8() {
+    stub_live_detectors.fetch_sub(1);
+}
+
+// param 路径以 missing 开头时模拟加载失败
+int Yolov8::load(AAssetManager*, const char* param_path, const char*, bool fused) {
+    if (strncmp(param_path, "missing", 7) == 0) return -1;
+    loaded_param = param_path;
+    loaded_fused = fused;
+    yolov8.opt.num_threads = 1;
+    stats = LoadStats();
+    stats.load_ms = 1.0;
+    if (warmup_params.runs > 0) return warmup(warmup_params);
+    return 0;
+}
+
+int Yolov8::attach(const Yolov8& model) {
+    if (model.net->opt.num_threads == 0) return -1;
+    net = model.net;
+    loaded_param = model.loaded_param;
+    stats = LoadStats();
+    return 0;
+}
+
+void Yolov8::set_profile(const InferenceProfile& p) {
+    profile = p;
+}
+
+void Yolov8::set_warmup(const WarmupParams& params) {
+    warmup_params = params;
+}
+
+int Yolov8::warmup(const WarmupParams& params) {
+    if (net->opt.num_threads == 0) return -1;
+    stats.warmup_runs += params.runs;
+    return 0;
+}
+
+void Yolov8::trim(int level) {
+    std::vector<unsigned char>().swap(rgb_scratch);
+    if (level < TRIM_WEIGHTS || net != &yolov8 || network_released) return;
+    yolov8.opt.num_threads = 0;
+    network_released = true;
+}
+
+int Yolov8::reload() {
+    if (!network_released) return 0;
+    yolov8.opt.num_threads = 1;
+    network_released = false;
+    return 0;
+}
+
+void Yolov8::set_rect_inference(bool enabled) {
+    rect_inference = enabled;
+}
+
+void Yolov8::set_thread_policy(const ThreadPolicy& policy) {
+    thread_policy = policy;
+}
+
+// 模拟一次约 0.2 ms 的推理，返回一个框，label 为 param 路径的首字符，测试据此区分模型
+int Yolov8::detect(const unsigned char*, int, int, int, std::vector<Object>& objects, float, int, int) {
+    objects.clear();
+    if (net->opt.num_threads == 0) return -1;
+    if (inference_threads != 0) return -1;
+    inference_threads = 1;
+    rgb_scratch.assign(4096, (unsigned char)loaded_param[0]);
+    usleep(200);
+    Object obj;
+    obj.label = rgb_scratch[4095];
+    obj.prob = 1.f;
+    objects.push_back(obj);
+    inference_threads = 0;
+    return 0;
+}
@@ -2,14 +2,238 @@ package com.tencent.ncnn;
 
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
+import android.graphics.RectF;
+
+import java.nio.ByteBuffer;
+import java.util.Locale;
 
 public class Yolov8 {
     static {
         System.loadLibrary("yolov8ncnn");
     }
 
+    // 与 native Yolov8::default_max_candidates / default_max_detections 一致
+    public static final int DEFAULT_MAX_CANDIDATES = 1000;
+    public static final int DEFAULT_MAX_DETECTIONS = 300;
+
+    // 与 native NmsMode 一致
+    public static final int NMS_HARD = 0;
+    public static final int NMS_SOFT_LINEAR = 1;
+    public static final int NMS_SOFT_GAUSSIAN = 2;
+    public static final int NMS_WBF = 3;
+    public static final float DEFAULT_IOU_THRESHOLD = 0.45f;
+
+    // 追踪已找到目标时 ROI 推理的默认输入边长
+    public static final int DEFAULT_ROI_SIZE = 320;
+
+    // 与 native TileParams 默认值一致
+    public static final int DEFAULT_TILE_SIZE = 640;
+    public static final float DEFAULT_TILE_OVERLAP = 0.2f;
+    public static final int DEFAULT_TILE_INPUT_SIZE = 640;
+
+    // 与 native DetectCaller 一致：相机实时检测与后台任务分开限流，可同时推理
+    public static final int CALLER_INTERACTIVE = 0;
+    public static final int CALLER_BACKGROUND = 1;
+
+    // 与 native ThreadPolicyMode 一致：检测线程绑定的核心
+    public static final int THREAD_ALL = 0;
+    public static final int THREAD_LITTLE = 1;
+    public static final int THREAD_BIG = 2;
+    public static final int THREAD_CUSTOM = 3;
+
+    // 与 native Yolov8Pool::default_workers 一致
+    public static final int DEFAULT_WORKERS = 3;
+
+    // 与 native TrimLevel 一致
+    public static final int TRIM_BUFFERS = 0;
+    public static final int TRIM_WEIGHTS = 1;
+
+    // 加载后每个预热尺寸的推理次数
+    public static final int DEFAULT_WARMUP_RUNS = 3;
+    // 相机流水线按延迟预算在这些整帧输入边长间切换（与 native ResolutionController::sizes 一致），都应预热
+    public static final int[] PIPELINE_INPUT_SIZES = {640, 512, 416, 320};
+
+    // 本实例的检测占用 caller 的并发名额
+    private final int caller;
+
+    public Yolov8() {
+        this(CALLER_INTERACTIVE);
+    }
+
+    public Yolov8(int caller) {
+        this.caller = caller;
+    }
+
+    // 所有 Yolov8 实例共用一个 native 检测池，模型按 caller 分开：同一 caller 已加载同一模型时直接返回 0，
+    // 另一 caller 已加载同一模型（实例数与推理选项也相同）时共用其实例，不同时各自加载，一方换模型不影响另一方
+    // 换模型时新模型在调用线程上加载，完成后原子替换，期间检测不受阻塞；失败时保留原模型并返回 -1
     public native int loadModel(AssetManager mgr, String paramPath, String binPath);
-    public native DetectionResult[] detect(Bitmap bitmap, float threshold);
+
+    // loadModel 在替换前按 sizes 中的各输入边长预热 runs 次，首帧的内存分配与权重重排不再落到第一次检测上；
+    // sizes 为 null 时按 640，runs <= 0 时不预热；下次 loadModel 时生效
+    public native void setWarmup(int runs, int[] sizes);
+
+    // 本实例 caller 当前模型的加载、预热耗时与稳态单帧耗时，尚未加载时全为 0
+    public native LoadStats getLoadStats();
+
+    // 内存紧张时释放各 caller 模型空闲实例的推理缓冲；TRIM_WEIGHTS 且没有检测在进行时另外卸载网络，
+    // 之后第一次检测从 APK 中的权重映射重建（约一次加载的耗时），无需再调用 loadModel
+    // 返回实际生效的级别，尚未加载时返回 -1；可在任意线程调用
+    public native int trimMemory(int level);
+
+    // 池中实例数，各实例共享权重、各自持有推理缓冲；下次 loadModel 时生效
+    public native void setWorkerCount(int count);
+
+    // caller 同时推理的实例数上限，<= 0 表示只受池大小限制；默认后台最多占一个
+    public native void setCallerLimit(int caller, int limit);
+
+    // caller 的检测线程绑定到 policy（THREAD_*）的核心上，THREAD_CUSTOM 时 mask 按位给出 CPU 编号
+    // 默认实时相机在大核、后台任务在小核；可随时调用，下一次检测起生效
+    public native void setThreadPolicy(int caller, int policy, long mask);
+
+    // 读取 autotune 保存的推理选项档案，下次 loadModel 时生效，与已加载的选项不同时按新选项重建；
+    // 文件不存在或无法解析时返回 -1，保持原有选项
+    public native int loadProfile(String profilePath);
+
+    // 恢复调优前的默认推理选项，下次 loadModel 时生效
+    public native void resetProfile();
+
+    // 在本机逐项实测线程数、fp16、packing、winograd / sgemm 与 OpenMP blocktime，选出检测结果与 fp32 一致的
+    // 最快组合写入 profilePath，并作为之后 loadModel 的选项；耗时数秒，需在后台线程调用，返回 0 成功
+    public native int autotune(AssetManager mgr, String paramPath, String binPath, String profilePath);
+
+    // 最小填充推理：短边只填充到 32 的整数倍，4:3 画面少算约 25% 的卷积；重新加载模型后保持
+    public native void setRectInference(boolean enabled);
+
+    public DetectionResult[] detect(Bitmap bitmap, float threshold) {
+        return detect(bitmap, threshold, null);
+    }
+
+    public DetectionResult[] detect(Bitmap bitmap, float threshold, int[] classIds) {
+        return detect(bitmap, threshold, classIds, NMS_HARD);
+    }
+
+    public DetectionResult[] detect(Bitmap bitmap, float threshold, int[] classIds, int nmsMode) {
+        return detect(bitmap, 0, 0, 0, 0, 0, threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS,
+                      nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // 只对 roi 区域推理，长边缩放到 roiSize，坐标仍对应整幅 bitmap
+    public DetectionResult[] detectRoi(Bitmap bitmap, RectF roi, int roiSize, float threshold, int[] classIds, int nmsMode) {
+        return detect(bitmap, roi.left, roi.top, roi.width(), roi.height(), roiSize, threshold, classIds,
+                      DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // roiWidth / roiHeight <= 0 时检测整幅图，否则只对该区域推理，长边缩放到 roiSize（32 的整数倍）
+    // classIds 为 null 或空时检测全部类别，否则只解码这些类别
+    // maxCandidates 限制进入 NMS 的候选框数，maxDetections 限制输出框数，<= 0 表示不限
+    // nmsMode 为 NMS_* 之一，iouThreshold 为抑制 / 融合的 IoU 阈值
+    public native DetectionResult[] detect(Bitmap bitmap, float roiX, float roiY, float roiWidth, float roiHeight, int roiSize,
+                                           float threshold, int[] classIds,
+                                           int maxCandidates, int maxDetections,
+                                           int nmsMode, float iouThreshold);
+
+    public DetectionResult[] detectTiled(Bitmap bitmap, float threshold, int[] classIds, int nmsMode) {
+        return detectTiled(bitmap, DEFAULT_TILE_SIZE, DEFAULT_TILE_OVERLAP, DEFAULT_TILE_INPUT_SIZE, true,
+                           threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // 分块推理：按 tileSize 像素、overlap 比例重叠切块，各块缩放到 inputSize 并行推理，
+    // fullFrame 为 true 时再做一次整图推理；各块的框还原到整图后统一按类别抑制，其余参数与 detect 相同
+    // 适合在高分辨率照片中找小目标，耗时随块数增长
+    public native DetectionResult[] detectTiled(Bitmap bitmap, int tileSize, float overlap, int inputSize, boolean fullFrame,
+                                                float threshold, int[] classIds,
+                                                int maxCandidates, int maxDetections,
+                                                int nmsMode, float iouThreshold);
+
+    public DetectionResult[] detectYuv(ByteBuffer y, ByteBuffer u, ByteBuffer v, int width, int height,
+                                       int yRowStride, int uvRowStride, int uvPixelStride,
+                                       int rotationDegrees, boolean mirror,
+                                       float threshold, int[] classIds, int nmsMode) {
+        return detectYuv(y, u, v, width, height, yRowStride, uvRowStride, uvPixelStride, rotationDegrees, mirror,
+                         0, 0, 0, 0, 0,
+                         threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // roi 为旋转后画面中的区域，坐标仍对应整幅旋转后的画面
+    public DetectionResult[] detectYuvRoi(ByteBuffer y, ByteBuffer u, ByteBuffer v, int width, int height,
+                                          int yRowStride, int uvRowStride, int uvPixelStride,
+                                          int rotationDegrees, boolean mirror, RectF roi, int roiSize,
+                                          float threshold, int[] classIds, int nmsMode) {
+        return detectYuv(y, u, v, width, height, yRowStride, uvRowStride, uvPixelStride, rotationDegrees, mirror,
+                         roi.left, roi.top, roi.width(), roi.height(), roiSize,
+                         threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // YUV_420_888 三平面直接检测，y / u / v 为 Image.Plane 的 direct ByteBuffer，调用返回前不能关闭图像
+    // rotationDegrees 取 ImageInfo.getRotationDegrees()，mirror 为 true 时旋转后再水平翻转（前置镜头）
+    // 旋转在 native 缩小后的帧上完成，坐标对应旋转后的画面；宽高需为偶数，roi 与其余参数与 detect 相同
+    public native DetectionResult[] detectYuv(ByteBuffer y, ByteBuffer u, ByteBuffer v, int width, int height,
+                                              int yRowStride, int uvRowStride, int uvPixelStride,
+                                              int rotationDegrees, boolean mirror,
+                                              float roiX, float roiY, float roiWidth, float roiHeight, int roiSize,
+                                              float threshold, int[] classIds,
+                                              int maxCandidates, int maxDetections,
+                                              int nmsMode, float iouThreshold);
+
+    // 相机异步流水线：submitYuv 拷贝帧后立即返回，预处理与推理在 native 专用线程上重叠运行，
+    // 积压时只处理最新一帧；结果经 callback 在 native 推理线程上回调，回调内不能调用 stopPipeline
+    // 已启动时先停止旧的流水线，返回 0 成功
+    public native int startPipeline(DetectionCallback callback);
+
+    // 等待流水线线程退出，返回后不再回调
+    public native void stopPipeline();
+
+    // 流水线整帧推理（未给 roi）的端到端耗时预算（毫秒）：超出时输入边长在 640 / 512 / 416 / 320 间逐档下调，
+    // 余量充足时逐档回升；<= 0 时固定 640。对运行中与之后启动的流水线都生效
+    public native void setLatencyBudget(float budgetMs);
+
+    // 流水线当前整帧推理的输入边长，未启动时返回 0
+    public native int getPipelineInputSize();
+
+    public long submitYuv(ByteBuffer y, ByteBuffer u, ByteBuffer v, int width, int height,
+                          int yRowStride, int uvRowStride, int uvPixelStride,
+                          int rotationDegrees, boolean mirror, RectF roi, int roiSize,
+                          float threshold, int[] classIds, int nmsMode) {
+        if (roi == null) {
+            return submitYuv(y, u, v, width, height, yRowStride, uvRowStride, uvPixelStride, rotationDegrees, mirror,
+                             0, 0, 0, 0, 0,
+                             threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+        }
+        return submitYuv(y, u, v, width, height, yRowStride, uvRowStride, uvPixelStride, rotationDegrees, mirror,
+                         roi.left, roi.top, roi.width(), roi.height(), roiSize,
+                         threshold, classIds, DEFAULT_MAX_CANDIDATES, DEFAULT_MAX_DETECTIONS, nmsMode, DEFAULT_IOU_THRESHOLD);
+    }
+
+    // 参数与 detectYuv 相同；返回帧序号，与回调的 frameId 对应，流水线未启动或 buffer 不是 direct 时返回 -1
+    // 返回后即可关闭图像
+    public native long submitYuv(ByteBuffer y, ByteBuffer u, ByteBuffer v, int width, int height,
+                                 int yRowStride, int uvRowStride, int uvPixelStride,
+                                 int rotationDegrees, boolean mirror,
+                                 float roiX, float roiY, float roiWidth, float roiHeight, int roiSize,
+                                 float threshold, int[] classIds,
+                                 int maxCandidates, int maxDetections,
+                                 int nmsMode, float iouThreshold);
+
+    // 流水线结果，坐标对应旋转后的画面，frameWidth / frameHeight 为其尺寸
+    public interface DetectionCallback {
+        void onDetections(long frameId, DetectionResult[] results, int frameWidth, int frameHeight);
+    }
+
+    // 与 native LoadStats 一致，单位毫秒
+    public static class LoadStats {
+        public float loadMs;
+        public float warmupMs;
+        public float firstMs;
+        public float steadyMs;
+        public int warmupRuns;
+
+        @Override
+        public String toString() {
+            return String.format(Locale.US, "load %.1f ms, warm-up %.1f ms (%d runs), first %.1f ms, steady %.1f ms",
+                                 loadMs, warmupMs, warmupRuns, firstMs, steadyMs);
+        }
+    }
 
     public static class DetectionResult {
         public int classId;
@@ -19,6 +19,7 @@ import com.google.mlkit.nl.translate.TranslatorOptions
 import com.google.mlkit.vision.common.InputImage
 import com.google.mlkit.vision.text.TextRecognition
 import com.google.mlkit.vision.text.latin.TextRecognizerOptions
+import com.tencent.ncnn.Yolov8
 import com.visionmatrix.ctrlf.YOLOv8Detector
 import com.visionmatrix.ctrlf.databinding.ActivityScenarioBinding
 import kotlinx.coroutines.Dispatchers
@@ -43,7 +44,8 @@ class ScenarioActivity : AppCompatActivity() {
         setContentView(binding.root)
 
         semanticMatcher = SemanticMatcher(this)
-        detector = YOLOv8Detector(this)
+        // 场景识别走后台名额，与相机 Ctrl+F 并发推理
+        detector = YOLOv8Detector(this, Yolov8.CALLER_BACKGROUND)
         
         lifecycleScope.launch(Dispatchers.IO) {
             semanticMatcher.init()
@@ -96,7 +98,12 @@ class ScenarioActivity : AppCompatActivity() {
 
     private fun runObjectDetection(bitmap: Bitmap) {
         lifecycleScope.launch(Dispatchers.IO) {
-            val results = detector.detect(bitmap, null, 0.15f)
+            // 大图分块推理，避免整图压到 640 后小物体消失
+            val results = if (maxOf(bitmap.width, bitmap.height) > TILED_MIN_SIZE) {
+                detector.detectTiled(bitmap, null, 0.15f)
+            } else {
+                detector.detect(bitmap, null, 0.15f)
+            }
             withContext(Dispatchers.Main) {
                 if (!results.isNullOrEmpty()) {
                     // 修正：删除 chineseName，使用 className (英文)
@@ -142,4 +149,9 @@ class ScenarioActivity : AppCompatActivity() {
             }
         }
     }
+
+    companion object {
+        // 长边超过该值的照片走分块推理
+        private const val TILED_MIN_SIZE = 1280
+    }
 }
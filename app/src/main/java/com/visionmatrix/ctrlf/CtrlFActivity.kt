@@ -2,9 +2,7 @@ package com.visionmatrix.ctrlf
 
 import android.Manifest
 import android.content.pm.PackageManager
-import android.graphics.Bitmap
-import android.graphics.BitmapFactory
-import android.graphics.ImageFormat
+import android.graphics.RectF
 import android.os.Bundle
 import android.util.Log
 import android.widget.Toast
@@ -14,10 +12,9 @@ import androidx.camera.core.*
 import androidx.camera.lifecycle.ProcessCameraProvider
 import androidx.core.content.ContextCompat
 import androidx.lifecycle.lifecycleScope
+import com.tencent.ncnn.Yolov8
 import com.visionmatrix.ctrlf.databinding.ActivityCtrlfBinding
-import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
-import kotlinx.coroutines.withContext
 import java.util.concurrent.ExecutorService
 import java.util.concurrent.Executors
 
@@ -26,8 +23,11 @@ class CtrlFActivity : AppCompatActivity() {
     private var imageAnalysis: ImageAnalysis? = null
     private var cameraExecutor: ExecutorService = Executors.newSingleThreadExecutor()
     private lateinit var detector: YOLOv8Detector
+    @Volatile
     private var targetClass: String? = null
-    private var isProcessing = false
+    // 上一帧找到的目标区域（正向画面坐标），非空时下一帧只在其附近推理；由流水线回调线程更新
+    @Volatile
+    private var trackedRoi: RectF? = null
 
     private val requestPermissionLauncher = registerForActivityResult(
         ActivityResultContracts.RequestPermission()
@@ -43,14 +43,19 @@ class CtrlFActivity : AppCompatActivity() {
         detector = YOLOv8Detector(this)
         lifecycleScope.launch { 
             Log.d("CtrlF", "正在初始化 YOLO 模型...")
-            detector.initialize() 
-            Log.d("CtrlF", "YOLO 模型初始化指令已发送")
+            if (detector.initialize()) {
+                Log.d("CtrlF", "YOLO 模型就绪: ${detector.loadStats}")
+            } else {
+                Log.e("CtrlF", "YOLO 模型初始化失败")
+            }
+            if (!detector.startPipeline(::onDetections)) Log.e("CtrlF", "检测流水线启动失败")
         }
 
         binding.searchButton.setOnClickListener {
             val text = binding.searchEditText.text.toString().trim()
             if (text.isNotEmpty()) {
                 targetClass = text
+                trackedRoi = null
                 Toast.makeText(this, "正在搜索: $text", Toast.LENGTH_SHORT).show()
                 Log.d("CtrlF", "用户设置搜索目标: $text")
             } else {
@@ -91,57 +96,50 @@ class CtrlFActivity : AppCompatActivity() {
             return
         }
 
-        if (isProcessing) {
+        try {
+            // YUV 平面直接送入 native 流水线，拷贝后立即归还图像；旋转、预处理与推理都在 native 线程完成，
+            // 上一帧推理期间下一帧已在预处理，积压时只处理最新一帧
+            // 加权框融合让连续帧的框更稳定，减少叠加层抖动
+            // 已找到目标时只在其附近小窗口推理，丢失后回到整帧搜索
+            detector.submit(imageProxy, targetClass, 0.25f, Yolov8.NMS_WBF, roi = trackedRoi)
+        } catch (e: Exception) {
+            Log.e("CtrlF", "图像分析循环异常", e)
+        } finally {
             imageProxy.close()
-            return
         }
+    }
 
-        isProcessing = true
-        lifecycleScope.launch {
-            try {
-                val bitmap = imageProxyToBitmap(imageProxy)
-                if (bitmap != null) {
-                    val detections = detector.detect(bitmap, targetClass, 0.25f)
-                    
-                    withContext(Dispatchers.Main) {
-                        // 只有检测到结果时才打印
-                        if (!detections.isNullOrEmpty()) {
-                            Log.d("CtrlF", "找到目标！数量: ${detections.size}")
-                        }
-                        binding.overlayView.setDetections(detections, bitmap.width, bitmap.height)
-                    }
-                }
-            } catch (e: Exception) {
-                Log.e("CtrlF", "图像分析循环异常", e)
-            } finally {
-                imageProxy.close()
-                isProcessing = false
+    /**
+     * 流水线结果回调，在 native 推理线程上调用
+     */
+    private fun onDetections(detections: List<DetectionResult>, frameWidth: Int, frameHeight: Int) {
+        // 清除搜索目标后在途帧的结果直接丢弃
+        if (targetClass == null) return
+        trackedRoi = trackingRoi(detections, frameWidth, frameHeight)
+        runOnUiThread {
+            // 只有检测到结果时才打印
+            if (detections.isNotEmpty()) {
+                Log.d("CtrlF", "找到目标！数量: ${detections.size}")
             }
+            binding.overlayView.setDetections(detections, frameWidth, frameHeight)
         }
     }
 
-    private suspend fun imageProxyToBitmap(imageProxy: ImageProxy): Bitmap? = withContext(Dispatchers.IO) {
-        try {
-            val yBuffer = imageProxy.planes[0].buffer
-            val uBuffer = imageProxy.planes[1].buffer
-            val vBuffer = imageProxy.planes[2].buffer
-            
-            val ySize = yBuffer.remaining()
-            val uSize = uBuffer.remaining()
-            val vSize = vBuffer.remaining()
-            
-            val nv21 = ByteArray(ySize + uSize + vSize)
-            
-            yBuffer.get(nv21, 0, ySize)
-            vBuffer.get(nv21, ySize, vSize)
-            uBuffer.get(nv21, ySize + vSize, uSize)
-            
-            val yuvImage = android.graphics.YuvImage(nv21, ImageFormat.NV21, imageProxy.width, imageProxy.height, null)
-            val out = java.io.ByteArrayOutputStream()
-            yuvImage.compressToJpeg(android.graphics.Rect(0, 0, imageProxy.width, imageProxy.height), 90, out)
-            
-            BitmapFactory.decodeByteArray(out.toByteArray(), 0, out.size())
-        } catch (e: Exception) { null }
+    /**
+     * 以本帧检测框的外接矩形为中心放大 ROI_EXPAND 倍作为下一帧的搜索窗口，至少 ROI_MIN_SIZE 像素
+     * 窗口超过画面一半时整帧推理更划算，返回 null
+     */
+    private fun trackingRoi(detections: List<DetectionResult>, frameWidth: Int, frameHeight: Int): RectF? {
+        if (detections.isEmpty()) return null
+        val bounds = RectF(
+            detections.minOf { it.x }, detections.minOf { it.y },
+            detections.maxOf { it.x + it.width }, detections.maxOf { it.y + it.height }
+        )
+        val w = maxOf(bounds.width() * ROI_EXPAND, ROI_MIN_SIZE)
+        val h = maxOf(bounds.height() * ROI_EXPAND, ROI_MIN_SIZE)
+        if (w * h > frameWidth * frameHeight / 2f) return null
+        val roi = RectF(bounds.centerX() - w / 2, bounds.centerY() - h / 2, bounds.centerX() + w / 2, bounds.centerY() + h / 2)
+        return if (roi.intersect(0f, 0f, frameWidth.toFloat(), frameHeight.toFloat())) roi else null
     }
 
     override fun onDestroy() {
@@ -149,4 +147,9 @@ class CtrlFActivity : AppCompatActivity() {
         cameraExecutor.shutdown()
         detector.release()
     }
+
+    companion object {
+        private const val ROI_EXPAND = 2f
+        private const val ROI_MIN_SIZE = 160f
+    }
 }
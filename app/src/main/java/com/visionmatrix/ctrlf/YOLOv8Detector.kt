@@ -1,20 +1,72 @@
 package com.visionmatrix.ctrlf
 
+import android.content.ComponentCallbacks2
 import android.content.Context
+import android.content.res.Configuration
 import android.graphics.Bitmap
+import android.graphics.RectF
 import android.util.Log
+import androidx.camera.core.ImageProxy
 import com.tencent.ncnn.Yolov8
+import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
 import kotlinx.coroutines.withContext
+import java.io.File
 
 /**
  * YOLOv8目标检测器
  * 使用NCNN加载YOLOv8模型进行目标检测
+ * 各检测器共用 native 检测池，caller 取 Yolov8.CALLER_*，不同调用方可同时推理；
+ * 模型按 caller 分开加载，一方换模型不影响另一方，加载同一模型时共用权重
+ * int8 为 true 且 assets 中有 quantize_int8.py 生成的 int8 模型时加载它，否则加载 fp 模型
+ * rectInference 为 true 时按最小填充矩形推理（4:3 画面少算约 25%），开启前先用 eval_rect.py 确认 mAP 不下降
  */
-class YOLOv8Detector(private val context: Context) {
+class YOLOv8Detector(
+    private val context: Context,
+    private val caller: Int = Yolov8.CALLER_INTERACTIVE,
+    int8: Boolean = false,
+    private val rectInference: Boolean = false
+) {
     
     private var yolov8: Yolov8? = null
     private var isInitialized = false
+    // 最近一次加载的耗时，initialize / switchModel 成功后更新
+    var loadStats: Yolov8.LoadStats? = null
+        private set
+    // native 流水线为进程内共享，只停止本检测器启动的那一条
+    private var pipelineStarted = false
+
+    private var modelDir: String = resolveModelDir(int8)
+
+    // 串行化 loadProfile / autotune / loadModel：native 的推理选项为进程内共享，调优结果须对应当前模型
+    private val loadLock = Mutex()
+    // 后台调优，release 时取消尚未开始的调优与调优后的重建
+    private val tuneScope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private var tuneJob: Job? = null
+
+    // 界面不可见或系统内存不足时释放 native 缓冲，进入后台后连同网络卸载，降低被系统回收的概率
+    private val memoryCallbacks = object : ComponentCallbacks2 {
+        override fun onTrimMemory(level: Int) {
+            when {
+                level >= ComponentCallbacks2.TRIM_MEMORY_BACKGROUND -> trimMemory(Yolov8.TRIM_WEIGHTS)
+                level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW -> trimMemory(Yolov8.TRIM_BUFFERS)
+            }
+        }
+
+        override fun onLowMemory() {
+            trimMemory(Yolov8.TRIM_WEIGHTS)
+        }
+
+        override fun onConfigurationChanged(newConfig: Configuration) {}
+    }
+    private val paramPath get() = paramPath(modelDir)
+    private val binPath get() = binPath(modelDir)
     
     // COCO类别名称（英文）
     private val classNames = arrayOf(
@@ -115,81 +167,325 @@ class YOLOv8Detector(private val context: Context) {
     )
     
     /**
-     * 初始化模型
+     * 初始化模型，返回 true 时已完成预热，第一次检测即为稳态耗时
+     * 首次启动没有推理选项档案时先按默认选项加载，本机调优在后台进行，完成后换用调优的选项重建
      */
-    suspend fun initialize() = withContext(Dispatchers.IO) {
+    suspend fun initialize(): Boolean = withContext(Dispatchers.IO) {
+        var needTune = false
         try {
-            yolov8 = Yolov8()
-            val ret = yolov8?.loadModel(
-                context.assets,
-                "yolov8n_ncnn_model/model.ncnn.param",
-                "yolov8n_ncnn_model/model.ncnn.bin"
-            )
-            
-            if (ret == 0) {
-                isInitialized = true
-                Log.d(TAG, "YOLOv8模型加载成功")
-            } else {
-                Log.e(TAG, "YOLOv8模型加载失败，错误码: $ret")
+            loadLock.withLock {
+                yolov8 = Yolov8(caller)
+                needTune = !loadProfileOrDefault()
+                // 在加载前设置，预热即按实际输入尺寸进行
+                yolov8?.setRectInference(rectInference)
+                // 流水线可能切到的各整帧边长与追踪 ROI 边长都预热，640 在前，稳态耗时按 640 统计
+                val warmupSizes = (Yolov8.PIPELINE_INPUT_SIZES + Yolov8.DEFAULT_ROI_SIZE).distinct().toIntArray()
+                yolov8?.setWarmup(Yolov8.DEFAULT_WARMUP_RUNS, warmupSizes)
+                val ret = yolov8?.loadModel(context.assets, paramPath, binPath)
+
+                if (ret == 0) {
+                    if (!isInitialized) context.applicationContext.registerComponentCallbacks(memoryCallbacks)
+                    isInitialized = true
+                    loadStats = yolov8?.getLoadStats()
+                    Log.d(TAG, "YOLOv8模型就绪: $loadStats")
+                } else {
+                    Log.e(TAG, "YOLOv8模型加载失败，错误码: $ret")
+                }
             }
         } catch (e: Exception) {
             Log.e(TAG, "初始化YOLOv8模型时出错", e)
         }
+        if (isInitialized && needTune) tuneInBackground()
+        isInitialized
     }
     
+    /**
+     * 按需重新调优（如系统升级后），新选项写入档案并立即重建模型
+     */
+    suspend fun autotune(): Boolean = withContext(Dispatchers.IO) {
+        loadLock.withLock {
+            if (!runAutotune(modelDir)) return@withLock false
+            yolov8?.loadModel(context.assets, paramPath, binPath) == 0
+        }
+    }
+
+    /**
+     * 运行中切换 fp / int8 模型：新模型在后台加载完成后才替换，切换期间检测照常进行，
+     * 正在进行的检测在旧模型上完成；加载失败时继续使用原模型并返回 false
+     */
+    suspend fun switchModel(int8: Boolean): Boolean = withContext(Dispatchers.IO) {
+        val dir = resolveModelDir(int8)
+        var needTune = false
+        val ok = loadLock.withLock {
+            val yolov8 = yolov8 ?: return@withLock false
+            if (dir == modelDir) return@withLock true
+            val oldDir = modelDir
+            modelDir = dir
+            // 新模型没有档案时同样先按默认选项切换，调优放到后台
+            needTune = !loadProfileOrDefault()
+            val ret = yolov8.loadModel(context.assets, paramPath, binPath)
+            if (ret != 0) {
+                Log.e(TAG, "切换到 $dir 失败，错误码: $ret")
+                modelDir = oldDir
+                loadProfileOrDefault()
+                needTune = false
+            } else {
+                loadStats = yolov8.getLoadStats()
+                Log.d(TAG, "已切换到 $dir: $loadStats")
+            }
+            ret == 0
+        }
+        if (needTune) tuneInBackground()
+        ok
+    }
+
+    private fun resolveModelDir(int8: Boolean): String =
+        if (int8 && context.assets.list(INT8_MODEL_DIR)?.contains("model.ncnn.param") == true) {
+            INT8_MODEL_DIR
+        } else {
+            if (int8) Log.w(TAG, "未找到 int8 模型，使用 fp 模型")
+            MODEL_DIR
+        }
+
+    /**
+     * 释放 native 内存，level 取 Yolov8.TRIM_*；卸载网络后下一次检测自动重建
+     */
+    fun trimMemory(level: Int) {
+        val applied = yolov8?.trimMemory(level) ?: return
+        Log.d(TAG, "释放检测内存，请求级别 $level，生效级别 $applied")
+    }
+
+    // 各模型的最优选项不同，分开保存
+    private fun profileFile(dir: String = modelDir) =
+        File(context.filesDir, if (dir == INT8_MODEL_DIR) INT8_PROFILE_FILE else PROFILE_FILE)
+
+    private fun paramPath(dir: String) = "$dir/model.ncnn.param"
+    private fun binPath(dir: String) = "$dir/model.ncnn.bin"
+
+    // 读取当前模型的档案，没有时恢复默认选项，不沿用上一个模型的；返回是否读到档案
+    private fun loadProfileOrDefault(): Boolean {
+        if (yolov8?.loadProfile(profileFile().path) == 0) return true
+        yolov8?.resetProfile()
+        return false
+    }
+
+    private fun runAutotune(dir: String): Boolean {
+        val ret = yolov8?.autotune(context.assets, paramPath(dir), binPath(dir), profileFile(dir).path)
+        if (ret != 0) Log.e(TAG, "推理选项调优失败，使用默认选项")
+        return ret == 0
+    }
+
+    // 在后台为当前模型调优并保存档案，完成后按新选项重建；重建期间检测照常在旧实例上进行
+    // 调优与 loadModel 同在 loadLock 内，期间的 switchModel 等它结束；调优结果只用于发起时的模型
+    private fun tuneInBackground() {
+        tuneJob?.cancel()
+        tuneJob = tuneScope.launch {
+            loadLock.withLock {
+                val dir = modelDir
+                val detector = yolov8 ?: return@withLock
+                Log.d(TAG, "未找到 $dir 的推理选项档案，后台调优")
+                if (!runAutotune(dir)) return@withLock
+                // 调优期间已 release 时不再重建
+                if (!isActive || yolov8 !== detector) return@withLock
+                val ret = detector.loadModel(context.assets, paramPath(dir), binPath(dir))
+                if (ret == 0) {
+                    loadStats = detector.getLoadStats()
+                    Log.d(TAG, "已按调优的选项重建 $dir: $loadStats")
+                } else {
+                    Log.e(TAG, "按调优的选项重建失败，错误码: $ret")
+                }
+            }
+        }
+    }
+
     /**
      * 检测目标
      * @param bitmap 输入图像
      * @param targetClass 目标类别（中文或英文）
      * @param confidenceThreshold 置信度阈值
+     * @param nmsMode 抑制方式，取值见 Yolov8.NMS_*
      * @return 检测结果列表
      */
     suspend fun detect(
         bitmap: Bitmap,
         targetClass: String? = null,
-        confidenceThreshold: Float = 0.25f
+        confidenceThreshold: Float = 0.25f,
+        nmsMode: Int = Yolov8.NMS_HARD
+    ): List<DetectionResult> = runDetection(targetClass) { yolov8, classIds ->
+        yolov8.detect(bitmap, confidenceThreshold, classIds, nmsMode)
+    }
+
+    /**
+     * 分块检测大图中的小目标，各块并行推理后在整图坐标下合并
+     * 图像长边不超过 tileSize 时与 detect 等价
+     */
+    suspend fun detectTiled(
+        bitmap: Bitmap,
+        targetClass: String? = null,
+        confidenceThreshold: Float = 0.25f,
+        nmsMode: Int = Yolov8.NMS_HARD,
+        tileSize: Int = Yolov8.DEFAULT_TILE_SIZE,
+        overlap: Float = Yolov8.DEFAULT_TILE_OVERLAP,
+        fullFrame: Boolean = true
+    ): List<DetectionResult> = runDetection(targetClass) { yolov8, classIds ->
+        yolov8.detectTiled(
+            bitmap, tileSize, overlap, Yolov8.DEFAULT_TILE_INPUT_SIZE, fullFrame,
+            confidenceThreshold, classIds,
+            Yolov8.DEFAULT_MAX_CANDIDATES, Yolov8.DEFAULT_MAX_DETECTIONS, nmsMode, Yolov8.DEFAULT_IOU_THRESHOLD
+        )
+    }
+
+    /**
+     * 直接检测相机 YUV_420_888 帧，省去转 JPEG / Bitmap
+     * native 按 image.imageInfo.rotationDegrees 旋转成正向画面后推理，mirror 用于前置镜头
+     * roi 非空时只对旋转后画面中的该区域推理，长边缩放到 roiSize
+     * 调用方需在返回后再关闭 image，坐标对应旋转后的画面，尺寸见 uprightSize
+     */
+    suspend fun detect(
+        image: ImageProxy,
+        targetClass: String? = null,
+        confidenceThreshold: Float = 0.25f,
+        nmsMode: Int = Yolov8.NMS_HARD,
+        mirror: Boolean = false,
+        roi: RectF? = null,
+        roiSize: Int = Yolov8.DEFAULT_ROI_SIZE
+    ): List<DetectionResult> = runDetection(targetClass) { yolov8, classIds ->
+        val planes = image.planes
+        if (roi != null) {
+            yolov8.detectYuvRoi(
+                planes[0].buffer, planes[1].buffer, planes[2].buffer,
+                image.width, image.height,
+                planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride,
+                image.imageInfo.rotationDegrees, mirror, roi, roiSize,
+                confidenceThreshold, classIds, nmsMode
+            )
+        } else {
+            yolov8.detectYuv(
+                planes[0].buffer, planes[1].buffer, planes[2].buffer,
+                image.width, image.height,
+                planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride,
+                image.imageInfo.rotationDegrees, mirror,
+                confidenceThreshold, classIds, nmsMode
+            )
+        }
+    }
+
+    /**
+     * 启动 native 异步检测流水线，onResult(结果, 画面宽, 画面高) 在 native 推理线程上调用
+     * 之后用 submit 提交相机帧，预处理与推理在 native 重叠运行，积压时只处理最新一帧
+     * latencyBudgetMs 为整帧检测的延迟预算，慢设备上自动降低输入分辨率以保持交互，<= 0 时固定 640
+     */
+    fun startPipeline(
+        onResult: (List<DetectionResult>, Int, Int) -> Unit,
+        latencyBudgetMs: Float = DEFAULT_LATENCY_BUDGET_MS
+    ): Boolean {
+        val detector = yolov8
+        if (!isInitialized || detector == null) {
+            Log.w(TAG, "模型未初始化")
+            return false
+        }
+        val callback = Yolov8.DetectionCallback { _, results, frameWidth, frameHeight ->
+            onResult(results.map { toDetectionResult(it) }, frameWidth, frameHeight)
+        }
+        detector.setLatencyBudget(latencyBudgetMs)
+        pipelineStarted = detector.startPipeline(callback) == 0
+        return pipelineStarted
+    }
+
+    /**
+     * 流水线当前的整帧输入边长，供日志与调试显示
+     */
+    fun pipelineInputSize(): Int = yolov8?.getPipelineInputSize() ?: 0
+
+    /**
+     * 提交一帧到流水线，拷贝后立即返回，调用方随即关闭 image；参数含义同 detect(image)
+     * 目标类别无法识别或流水线未启动时返回 false
+     */
+    fun submit(
+        image: ImageProxy,
+        targetClass: String? = null,
+        confidenceThreshold: Float = 0.25f,
+        nmsMode: Int = Yolov8.NMS_HARD,
+        mirror: Boolean = false,
+        roi: RectF? = null,
+        roiSize: Int = Yolov8.DEFAULT_ROI_SIZE
+    ): Boolean {
+        val detector = yolov8 ?: return false
+        if (!isInitialized) return false
+        val classIds = targetClassIds(targetClass)
+        if (classIds != null && classIds.isEmpty()) return false
+        val planes = image.planes
+        return detector.submitYuv(
+            planes[0].buffer, planes[1].buffer, planes[2].buffer,
+            image.width, image.height,
+            planes[0].rowStride, planes[1].rowStride, planes[1].pixelStride,
+            image.imageInfo.rotationDegrees, mirror, roi, roiSize,
+            confidenceThreshold, classIds, nmsMode
+        ) >= 0
+    }
+
+    fun stopPipeline() {
+        if (!pipelineStarted) return
+        yolov8?.stopPipeline()
+        pipelineStarted = false
+    }
+
+    /**
+     * 旋转到正向后的画面尺寸 (宽, 高)，与 detect(image) 返回的坐标一致
+     */
+    fun uprightSize(image: ImageProxy): Pair<Int, Int> =
+        if (image.imageInfo.rotationDegrees % 180 != 0) image.height to image.width
+        else image.width to image.height
+
+    private suspend fun runDetection(
+        targetClass: String?,
+        block: (Yolov8, IntArray?) -> Array<Yolov8.DetectionResult>?
     ): List<DetectionResult> = withContext(Dispatchers.IO) {
-        if (!isInitialized || yolov8 == null) {
+        val detector = yolov8
+        if (!isInitialized || detector == null) {
             Log.w(TAG, "模型未初始化")
             return@withContext emptyList()
         }
         
         try {
-            val ncnnResults = yolov8?.detect(bitmap, confidenceThreshold) ?: return@withContext emptyList()
-            
-            // 转换NCNN结果到Kotlin数据类
-            val results = ncnnResults.map { ncnnResult ->
-                DetectionResult(
-                    classId = ncnnResult.classId,
-                    className = ncnnResult.className ?: getClassName(ncnnResult.classId),
-                    confidence = ncnnResult.confidence,
-                    x = ncnnResult.x,
-                    y = ncnnResult.y,
-                    width = ncnnResult.width,
-                    height = ncnnResult.height
-                )
-            }
+            val classIds = targetClassIds(targetClass)
+            if (classIds != null && classIds.isEmpty()) return@withContext emptyList()
             
-            // 如果指定了目标类别，进行过滤
-            if (targetClass != null && targetClass.isNotBlank()) {
-                val targetClassName = translateToEnglish(targetClass.trim())
-                val targetClassId = classNames.indexOf(targetClassName)
-                
-                if (targetClassId >= 0) {
-                    return@withContext results.filter { it.classId == targetClassId }
-                } else {
-                    Log.w(TAG, "未找到类别: $targetClass (翻译后: $targetClassName)")
-                    return@withContext emptyList()
-                }
-            }
+            val ncnnResults = block(detector, classIds) ?: return@withContext emptyList()
             
-            return@withContext results
+            // 转换NCNN结果到Kotlin数据类
+            return@withContext ncnnResults.map { toDetectionResult(it) }
         } catch (e: Exception) {
             Log.e(TAG, "检测时出错", e)
             return@withContext emptyList()
         }
     }
     
+    /**
+     * 指定目标类别时交给 native 只解码该类别，避免无关类别参与 NMS 和 JNI 回传
+     * 返回 null 表示检测全部类别，类别无法识别时返回空数组
+     */
+    private fun targetClassIds(targetClass: String?): IntArray? {
+        if (targetClass == null || targetClass.isBlank()) return null
+        val targetClassName = translateToEnglish(targetClass.trim())
+        val targetClassId = classNames.indexOf(targetClassName)
+        if (targetClassId < 0) {
+            Log.w(TAG, "未找到类别: $targetClass (翻译后: $targetClassName)")
+            return IntArray(0)
+        }
+        return intArrayOf(targetClassId)
+    }
+
+    private fun toDetectionResult(ncnnResult: Yolov8.DetectionResult) = DetectionResult(
+        classId = ncnnResult.classId,
+        className = ncnnResult.className ?: getClassName(ncnnResult.classId),
+        confidence = ncnnResult.confidence,
+        x = ncnnResult.x,
+        y = ncnnResult.y,
+        width = ncnnResult.width,
+        height = ncnnResult.height
+    )
+
     /**
      * 将中文类别名称翻译为英文
      */
@@ -219,12 +515,21 @@ class YOLOv8Detector(private val context: Context) {
      * 释放资源
      */
     fun release() {
+        if (isInitialized) context.applicationContext.unregisterComponentCallbacks(memoryCallbacks)
+        tuneJob?.cancel()
+        stopPipeline()
         yolov8 = null
         isInitialized = false
     }
     
     companion object {
         private const val TAG = "YOLOv8Detector"
+        private const val MODEL_DIR = "yolov8n_ncnn_model"
+        private const val INT8_MODEL_DIR = "yolov8n_ncnn_model_int8"
+        private const val PROFILE_FILE = "yolov8_profile.txt"
+        private const val INT8_PROFILE_FILE = "yolov8_int8_profile.txt"
+        // 约 30 fps
+        const val DEFAULT_LATENCY_BUDGET_MS = 33f
     }
 }
 
@@ -10,6 +10,20 @@ mkdir -p app/src/main/assets/yolov8n_ncnn_model
 cp yolov8n_ncnn_model/model.ncnn.param app/src/main/assets/yolov8n_ncnn_model/
 cp yolov8n_ncnn_model/model.ncnn.bin app/src/main/assets/yolov8n_ncnn_model/
 
+# quantize_int8.py 生成的 int8 模型（可选），须先通过 eval_int8.py 的精度对比
+if [ -f yolov8n_ncnn_model_int8/accuracy_gate.txt ]; then
+    mkdir -p app/src/main/assets/yolov8n_ncnn_model_int8
+    cp yolov8n_ncnn_model_int8/model.ncnn.param yolov8n_ncnn_model_int8/model.ncnn.bin app/src/main/assets/yolov8n_ncnn_model_int8/
+elif [ -f yolov8n_ncnn_model_int8/model.ncnn.param ]; then
+    echo "int8 模型未通过 eval_int8.py 精度对比，跳过复制"
+fi
+
+# 生成二进制 param 与 blob 下标头文件，二者须与 param 同步更新
+python3 param_to_bin.py app/src/main/assets/yolov8n_ncnn_model/model.ncnn.param \
+    app/src/main/assets/yolov8n_ncnn_model/model.ncnn.param.bin \
+    app/src/main/cpp/detection/yolov8n_param_id.h \
+    --layer-types app/ncnn-20250916-android-vulkan/arm64-v8a/include/ncnn/layer_type_enum.h
+
 echo "模型文件复制完成！"
 echo "文件位置: app/src/main/assets/yolov8n_ncnn_model/"
 
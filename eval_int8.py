@@ -0,0 +1,196 @@
+"""
+在主机上对比 fp 模型与 int8 模型：mAP@0.5、mAP@0.5:0.95 与单帧推理耗时
+mAP 下降超过 --max-map-drop 时以非零状态退出，量化回退可在合入前发现
+
+数据集为 YOLO 格式：images/ 下的图片与 labels/ 下同名 txt（每行 class cx cy w h，归一化坐标）
+用法:
+    python eval_int8.py coco_val/images coco_val/labels yolov8n_ncnn_model yolov8n_ncnn_model_int8
+"""
+import argparse
+import os
+import sys
+import time
+
+import cv2
+import ncnn
+import numpy as np
+
+from quantize_int8 import GATE_FILE, INPUT_SIZE, letterbox, list_images
+
+IOU_THRESHOLDS = np.linspace(0.5, 0.95, 10)
+
+
+def load_net(model_dir, threads):
+    net = ncnn.Net()
+    net.opt.use_vulkan_compute = False
+    net.opt.num_threads = threads
+    net.load_param(os.path.join(model_dir, "model.ncnn.param"))
+    net.load_model(os.path.join(model_dir, "model.ncnn.bin"))
+    return net
+
+
+def load_labels(path, w, h):
+    # 返回 (n, 5)：class x0 y0 x1 y1，像素坐标
+    if not os.path.exists(path):
+        return np.zeros((0, 5), np.float32)
+    rows = np.loadtxt(path, ndmin=2, dtype=np.float32)
+    if rows.size == 0:
+        return np.zeros((0, 5), np.float32)
+    cx, cy, bw, bh = rows[:, 1] * w, rows[:, 2] * h, rows[:, 3] * w, rows[:, 4] * h
+    return np.stack([rows[:, 0], cx - bw / 2, cy - bh / 2, cx + bw / 2, cy + bh / 2], 1)
+
+
+def box_iou(a, b):
+    lt = np.maximum(a[:, None, :2], b[None, :, :2])
+    rb = np.minimum(a[:, None, 2:], b[None, :, 2:])
+    inter = np.clip(rb - lt, 0, None).prod(2)
+    area_a = (a[:, 2] - a[:, 0]) * (a[:, 3] - a[:, 1])
+    area_b = (b[:, 2] - b[:, 0]) * (b[:, 3] - b[:, 1])
+    return inter / (area_a[:, None] + area_b[None, :] - inter + 1e-9)
+
+
+def nms(boxes, scores, iou_threshold):
+    order = scores.argsort()[::-1]
+    keep = []
+    while order.size:
+        i = order[0]
+        keep.append(i)
+        if order.size == 1:
+            break
+        iou = box_iou(boxes[i:i + 1], boxes[order[1:]])[0]
+        order = order[1:][iou <= iou_threshold]
+    return np.array(keep, np.int64)
+
+
+def decode(out, scale, left, top, conf, iou, max_det):
+    # out0 为 (4 + 类别数, anchor 数)：前 4 行为 letterbox 坐标系下的 cx cy w h，其余为类别分数
+    # 返回 (n, 6)：x0 y0 x1 y1 score class，按分数降序
+    scores = out[4:].T
+    cls = scores.argmax(1)
+    score = scores[np.arange(len(cls)), cls]
+    mask = score > conf
+    cx, cy, w, h = out[:4, mask]
+    boxes = np.stack([cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2], 1)
+    score, cls = score[mask], cls[mask]
+    # 按类别平移后一次 NMS，等价于逐类抑制
+    keep = nms(boxes + cls[:, None] * 4096.0, score, iou)[:max_det]
+    boxes = (boxes[keep] - [left, top, left, top]) / scale
+    return np.concatenate([boxes, score[keep, None], cls[keep, None]], 1)
+
+
+def match(dets, gts):
+    # 每个 IoU 阈值下按分数从高到低贪心匹配同类别、未被占用的真值框
+    tp = np.zeros((len(dets), len(IOU_THRESHOLDS)), bool)
+    if len(dets) == 0 or len(gts) == 0:
+        return tp
+    iou = box_iou(dets[:, :4], gts[:, 1:]) * (dets[:, 5:6] == gts[None, :, 0])
+    for j, t in enumerate(IOU_THRESHOLDS):
+        used = np.zeros(len(gts), bool)
+        for i in range(len(dets)):
+            candidates = np.where((iou[i] >= t) & ~used)[0]
+            if candidates.size:
+                used[candidates[iou[i, candidates].argmax()]] = True
+                tp[i, j] = True
+    return tp
+
+
+def average_precision(tp, conf, cls, gt_cls):
+    # COCO 101 点插值，逐类别求 AP 后平均；返回 (mAP@0.5, mAP@0.5:0.95)
+    order = conf.argsort()[::-1]
+    tp, cls = tp[order], cls[order]
+    aps = []
+    for c in np.unique(gt_cls):
+        n_gt = int((gt_cls == c).sum())
+        hit = tp[cls == c]
+        ap = np.zeros(len(IOU_THRESHOLDS))
+        if len(hit):
+            ctp = hit.cumsum(0)
+            cfp = (~hit).cumsum(0)
+            recall = ctp / n_gt
+            precision = ctp / (ctp + cfp)
+            x = np.linspace(0, 1, 101)
+            for j in range(len(IOU_THRESHOLDS)):
+                mrec = np.concatenate([[0.0], recall[:, j], [1.0]])
+                mpre = np.concatenate([[1.0], precision[:, j], [0.0]])
+                mpre = np.flip(np.maximum.accumulate(np.flip(mpre)))
+                ap[j] = np.interp(x, mrec, mpre).mean()
+        aps.append(ap)
+    if not aps:
+        return 0.0, 0.0
+    aps = np.array(aps)
+    return float(aps[:, 0].mean()), float(aps.mean())
+
+
+def evaluate(net, images, labels_dir, args):
+    tps, confs, classes, gt_classes, times = [], [], [], [], []
+    for path in images:
+        img = cv2.imread(path)
+        if img is None:
+            continue
+        h, w = img.shape[:2]
+        padded, scale, left, top = letterbox(img, INPUT_SIZE)
+        rgb = cv2.cvtColor(padded, cv2.COLOR_BGR2RGB)
+        data = np.ascontiguousarray(rgb.transpose(2, 0, 1), dtype=np.float32) / 255.0
+
+        start = time.perf_counter()
+        with net.create_extractor() as ex:
+            ex.input("in0", ncnn.Mat(data).clone())
+            _, out = ex.extract("out0")
+        times.append((time.perf_counter() - start) * 1000)
+
+        dets = decode(np.array(out), scale, left, top, args.conf, args.iou, args.max_det)
+        name = os.path.splitext(os.path.basename(path))[0]
+        gts = load_labels(os.path.join(labels_dir, name + ".txt"), w, h)
+        tps.append(match(dets, gts))
+        confs.append(dets[:, 4])
+        classes.append(dets[:, 5])
+        gt_classes.append(gts[:, 0])
+
+    map50, map50_95 = average_precision(np.concatenate(tps), np.concatenate(confs), np.concatenate(classes),
+                                        np.concatenate(gt_classes))
+    # 前几帧含首次分配与缓存预热，不计入
+    latency = float(np.median(times[args.warmup:] if len(times) > args.warmup else times))
+    return map50, map50_95, latency
+
+
+def main():
+    parser = argparse.ArgumentParser(description="对比 fp 与 int8 模型的 mAP 与耗时")
+    parser.add_argument("images")
+    parser.add_argument("labels")
+    parser.add_argument("fp_model_dir")
+    parser.add_argument("int8_model_dir")
+    parser.add_argument("--threads", type=int, default=4)
+    parser.add_argument("--conf", type=float, default=0.001)
+    parser.add_argument("--iou", type=float, default=0.7)
+    parser.add_argument("--max-det", type=int, default=300)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--max-map-drop", type=float, default=0.01, help="允许的 mAP@0.5:0.95 绝对下降")
+    args = parser.parse_args()
+
+    images = list_images(args.images)
+    if not images:
+        raise SystemExit("no images in %s" % args.images)
+
+    results = {}
+    for name, model_dir in (("fp", args.fp_model_dir), ("int8", args.int8_model_dir)):
+        results[name] = evaluate(load_net(model_dir, args.threads), images, args.labels, args)
+        print("%-5s mAP50 %.4f  mAP50-95 %.4f  latency %.2f ms" % ((name,) + results[name]))
+
+    drop = results["fp"][1] - results["int8"][1]
+    speedup = results["fp"][2] / max(results["int8"][2], 1e-6)
+    summary = "mAP50-95 drop %.4f (max %.4f), speedup %.2fx on %d images" % (drop, args.max_map_drop, speedup, len(images))
+    print(summary)
+    gate = os.path.join(args.int8_model_dir, GATE_FILE)
+    if drop > args.max_map_drop:
+        if os.path.exists(gate):
+            os.remove(gate)
+        print("int8 accuracy gate failed")
+        sys.exit(1)
+    with open(gate, "w", encoding="utf-8") as f:
+        for name in ("fp", "int8"):
+            f.write("%-5s mAP50 %.4f  mAP50-95 %.4f  latency %.2f ms\n" % ((name,) + results[name]))
+        f.write(summary + "\n")
+
+
+if __name__ == "__main__":
+    main()
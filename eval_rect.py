@@ -0,0 +1,149 @@
+"""
+在主机上对比方形 640 推理与最小填充矩形推理（setRectInference）：mAP@0.5、mAP@0.5:0.95 与单帧推理耗时
+矩形输入与 native 相同，在检测头各尺度的输出处截取并在此做 DFL 解码（见 assemble_head_output），
+方形输入走 out0；mAP 下降超过 --max-map-drop 时以非零状态退出，确认后再在 YOLOv8Detector 中开启
+
+数据集与 eval_int8.py 相同：images/ 下的图片与 labels/ 下同名 txt（每行 class cx cy w h，归一化坐标）
+用法:
+    python eval_rect.py coco_val/images coco_val/labels yolov8n_ncnn_model
+"""
+import argparse
+import os
+import sys
+import time
+
+import cv2
+import ncnn
+import numpy as np
+
+from eval_int8 import average_precision, decode, load_labels, load_net, match
+from param_to_bin import read_param
+from quantize_int8 import INPUT_SIZE, PAD_VALUE, letterbox, list_images
+
+HEAD_STRIDE = 32
+DFL_BINS = 16
+
+
+def letterbox_rect(img, size=INPUT_SIZE):
+    # 与 native letterbox_size(rect = true) 一致：长边缩放到 size，每边只填充到 32 的整数倍，居中
+    h, w = img.shape[:2]
+    scale = size / max(w, h)
+    nw, nh = (size, int(h * scale)) if w > h else (int(w * scale), size)
+    tw = (nw + HEAD_STRIDE - 1) // HEAD_STRIDE * HEAD_STRIDE
+    th = (nh + HEAD_STRIDE - 1) // HEAD_STRIDE * HEAD_STRIDE
+    resized = cv2.resize(img, (nw, nh), interpolation=cv2.INTER_LINEAR)
+    left, top = (tw - nw) // 2, (th - nh) // 2
+    out = cv2.copyMakeBorder(resized, top, th - nh - top, left, tw - nw - left, cv2.BORDER_CONSTANT,
+                             value=(PAD_VALUE, PAD_VALUE, PAD_VALUE))
+    return out, scale, left, top
+
+
+def head_blobs(param_path):
+    # 与 Yolov8::find_head_blobs 相同：Concat 的输出紧接 Reshape 即为检测头一个尺度的 cat(box, cls)
+    layers, _ = read_param(param_path)
+    producer = {}
+    for i, layer in enumerate(layers):
+        bottom_count, top_count = int(layer[2]), int(layer[3])
+        for top in layer[4 + bottom_count:4 + bottom_count + top_count]:
+            producer[top] = i
+    blobs = []
+    for layer in layers:
+        if layer[0] != "Reshape" or int(layer[2]) != 1:
+            continue
+        concat = producer.get(layer[4])
+        if concat is not None and layers[concat][0] == "Concat":
+            blobs.append(layer[4])
+    if len(blobs) != 3:
+        raise SystemExit("expected 3 head blobs, found %d" % len(blobs))
+    return blobs
+
+
+def assemble_heads(heads, input_h):
+    # 拼成与 out0 相同的 (4 + 类别数, anchor 数)：DFL 期望得到 ltrb 距离，锚点取格子中心，分类 logit 过 sigmoid
+    cols = []
+    for feat in heads:
+        c, fh, fw = feat.shape
+        stride = input_h / fh
+        box = feat[:4 * DFL_BINS].reshape(4, DFL_BINS, fh * fw)
+        box = np.exp(box - box.max(1, keepdims=True))
+        dist = (box * np.arange(DFL_BINS, dtype=np.float32)[None, :, None]).sum(1) / box.sum(1)
+        ax = np.tile(np.arange(fw, dtype=np.float32) + 0.5, fh)
+        ay = np.repeat(np.arange(fh, dtype=np.float32) + 0.5, fw)
+        x0, y0, x1, y1 = ax - dist[0], ay - dist[1], ax + dist[2], ay + dist[3]
+        coords = np.stack([(x0 + x1) * 0.5, (y0 + y1) * 0.5, x1 - x0, y1 - y0]) * stride
+        scores = 1.0 / (1.0 + np.exp(-feat[4 * DFL_BINS:].reshape(c - 4 * DFL_BINS, fh * fw)))
+        cols.append(np.concatenate([coords, scores], 0))
+    return np.concatenate(cols, 1)
+
+
+def evaluate(net, images, labels_dir, rect, blobs, args):
+    tps, confs, classes, gt_classes, times, shapes = [], [], [], [], [], set()
+    for path in images:
+        img = cv2.imread(path)
+        if img is None:
+            continue
+        h, w = img.shape[:2]
+        padded, scale, left, top = letterbox_rect(img) if rect else letterbox(img, INPUT_SIZE)
+        shapes.add(padded.shape[:2])
+        rgb = cv2.cvtColor(padded, cv2.COLOR_BGR2RGB)
+        data = np.ascontiguousarray(rgb.transpose(2, 0, 1), dtype=np.float32) / 255.0
+
+        start = time.perf_counter()
+        with net.create_extractor() as ex:
+            ex.input("in0", ncnn.Mat(data).clone())
+            if rect:
+                heads = [np.array(ex.extract(blob)[1]) for blob in blobs]
+            else:
+                _, out = ex.extract("out0")
+        if rect:
+            out = assemble_heads(heads, padded.shape[0])
+        times.append((time.perf_counter() - start) * 1000)
+
+        dets = decode(np.array(out), scale, left, top, args.conf, args.iou, args.max_det)
+        name = os.path.splitext(os.path.basename(path))[0]
+        gts = load_labels(os.path.join(labels_dir, name + ".txt"), w, h)
+        tps.append(match(dets, gts))
+        confs.append(dets[:, 4])
+        classes.append(dets[:, 5])
+        gt_classes.append(gts[:, 0])
+
+    map50, map50_95 = average_precision(np.concatenate(tps), np.concatenate(confs), np.concatenate(classes),
+                                        np.concatenate(gt_classes))
+    latency = float(np.median(times[args.warmup:] if len(times) > args.warmup else times))
+    return map50, map50_95, latency, len(shapes)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="对比方形 640 与最小填充矩形推理的 mAP 与耗时")
+    parser.add_argument("images")
+    parser.add_argument("labels")
+    parser.add_argument("model_dir")
+    parser.add_argument("--threads", type=int, default=4)
+    parser.add_argument("--conf", type=float, default=0.001)
+    parser.add_argument("--iou", type=float, default=0.7)
+    parser.add_argument("--max-det", type=int, default=300)
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--max-map-drop", type=float, default=0.005, help="允许的 mAP@0.5:0.95 绝对下降")
+    args = parser.parse_args()
+
+    images = list_images(args.images)
+    if not images:
+        raise SystemExit("no images in %s" % args.images)
+
+    net = load_net(args.model_dir, args.threads)
+    blobs = head_blobs(os.path.join(args.model_dir, "model.ncnn.param"))
+    results = {}
+    for name, rect in (("square", False), ("rect", True)):
+        results[name] = evaluate(net, images, args.labels, rect, blobs, args)
+        print("%-6s mAP50 %.4f  mAP50-95 %.4f  latency %.2f ms  (%d input shapes)" % ((name,) + results[name]))
+
+    drop = results["square"][1] - results["rect"][1]
+    speedup = results["square"][2] / max(results["rect"][2], 1e-6)
+    print("mAP50-95 drop %.4f (max %.4f), speedup %.2fx on %d images" % (drop, args.max_map_drop, speedup, len(images)))
+    if drop > args.max_map_drop:
+        print("rect inference accuracy gate failed")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
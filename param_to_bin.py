@@ -0,0 +1,177 @@
+"""
+把 ncnn 文本 param 转为二进制 param，并生成 blob / layer 下标头文件（与 ncnn2mem 的输出格式一致）
+运行时直接 load_param_bin，按下标 input / extract，省去文本解析与逐帧的名字查找
+
+用法:
+    python param_to_bin.py model.ncnn.param model.ncnn.param.bin yolov8n_param_id.h --layer-types layer_type_enum.h
+
+默认在 out0 后追加 Yolov8DetectionOutput 融合层，与 native append_yolov8_detection_output 追加的内容一致；
+--plain 时原样转换
+
+.param.bin 末尾附加 8 字节：标记 PARAM_HASH_TAG 与源 .param 文件（不计 \r）的 FNV-1a 32 位散列，头文件中的 param_hash 与之相同；
+native 加载时三者（.bin、头文件、随包的 .param）不一致即视为过期，退回文本 param
+"""
+import argparse
+import re
+import struct
+
+MAGIC = 7767517
+CUSTOM_BIT = 1 << 8
+PARAM_HASH_TAG = 0x48534850  # "PHSH"，与 yolov8.cpp 一致
+
+# 与 yolov8_layer.h / yolov8.h 中的定义一致
+DETECTION_OUTPUT_TYPE = "Yolov8DetectionOutput"
+DET_PARAM_BLOB = "det_param"
+DETECTIONS_BLOB = "detections"
+DETECTION_OUTPUT_PARAMS = ["0=2.500000e-01", "1=4.500000e-01", "2=1000", "3=300"]
+
+
+def read_layer_types(path):
+    # layer_type_enum.h 每行形如 "Convolution = 6,"
+    types = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            m = re.match(r"\s*(\w+)\s*=\s*(\d+),", line)
+            if m:
+                types[m.group(1)] = int(m.group(2))
+    return types
+
+
+# 跳过 \r，检出时换行被转换不影响散列
+def fnv1a32(data):
+    h = 0x811c9dc5
+    for b in data:
+        if b != 0x0d:
+            h = ((h ^ b) * 0x01000193) & 0xffffffff
+    return h
+
+
+def read_param(path):
+    with open(path, encoding="utf-8") as f:
+        lines = [line.split() for line in f if line.strip()]
+    if int(lines[0][0]) != MAGIC:
+        raise ValueError("param magic mismatch: %s" % path)
+    layer_count, blob_count = int(lines[1][0]), int(lines[1][1])
+    layers = lines[2:]
+    if len(layers) != layer_count:
+        raise ValueError("layer count %d != %d" % (len(layers), layer_count))
+    return layers, blob_count
+
+
+def append_detection_output(layers, blob_count, out_blob="out0"):
+    layers.append(["Input", DET_PARAM_BLOB, "0", "1", DET_PARAM_BLOB])
+    layers.append([DETECTION_OUTPUT_TYPE, DETECTION_OUTPUT_TYPE, "2", "1", out_blob, DET_PARAM_BLOB, DETECTIONS_BLOB]
+                  + DETECTION_OUTPUT_PARAMS)
+    return blob_count + 2
+
+
+# 与 ncnn ParamDict 相同：含小数点或指数的按 float 写入，其余按 int
+def pack_value(text):
+    if "." in text or "e" in text or "E" in text:
+        return struct.pack("<f", float(text))
+    return struct.pack("<i", int(text))
+
+
+def pack_param_dict(items):
+    data = b""
+    for item in items:
+        key, value = item.split("=", 1)
+        key = int(key)
+        data += struct.pack("<i", key)
+        if key <= -23300:
+            # 数组：元素个数在前
+            values = value.split(",")
+            count = int(values[0])
+            data += struct.pack("<i", count)
+            for v in values[1:count + 1]:
+                data += pack_value(v)
+        else:
+            data += pack_value(value)
+    return data + struct.pack("<i", -233)
+
+
+def convert(layers, blob_count, layer_types):
+    blob_names = []
+    custom_types = []
+    data = struct.pack("<iii", MAGIC, len(layers), blob_count)
+    for layer in layers:
+        layer_type, name = layer[0], layer[1]
+        bottom_count, top_count = int(layer[2]), int(layer[3])
+        bottoms = layer[4:4 + bottom_count]
+        tops = layer[4 + bottom_count:4 + bottom_count + top_count]
+        params = layer[4 + bottom_count + top_count:]
+
+        # 非内置层按出现顺序编号，运行时用 register_custom_layer(index) 注册
+        if layer_type in layer_types:
+            typeindex = layer_types[layer_type]
+        else:
+            if layer_type not in custom_types:
+                custom_types.append(layer_type)
+            typeindex = custom_types.index(layer_type) | CUSTOM_BIT
+
+        data += struct.pack("<iii", typeindex, bottom_count, top_count)
+        for b in bottoms:
+            data += struct.pack("<i", blob_names.index(b))
+        for t in tops:
+            blob_names.append(t)
+            data += struct.pack("<i", len(blob_names) - 1)
+        data += pack_param_dict(params)
+
+    if len(blob_names) != blob_count:
+        raise ValueError("blob count %d != %d" % (len(blob_names), blob_count))
+    return data, blob_names, custom_types
+
+
+def identifier(name):
+    return re.sub(r"[^0-9A-Za-z_]", "_", name)
+
+
+def write_header(path, namespace, layers, blob_names, custom_types, param_hash):
+    guard = identifier(namespace).upper() + "_H"
+    out = ["// 由 param_to_bin.py 生成，与同次生成的 .param.bin 配套，请勿手工修改",
+           "#ifndef " + guard,
+           "#define " + guard,
+           "",
+           "namespace %s {" % namespace,
+           "const int layer_count = %d;" % len(layers),
+           "const int blob_count = %d;" % len(blob_names),
+           "const unsigned int param_hash = 0x%08x;  // 源 .param 文件的 FNV-1a 散列" % param_hash]
+    for i, t in enumerate(custom_types):
+        out.append("const int CUSTOM_LAYER_%s = %d;" % (identifier(t), i))
+    # pnnx 导出的 split 层名会重复，重名层没有唯一下标，不生成常量
+    names = [identifier(layer[1]) for layer in layers]
+    for i, name in enumerate(names):
+        if names.count(name) == 1:
+            out.append("const int LAYER_%s = %d;" % (name, i))
+    for i, b in enumerate(blob_names):
+        out.append("const int BLOB_%s = %d;" % (identifier(b), i))
+    out += ["} // namespace " + namespace, "", "#endif // " + guard, ""]
+    with open(path, "w", encoding="utf-8", newline="\r\n") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ncnn 文本 param 转二进制 param 与下标头文件")
+    parser.add_argument("param")
+    parser.add_argument("param_bin")
+    parser.add_argument("header")
+    parser.add_argument("--layer-types", required=True, help="ncnn 的 layer_type_enum.h")
+    parser.add_argument("--namespace", default="yolov8n_param_id")
+    parser.add_argument("--plain", action="store_true", help="不追加融合后处理层")
+    args = parser.parse_args()
+
+    layers, blob_count = read_param(args.param)
+    if not args.plain:
+        blob_count = append_detection_output(layers, blob_count)
+    data, blob_names, custom_types = convert(layers, blob_count, read_layer_types(args.layer_types))
+
+    with open(args.param, "rb") as f:
+        param_hash = fnv1a32(f.read())
+    with open(args.param_bin, "wb") as f:
+        f.write(data + struct.pack("<II", PARAM_HASH_TAG, param_hash))
+    write_header(args.header, args.namespace, layers, blob_names, custom_types, param_hash)
+    print("%d layers, %d blobs -> %s, %s" % (len(layers), len(blob_names), args.param_bin, args.header))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+"""
+用一组图片校准并生成 int8 模型：letterbox 预处理与 native 一致，调用 ncnn 自带的 ncnn2table / ncnn2int8
+检测头的输出卷积及其后的解码部分对量化误差敏感，默认保持 fp32（从量化表中去掉这些层）
+
+用法:
+    python quantize_int8.py calib_images/ yolov8n_ncnn_model yolov8n_ncnn_model_int8 --tools ncnn/build/tools/quantize
+生成后用 eval_int8.py 与 fp 模型对比精度与耗时，通过后 copy_models 才会把它复制到 assets
+"""
+import argparse
+import os
+import shutil
+import subprocess
+import tempfile
+
+import cv2
+
+from param_to_bin import read_param
+
+INPUT_SIZE = 640
+PAD_VALUE = 114
+IMAGE_EXTS = (".jpg", ".jpeg", ".png", ".bmp")
+# eval_int8.py 通过精度对比后写入 int8 模型目录，copy_models 只复制带有此文件的 int8 模型
+GATE_FILE = "accuracy_gate.txt"
+
+
+def letterbox(img, size=INPUT_SIZE):
+    # 与 native letterbox_size / letterbox_normalize 一致：长边缩放到 size，居中填充 114
+    h, w = img.shape[:2]
+    scale = size / max(w, h)
+    nw, nh = (size, int(h * scale)) if w > h else (int(w * scale), size)
+    resized = cv2.resize(img, (nw, nh), interpolation=cv2.INTER_LINEAR)
+    left, top = (size - nw) // 2, (size - nh) // 2
+    out = cv2.copyMakeBorder(resized, top, size - nh - top, left, size - nw - left, cv2.BORDER_CONSTANT,
+                             value=(PAD_VALUE, PAD_VALUE, PAD_VALUE))
+    return out, scale, left, top
+
+
+def list_images(folder):
+    return sorted(os.path.join(folder, f) for f in os.listdir(folder) if f.lower().endswith(IMAGE_EXTS))
+
+
+def head_layers(param_path):
+    # 检测头各尺度 cat(box, cls) 紧接 Reshape（见 Yolov8::find_head_blobs）；
+    # 拼接前的卷积与第一个 Reshape 之后的卷积（DFL 等解码）保持 fp32
+    layers, _ = read_param(param_path)
+    producer = {}
+    for i, layer in enumerate(layers):
+        bottom_count, top_count = int(layer[2]), int(layer[3])
+        for top in layer[4 + bottom_count:4 + bottom_count + top_count]:
+            producer[top] = i
+
+    keep = set()
+    first_reshape = None
+    for i, layer in enumerate(layers):
+        if layer[0] != "Reshape" or int(layer[2]) != 1:
+            continue
+        concat = producer.get(layer[4])
+        if concat is None or layers[concat][0] != "Concat":
+            continue
+        if first_reshape is None:
+            first_reshape = i
+        for bottom in layers[concat][4:4 + int(layers[concat][2])]:
+            conv = layers[producer[bottom]]
+            if conv[0] == "Convolution":
+                keep.add(conv[1])
+    if first_reshape is not None:
+        keep.update(layer[1] for layer in layers[first_reshape:] if layer[0] == "Convolution")
+    return keep
+
+
+def filter_table(table_path, keep):
+    # 量化表中每层两行：<layer>_param_0 为权重 scale，<layer> 为输入 scale；两行都去掉的层 ncnn2int8 不量化
+    with open(table_path, encoding="utf-8") as f:
+        lines = f.readlines()
+    out = [line for line in lines if line.split()[0].rsplit("_param_", 1)[0] not in keep]
+    with open(table_path, "w", encoding="utf-8") as f:
+        f.writelines(out)
+    return len(lines) - len(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="校准并生成 int8 模型")
+    parser.add_argument("images", help="校准图片目录，建议 200~1000 张贴近实际场景的照片")
+    parser.add_argument("model_dir", help="含 model.ncnn.param / model.ncnn.bin 的 fp 模型目录")
+    parser.add_argument("out_dir")
+    parser.add_argument("--tools", default="", help="ncnn2table / ncnn2int8 所在目录，默认从 PATH 查找")
+    parser.add_argument("--method", default="kl", choices=["kl", "aciq", "eq"])
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 4)
+    parser.add_argument("--quantize-head", action="store_true", help="检测头也量化（更快，精度损失更大）")
+    args = parser.parse_args()
+
+    param = os.path.join(args.model_dir, "model.ncnn.param")
+    weights = os.path.join(args.model_dir, "model.ncnn.bin")
+    os.makedirs(args.out_dir, exist_ok=True)
+    # 重新量化后原有的精度对比结果不再适用
+    gate = os.path.join(args.out_dir, GATE_FILE)
+    if os.path.exists(gate):
+        os.remove(gate)
+    table = os.path.join(args.out_dir, "model.ncnn.table")
+    ncnn2table = os.path.join(args.tools, "ncnn2table")
+    ncnn2int8 = os.path.join(args.tools, "ncnn2int8")
+
+    images = list_images(args.images)
+    if not images:
+        raise SystemExit("no images in %s" % args.images)
+
+    # 先按 native 的方式 letterbox 到 640x640，ncnn2table 的缩放此时不再改变图像，统计分布与运行时一致
+    work = tempfile.mkdtemp(prefix="yolov8_calib_")
+    try:
+        listing = os.path.join(work, "imagelist.txt")
+        with open(listing, "w", encoding="utf-8") as f:
+            for i, path in enumerate(images):
+                img = cv2.imread(path)
+                if img is None:
+                    print("skip unreadable %s" % path)
+                    continue
+                out = os.path.join(work, "%05d.png" % i)
+                cv2.imwrite(out, letterbox(img)[0])
+                f.write(out + "\n")
+
+        subprocess.check_call([ncnn2table, param, weights, listing, table,
+                               "mean=[0,0,0]", "norm=[0.003922,0.003922,0.003922]",
+                               "shape=[%d,%d,3]" % (INPUT_SIZE, INPUT_SIZE), "pixel=RGB",
+                               "thread=%d" % args.threads, "method=" + args.method])
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+    if not args.quantize_head:
+        keep = head_layers(param)
+        removed = filter_table(table, keep)
+        print("keep %d head layers in fp32 (%d table lines removed)" % (len(keep), removed))
+
+    subprocess.check_call([ncnn2int8, param, weights,
+                           os.path.join(args.out_dir, "model.ncnn.param"),
+                           os.path.join(args.out_dir, "model.ncnn.bin"), table])
+    print("int8 model -> %s" % args.out_dir)
+
+
+if __name__ == "__main__":
+    main()